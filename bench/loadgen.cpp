@@ -0,0 +1,525 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file loadgen.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Load generator for the device, reports the results as JSON on stdout.
+ *
+ * Usage: maestro_device_loadgen [--option=value ...]
+ *   --threads=T        submitting threads (default 4)
+ *   --sessions=M       sessions, spread over the threads, at least T (default T)
+ *   --rate=R           open loop: R jobs per second in total, submitted on schedule
+ *   --concurrency=C    closed loop: C jobs in flight in total (default 16, if no rate)
+ *   --duration=S       seconds of submitting (default 10)
+ *   --drain=S          seconds to wait for the jobs in flight at the end (default 30)
+ *   --circuits=LIST    comma separated mix of bell, ghz:N, random:N:DEPTH (default bell)
+ *   --shots=LIST       comma separated mix of shot counts (default 100)
+ *   --backends=LIST    comma separated mix of simType:execType (default 1:0)
+ *   --seed=N           seed of the random picks from the mixes (default 1)
+ *
+ * Every job picks a circuit, a shot count and a backend uniformly from the mixes.
+ * The latency is from the submit call to the completion seen by the thread,
+ * which waits on the completion descriptors of its sessions (polling on Windows).
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <poll.h>
+#endif
+
+#include "maestro_device.h"
+#include "maestro_qdmi/device.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    size_t threads = 4;
+    size_t sessions = 0;
+    double rate = 0;
+    size_t concurrency = 16;
+    double duration = 10;
+    double drain = 30;
+    std::vector<std::string> circuits = {"bell"};
+    std::vector<size_t> shots = {100};
+    std::vector<std::pair<size_t, size_t>> backends = {{1, 0}};
+    uint64_t seed = 1;
+};
+
+struct Program
+{
+    std::string text;
+    size_t qubits = 0;
+};
+
+// counted by each thread, merged at the end
+struct Stats
+{
+    size_t submitted = 0;
+    size_t done = 0;
+    size_t submitErrors = 0;
+    size_t failed = 0;
+    size_t canceled = 0;
+    size_t timeouts = 0;
+    std::vector<double> latencies; // milliseconds
+};
+
+std::vector<std::string> Split(const std::string& text, char separator)
+{
+    std::vector<std::string> parts;
+
+    size_t pos = 0;
+    for (;;) {
+        const size_t next = text.find(separator, pos);
+        parts.push_back(text.substr(pos, next - pos));
+        if (next == std::string::npos)
+            break;
+        pos = next + 1;
+    }
+
+    return parts;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+            std::fprintf(stderr, "invalid argument '%s'\n", argv[i]);
+            return false;
+        }
+
+        const std::string key = arg.substr(2, eq - 2);
+        const std::string value = arg.substr(eq + 1);
+        if (key == "threads")
+            options.threads = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "sessions")
+            options.sessions = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "rate")
+            options.rate = std::strtod(value.c_str(), nullptr);
+        else if (key == "concurrency")
+            options.concurrency = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "duration")
+            options.duration = std::strtod(value.c_str(), nullptr);
+        else if (key == "drain")
+            options.drain = std::strtod(value.c_str(), nullptr);
+        else if (key == "circuits")
+            options.circuits = Split(value, ',');
+        else if (key == "shots") {
+            options.shots.clear();
+            for (const auto& shots : Split(value, ','))
+                options.shots.push_back(std::strtoull(shots.c_str(), nullptr, 10));
+        } else if (key == "backends") {
+            options.backends.clear();
+            for (const auto& backend : Split(value, ',')) {
+                const auto types = Split(backend, ':');
+                if (types.size() != 2) {
+                    std::fprintf(stderr, "invalid backend '%s'\n", backend.c_str());
+                    return false;
+                }
+                options.backends.emplace_back(std::strtoull(types[0].c_str(), nullptr, 10),
+                                              std::strtoull(types[1].c_str(), nullptr, 10));
+            }
+        } else if (key == "seed")
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        else {
+            std::fprintf(stderr, "unknown option '%s'\n", key.c_str());
+            return false;
+        }
+    }
+
+    options.threads = std::max<size_t>(1, options.threads);
+    options.sessions = std::max(options.sessions, options.threads);
+    options.concurrency = std::max(options.concurrency, options.threads);
+
+    return !options.circuits.empty() && !options.shots.empty() && !options.backends.empty() &&
+           options.duration > 0;
+}
+
+bool MakeProgram(const std::string& spec, Program& program)
+{
+    const auto parts = Split(spec, ':');
+    const size_t qubits = parts.size() > 1 ? std::strtoull(parts[1].c_str(), nullptr, 10) : 2;
+    if (qubits == 0)
+        return false;
+
+    std::string text = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[" + std::to_string(qubits) +
+                       "];\ncreg c[" + std::to_string(qubits) + "];\n";
+
+    if (parts[0] == "bell" || parts[0] == "ghz") {
+        text += "h q[0];\n";
+        for (size_t q = 1; q < qubits; ++q)
+            text += "cx q[" + std::to_string(q - 1) + "],q[" + std::to_string(q) + "];\n";
+    } else if (parts[0] == "random" && parts.size() == 3) {
+        const size_t depth = std::strtoull(parts[2].c_str(), nullptr, 10);
+        std::mt19937_64 rng(qubits * 1000003 + depth);
+        std::uniform_real_distribution<double> angle(-3.14159, 3.14159);
+        for (size_t layer = 0; layer < depth; ++layer) {
+            for (size_t q = 0; q < qubits; ++q)
+                text += "u3(" + std::to_string(angle(rng)) + "," + std::to_string(angle(rng)) +
+                        "," + std::to_string(angle(rng)) + ") q[" + std::to_string(q) + "];\n";
+            for (size_t q = layer % 2; q + 1 < qubits; q += 2)
+                text += "cx q[" + std::to_string(q) + "],q[" + std::to_string(q + 1) + "];\n";
+        }
+    } else
+        return false;
+
+    text += "measure q -> c;\n";
+    program.text = std::move(text);
+    program.qubits = qubits;
+
+    return true;
+}
+
+struct InFlight
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    Clock::time_point submitted;
+};
+
+class Worker
+{
+public:
+    Worker(const Options& opts, const std::vector<Program>& progs, size_t idx)
+        : index(idx), options(opts), programs(progs), rng(opts.seed * 7919 + idx)
+    {
+    }
+
+    bool AddSession()
+    {
+        MAESTRO_QDMI_Device_Session session = nullptr;
+        if (MAESTRO_QDMI_device_session_alloc(&session) != QDMI_SUCCESS ||
+            MAESTRO_QDMI_device_session_init(session) != QDMI_SUCCESS)
+            return false;
+        sessions.push_back(session);
+
+#if !defined(_WIN32)
+        size_t size = 0;
+        if (MAESTRO_QDMI_device_session_query_device_property(session, QDMI_DEVICE_PROPERTY_SITES,
+                                                              0, nullptr, &size) != QDMI_SUCCESS)
+            return false;
+        std::vector<MAESTRO_QDMI_Site> siteList(size / sizeof(MAESTRO_QDMI_Site));
+        if (siteList.empty() ||
+            MAESTRO_QDMI_device_session_query_device_property(
+                session, QDMI_DEVICE_PROPERTY_SITES, size, siteList.data(), nullptr) !=
+                QDMI_SUCCESS)
+            return false;
+
+        int fd = -1;
+        if (MAESTRO_QDMI_device_session_query_site_property(
+                session, siteList[0], QDMI_SITE_PROPERTY_CUSTOM1, sizeof(int), &fd, nullptr) !=
+            QDMI_SUCCESS)
+            return false;
+        fds.push_back({fd, POLLIN, 0});
+#endif
+
+        return true;
+    }
+
+    void Run(Clock::time_point start, size_t threads)
+    {
+        const auto end = start + ToDuration(options.duration);
+        const size_t window = options.concurrency / threads;
+        // the threads are staggered over the interval of the schedule
+        const auto interval = options.rate > 0
+                                  ? ToDuration(static_cast<double>(threads) / options.rate)
+                                  : Clock::duration::zero();
+        Clock::time_point next =
+            start + interval * static_cast<long long>(index) / static_cast<long long>(threads);
+
+        for (;;) {
+            const auto now = Clock::now();
+            if (now >= end)
+                break;
+
+            if (options.rate > 0) {
+                while (next <= now && next < end) {
+                    Submit();
+                    next += interval;
+                }
+                Collect(std::min(next, end));
+            } else {
+                while (inFlight.size() < window)
+                    if (!Submit())
+                        break;
+                Collect(end);
+            }
+        }
+
+        // the jobs in flight get a bounded time to finish
+        const auto drainEnd = Clock::now() + ToDuration(options.drain);
+        while (!inFlight.empty() && Clock::now() < drainEnd)
+            Collect(drainEnd);
+
+        for (auto& [id, entry] : inFlight) {
+            ++stats.timeouts;
+            MAESTRO_QDMI_device_job_free(entry.job);
+        }
+        inFlight.clear();
+
+        for (auto* session : sessions)
+            MAESTRO_QDMI_device_session_free(session);
+    }
+
+    const size_t index;
+    Stats stats;
+
+private:
+    static Clock::duration ToDuration(double seconds)
+    {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    bool Submit()
+    {
+        const Program& program = Pick(programs);
+        size_t shots = Pick(options.shots);
+        const auto& backend = Pick(options.backends);
+        size_t qubits = program.qubits;
+        size_t simType = backend.first;
+        size_t simExecType = backend.second;
+
+        MAESTRO_QDMI_Device_Session session = sessions[nextSession++ % sessions.size()];
+        MAESTRO_QDMI_Device_Job job = nullptr;
+        if (MAESTRO_QDMI_device_session_create_device_job(session, &job) != QDMI_SUCCESS) {
+            ++stats.submitErrors;
+            return false;
+        }
+
+        char id[32] = {0};
+        const bool ready =
+            MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                  sizeof(size_t), &shots) == QDMI_SUCCESS &&
+            MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM1,
+                                                  sizeof(size_t), &qubits) == QDMI_SUCCESS &&
+            MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM2,
+                                                  sizeof(size_t), &simType) == QDMI_SUCCESS &&
+            MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM3,
+                                                  sizeof(size_t), &simExecType) == QDMI_SUCCESS &&
+            MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                  program.text.length(),
+                                                  program.text.c_str()) == QDMI_SUCCESS &&
+            MAESTRO_QDMI_device_job_query_property(job, QDMI_DEVICE_JOB_PROPERTY_ID, sizeof(id),
+                                                   id, nullptr) == QDMI_SUCCESS;
+
+        const auto submitted = Clock::now();
+        if (!ready || MAESTRO_QDMI_device_job_submit(job) != QDMI_SUCCESS) {
+            ++stats.submitErrors;
+            MAESTRO_QDMI_device_job_free(job);
+            return false;
+        }
+
+        ++stats.submitted;
+        inFlight[std::strtoull(id, nullptr, 10)] = {job, submitted};
+
+        return true;
+    }
+
+    // waits until a job finishes or the deadline passes, then records the finished jobs
+    void Collect(Clock::time_point deadline)
+    {
+        const auto now = Clock::now();
+        const auto wait = deadline > now ? std::chrono::duration_cast<std::chrono::milliseconds>(
+                                               deadline - now + std::chrono::microseconds(999))
+                                         : std::chrono::milliseconds(0);
+
+#if !defined(_WIN32)
+        if (poll(fds.data(), static_cast<nfds_t>(fds.size()),
+                 static_cast<int>(std::min<long long>(wait.count(), 100))) <= 0)
+            return;
+
+        for (size_t s = 0; s < fds.size(); ++s) {
+            if ((fds[s].revents & POLLIN) == 0)
+                continue;
+
+            size_t ids[64];
+            size_t size = 0;
+            if (MAESTRO_QDMI_device_session_drain_completed(sessions[s], sizeof(ids), ids, &size) !=
+                QDMI_SUCCESS)
+                continue;
+
+            const auto finished = Clock::now();
+            for (size_t i = 0; i < size / sizeof(size_t); ++i)
+                Finish(ids[i], finished);
+        }
+#else
+        std::this_thread::sleep_for(std::min(wait, std::chrono::milliseconds(1)));
+
+        std::vector<size_t> finishedIds;
+        for (const auto& [id, entry] : inFlight) {
+            QDMI_Job_Status status = QDMI_JOB_STATUS_RUNNING;
+            MAESTRO_QDMI_device_job_check(entry.job, &status);
+            if (status == QDMI_JOB_STATUS_DONE || status == QDMI_JOB_STATUS_FAILED ||
+                status == QDMI_JOB_STATUS_CANCELED)
+                finishedIds.push_back(id);
+        }
+
+        const auto finished = Clock::now();
+        for (const size_t id : finishedIds)
+            Finish(id, finished);
+#endif
+    }
+
+    void Finish(size_t id, Clock::time_point finished)
+    {
+        const auto it = inFlight.find(id);
+        if (it == inFlight.end())
+            return;
+
+        QDMI_Job_Status status = QDMI_JOB_STATUS_FAILED;
+        MAESTRO_QDMI_device_job_check(it->second.job, &status);
+        if (status == QDMI_JOB_STATUS_DONE) {
+            ++stats.done;
+            stats.latencies.push_back(
+                std::chrono::duration<double, std::milli>(finished - it->second.submitted)
+                    .count());
+        } else if (status == QDMI_JOB_STATUS_CANCELED)
+            ++stats.canceled;
+        else
+            ++stats.failed;
+
+        MAESTRO_QDMI_device_job_free(it->second.job);
+        inFlight.erase(it);
+    }
+
+    template <class Value>
+    const Value& Pick(const std::vector<Value>& values)
+    {
+        return values[std::uniform_int_distribution<size_t>(0, values.size() - 1)(rng)];
+    }
+
+    const Options& options;
+    const std::vector<Program>& programs;
+    std::mt19937_64 rng;
+
+    std::vector<MAESTRO_QDMI_Device_Session> sessions;
+    size_t nextSession = 0;
+#if !defined(_WIN32)
+    std::vector<pollfd> fds;
+#endif
+    std::unordered_map<size_t, InFlight> inFlight;
+};
+
+double Percentile(const std::vector<double>& sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0;
+
+    const size_t rank =
+        static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    std::vector<Program> programs(options.circuits.size());
+    for (size_t i = 0; i < programs.size(); ++i)
+        if (!MakeProgram(options.circuits[i], programs[i])) {
+            std::fprintf(stderr, "invalid circuit '%s'\n", options.circuits[i].c_str());
+            return 1;
+        }
+
+    if (MAESTRO_QDMI_device_initialize() != QDMI_SUCCESS) {
+        std::fprintf(stderr, "cannot initialize the device\n");
+        return 1;
+    }
+
+    std::vector<Worker> workers;
+    workers.reserve(options.threads);
+    for (size_t t = 0; t < options.threads; ++t)
+        workers.emplace_back(options, programs, t);
+    for (size_t s = 0; s < options.sessions; ++s)
+        if (!workers[s % options.threads].AddSession()) {
+            std::fprintf(stderr, "cannot open session %zu\n", s);
+            MAESTRO_QDMI_device_finalize();
+            return 1;
+        }
+
+    const auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (auto& worker : workers)
+        threads.emplace_back([&worker, start, &options] { worker.Run(start, options.threads); });
+    for (auto& thread : threads)
+        thread.join();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    MAESTRO_QDMI_device_finalize();
+
+    Stats total;
+    for (auto& worker : workers) {
+        total.submitted += worker.stats.submitted;
+        total.done += worker.stats.done;
+        total.submitErrors += worker.stats.submitErrors;
+        total.failed += worker.stats.failed;
+        total.canceled += worker.stats.canceled;
+        total.timeouts += worker.stats.timeouts;
+        total.latencies.insert(total.latencies.end(), worker.stats.latencies.begin(),
+                               worker.stats.latencies.end());
+    }
+    std::sort(total.latencies.begin(), total.latencies.end());
+
+    std::printf("{\n");
+    std::printf("  \"mode\": \"%s\",\n", options.rate > 0 ? "open" : "closed");
+    std::printf("  \"threads\": %zu,\n", options.threads);
+    std::printf("  \"sessions\": %zu,\n", options.sessions);
+    if (options.rate > 0)
+        std::printf("  \"target_rate\": %.3f,\n", options.rate);
+    else
+        std::printf("  \"concurrency\": %zu,\n", options.concurrency);
+    std::printf("  \"elapsed_s\": %.3f,\n", elapsed);
+    std::printf("  \"submitted\": %zu,\n", total.submitted);
+    std::printf("  \"completed\": %zu,\n", total.done);
+    std::printf("  \"throughput_jobs_per_s\": %.3f,\n", static_cast<double>(total.done) / elapsed);
+    std::printf("  \"latency_ms\": {\"p50\": %.3f, \"p99\": %.3f, \"p999\": %.3f, "
+                "\"max\": %.3f},\n",
+                Percentile(total.latencies, 0.5), Percentile(total.latencies, 0.99),
+                Percentile(total.latencies, 0.999),
+                total.latencies.empty() ? 0. : total.latencies.back());
+    std::printf("  \"errors\": {\"submit\": %zu, \"failed\": %zu, \"canceled\": %zu, \"timeout\": "
+                "%zu}\n",
+                total.submitErrors, total.failed, total.canceled, total.timeouts);
+    std::printf("}\n");
+
+    const size_t errors = total.submitErrors + total.failed + total.canceled + total.timeouts;
+
+    return errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,246 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file mock_maestro.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * A stand-in for the maestro library, to drive the device without simulating.
+ *
+ * It exports the functions the device loads, see MaestroLib.hpp. SimpleExecute
+ * returns all the shots in the all zero outcome, the gate API does nothing and
+ * measures zeros. MAESTRO_MOCK_EXECUTE_US sets a busy wait in microseconds for
+ * each SimpleExecute call, to give the jobs a run time (default 0).
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#define MOCK_EXPORT extern "C" __declspec(dllexport)
+#else
+#define MOCK_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+namespace {
+struct MockState
+{
+    std::mutex mutex;
+    std::unordered_map<unsigned long int, int> qubits; // of the simple simulators
+    std::atomic<unsigned long int> nextHandle{1};
+    long long executeMicroseconds = 0;
+
+    MockState()
+    {
+        const char* value = std::getenv("MAESTRO_MOCK_EXECUTE_US");
+        if (value != nullptr)
+            executeMicroseconds = std::atoll(value);
+    }
+};
+
+MockState& GetState()
+{
+    static MockState state;
+
+    return state;
+}
+
+// the object the gate API functions get, its content is never used
+int mockSimulator = 0;
+
+char* CopyString(const std::string& text)
+{
+    char* copy = static_cast<char*>(std::malloc(text.length() + 1));
+    if (copy != nullptr)
+        std::memcpy(copy, text.c_str(), text.length() + 1);
+
+    return copy;
+}
+} // namespace
+
+MOCK_EXPORT void* GetMaestroObjectWithMute() { return &GetState(); }
+
+MOCK_EXPORT unsigned long int CreateSimpleSimulator(int nrQubits)
+{
+    MockState& state = GetState();
+    const unsigned long int handle = state.nextHandle++;
+
+    std::lock_guard lock(state.mutex);
+    state.qubits[handle] = nrQubits;
+
+    return handle;
+}
+
+MOCK_EXPORT void DestroySimpleSimulator(unsigned long int simHandle)
+{
+    MockState& state = GetState();
+
+    std::lock_guard lock(state.mutex);
+    state.qubits.erase(simHandle);
+}
+
+MOCK_EXPORT int RemoveAllOptimizationSimulatorsAndAdd(unsigned long int, int, int) { return 1; }
+
+MOCK_EXPORT int AddOptimizationSimulator(unsigned long int, int, int) { return 1; }
+
+MOCK_EXPORT char* SimpleExecute(unsigned long int simHandle, const char* jsonCircuit,
+                                const char* jsonConfig)
+{
+    MockState& state = GetState();
+    if (jsonCircuit == nullptr || jsonConfig == nullptr)
+        return nullptr;
+
+    int qubits = 0;
+    {
+        std::lock_guard lock(state.mutex);
+        const auto it = state.qubits.find(simHandle);
+        if (it == state.qubits.end())
+            return nullptr;
+        qubits = it->second;
+    }
+
+    unsigned long long int shots = 1;
+    const char* pos = std::strstr(jsonConfig, "\"shots\":");
+    if (pos != nullptr)
+        shots = std::strtoull(pos + 8, nullptr, 10);
+
+    if (state.executeMicroseconds > 0) {
+        const auto end = std::chrono::steady_clock::now() +
+                         std::chrono::microseconds(state.executeMicroseconds);
+        while (std::chrono::steady_clock::now() < end) {
+        }
+    }
+
+    return CopyString("{\"counts\": {\"" + std::string(static_cast<size_t>(qubits), '0') +
+                      "\": " + std::to_string(shots) + "}}");
+}
+
+MOCK_EXPORT void FreeResult(char* result) { std::free(result); }
+
+MOCK_EXPORT unsigned long int CreateSimulator(int, int) { return GetState().nextHandle++; }
+
+MOCK_EXPORT void* GetSimulator(unsigned long int) { return &mockSimulator; }
+
+MOCK_EXPORT void DestroySimulator(unsigned long int) {}
+
+MOCK_EXPORT int InitializeSimulator(void*) { return 1; }
+
+MOCK_EXPORT int ResetSimulator(void*) { return 1; }
+
+MOCK_EXPORT int ConfigureSimulator(void*, const char*, const char*) { return 1; }
+
+MOCK_EXPORT char* GetConfiguration(void*, const char*) { return nullptr; }
+
+MOCK_EXPORT unsigned long int AllocateQubits(void*, unsigned long int) { return 0; }
+
+MOCK_EXPORT unsigned long int GetNumberOfQubits(void*) { return 0; }
+
+MOCK_EXPORT int ClearSimulator(void*) { return 1; }
+
+MOCK_EXPORT unsigned long long int Measure(void*, const unsigned long int*, unsigned long int)
+{
+    return 0;
+}
+
+MOCK_EXPORT int ApplyReset(void*, const unsigned long int*, unsigned long int) { return 1; }
+
+MOCK_EXPORT double Probability(void*, unsigned long long int basisState)
+{
+    return basisState == 0 ? 1. : 0.;
+}
+
+MOCK_EXPORT void FreeDoubleVector(double* vec) { std::free(vec); }
+
+MOCK_EXPORT void FreeULLIVector(unsigned long long int* vec) { std::free(vec); }
+
+MOCK_EXPORT double* Amplitude(void*, unsigned long long int) { return nullptr; }
+
+MOCK_EXPORT double* AllProbabilities(void*) { return nullptr; }
+
+MOCK_EXPORT double* Probabilities(void*, const unsigned long long int*, unsigned long int)
+{
+    return nullptr;
+}
+
+MOCK_EXPORT unsigned long long int* SampleCounts(void*, const unsigned long long int*,
+                                                 unsigned long int, unsigned long int)
+{
+    return nullptr;
+}
+
+MOCK_EXPORT int GetSimulatorType(void*) { return 1; }
+
+MOCK_EXPORT int GetSimulationType(void*) { return 0; }
+
+MOCK_EXPORT int FlushSimulator(void*) { return 1; }
+
+MOCK_EXPORT int SaveStateToInternalDestructive(void*) { return 1; }
+
+MOCK_EXPORT int RestoreInternalDestructiveSavedState(void*) { return 1; }
+
+MOCK_EXPORT int SaveState(void*) { return 1; }
+
+MOCK_EXPORT int RestoreState(void*) { return 1; }
+
+MOCK_EXPORT int SetMultithreading(void*, int) { return 1; }
+
+MOCK_EXPORT int GetMultithreading(void*) { return 0; }
+
+MOCK_EXPORT int IsQcsim(void*) { return 1; }
+
+MOCK_EXPORT unsigned long long int MeasureNoCollapse(void*) { return 0; }
+
+#define MOCK_GATE(name, ...)                                                                       \
+    MOCK_EXPORT int name(void*, __VA_ARGS__) { return 1; }
+
+MOCK_GATE(ApplyX, int)
+MOCK_GATE(ApplyY, int)
+MOCK_GATE(ApplyZ, int)
+MOCK_GATE(ApplyH, int)
+MOCK_GATE(ApplyS, int)
+MOCK_GATE(ApplySDG, int)
+MOCK_GATE(ApplyT, int)
+MOCK_GATE(ApplyTDG, int)
+MOCK_GATE(ApplySX, int)
+MOCK_GATE(ApplySXDG, int)
+MOCK_GATE(ApplyK, int)
+MOCK_GATE(ApplyP, int, double)
+MOCK_GATE(ApplyRx, int, double)
+MOCK_GATE(ApplyRy, int, double)
+MOCK_GATE(ApplyRz, int, double)
+MOCK_GATE(ApplyU, int, double, double, double, double)
+MOCK_GATE(ApplyCX, int, int)
+MOCK_GATE(ApplyCY, int, int)
+MOCK_GATE(ApplyCZ, int, int)
+MOCK_GATE(ApplyCH, int, int)
+MOCK_GATE(ApplyCSX, int, int)
+MOCK_GATE(ApplyCSXDG, int, int)
+MOCK_GATE(ApplyCP, int, int, double)
+MOCK_GATE(ApplyCRx, int, int, double)
+MOCK_GATE(ApplyCRy, int, int, double)
+MOCK_GATE(ApplyCRz, int, int, double)
+MOCK_GATE(ApplyCCX, int, int, int)
+MOCK_GATE(ApplySwap, int, int)
+MOCK_GATE(ApplyCSwap, int, int, int)
+MOCK_GATE(ApplyCU, int, int, double, double, double, double)
@@ -0,0 +1,138 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file qasm_parser_bench.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Measures the throughput of the OpenQASM front end in MB/s.
+ *
+ * Usage: maestro_qasm_parser_bench [gates] [threads] [repetitions]
+ * A random OpenQASM 2.0 program with the given number of gates is generated,
+ * then tokenized and parsed on one thread and on the given number of threads.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "QasmParser.hpp"
+
+namespace {
+std::string GenerateProgram(size_t nrGates, size_t nrQubits)
+{
+    static const char* gates1[] = {"h", "x", "sx", "t", "s"};
+    static const char* gates2[] = {"cx", "cz", "swap"};
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> qubit(0, nrQubits - 1);
+    std::uniform_real_distribution<double> angle(-3.14159, 3.14159);
+
+    std::string program = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[" +
+                          std::to_string(nrQubits) + "];\ncreg c[" + std::to_string(nrQubits) +
+                          "];\n";
+    program.reserve(nrGates * 24);
+
+    char line[128];
+    for (size_t i = 0; i < nrGates; ++i) {
+        const size_t q0 = qubit(rng);
+        const size_t q1 = (q0 + 1 + qubit(rng) % (nrQubits - 1)) % nrQubits;
+
+        switch (i % 4) {
+        case 0:
+            std::snprintf(line, sizeof(line), "%s q[%zu];\n", gates1[i / 4 % 5], q0);
+            break;
+        case 1:
+            std::snprintf(line, sizeof(line), "rz(%.15g) q[%zu];\n", angle(rng), q0);
+            break;
+        case 2:
+            std::snprintf(line, sizeof(line), "%s q[%zu],q[%zu];\n", gates2[i / 4 % 3], q0, q1);
+            break;
+        default:
+            std::snprintf(line, sizeof(line), "u3(%.15g,%.15g,%.15g) q[%zu];\n", angle(rng),
+                          angle(rng), angle(rng), q0);
+            break;
+        }
+        program += line;
+    }
+    program += "measure q -> c;\n";
+
+    return program;
+}
+
+template <class Function>
+double Measure(size_t repetitions, const Function& function)
+{
+    double best = 0;
+    for (size_t r = 0; r < repetitions; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (r == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+
+    return best;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t nrGates = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t nrThreads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    const size_t repetitions = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 5;
+    if (nrThreads == 0)
+        nrThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    const std::string program = GenerateProgram(nrGates, 32);
+    const double megabytes = static_cast<double>(program.length()) / (1024. * 1024.);
+
+    std::printf("program: %zu gates, %.2f MB\n", nrGates, megabytes);
+
+    for (const size_t threads : {size_t(1), nrThreads}) {
+        size_t nrTokens = 0;
+        const double lexTime = Measure(repetitions, [&] {
+            nrTokens = QasmLexer::Tokenize(program, threads).size();
+        });
+
+        QasmParser parser;
+        parser.SetThreads(threads);
+        Circuit circuit;
+        bool parsed = false;
+        const double parseTime =
+            Measure(repetitions, [&] { parsed = parser.Parse(program, circuit); });
+        if (!parsed) {
+            std::printf("parse failed: %s\n", parser.GetError().c_str());
+            return 1;
+        }
+
+        std::printf("%2zu threads: tokenize %8.1f MB/s (%zu tokens), parse %8.1f MB/s (%zu "
+                    "operations)\n",
+                    threads, megabytes / lexTime, nrTokens, megabytes / parseTime,
+                    circuit.operations.size());
+
+        if (threads == nrThreads)
+            break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,431 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file soak.cpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Drives the device continuously and checks that memory and latency do not drift.
+ *
+ * Usage: maestro_device_soak [--option=value ...]
+ *   --duration=S           seconds of running (default 3600)
+ *   --interval=S           seconds between the samples (default 10)
+ *   --threads=T            submitting threads, one session each (default 4)
+ *   --inflight=N           jobs in flight per thread (default 4)
+ *   --programs=N           distinct programs submitted in turn (default 64)
+ *   --shots=N              shots of each job (default 100)
+ *   --warmup=F             fraction of the samples left out of the fits (default 0.2)
+ *   --max-rss-slope=MB     allowed growth of the resident size, MB per hour (default 64)
+ *   --max-latency-slope=MS allowed growth of the p99 latency, ms per hour (default 100)
+ *
+ * Every interval the resident size, the queued and live jobs of the device and
+ * the latency percentiles of the jobs finished in the interval are sampled. At
+ * the end the slopes of the resident size and of the p99 latency are fitted by
+ * least squares over the samples after the warmup. The run fails (exit code 2)
+ * if a slope is over its limit, if a job fails or if jobs are still alive after
+ * all of them are freed. The report is printed as JSON on stdout.
+ *
+ * To run it without the simulators, put the mock library built as maestro.so
+ * (see mock_maestro.cpp) first on the library path.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "MemoryUsage.hpp"
+#include "maestro_qdmi/device.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    double duration = 3600;
+    double interval = 10;
+    size_t threads = 4;
+    size_t inflight = 4;
+    size_t programs = 64;
+    size_t shots = 100;
+    double warmup = 0.2;
+    double maxRssSlope = 64;
+    double maxLatencySlope = 100;
+};
+
+struct Sample
+{
+    double time = 0; // seconds since the start
+    double rssMB = 0;
+    size_t queued = 0;
+    size_t liveJobs = 0;
+    size_t programs = 0;
+    size_t completed = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double p999 = 0;
+};
+
+// what the threads report to the sampler
+struct Shared
+{
+    std::mutex mutex;
+    std::vector<double> latencies; // milliseconds, of the current interval
+    size_t completed = 0;
+    size_t errors = 0;
+    std::atomic<bool> stop{false};
+};
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+            std::fprintf(stderr, "invalid argument '%s'\n", argv[i]);
+            return false;
+        }
+
+        const std::string key = arg.substr(2, eq - 2);
+        const char* value = argv[i] + eq + 1;
+        if (key == "duration")
+            options.duration = std::strtod(value, nullptr);
+        else if (key == "interval")
+            options.interval = std::strtod(value, nullptr);
+        else if (key == "threads")
+            options.threads = std::strtoull(value, nullptr, 10);
+        else if (key == "inflight")
+            options.inflight = std::strtoull(value, nullptr, 10);
+        else if (key == "programs")
+            options.programs = std::strtoull(value, nullptr, 10);
+        else if (key == "shots")
+            options.shots = std::strtoull(value, nullptr, 10);
+        else if (key == "warmup")
+            options.warmup = std::strtod(value, nullptr);
+        else if (key == "max-rss-slope")
+            options.maxRssSlope = std::strtod(value, nullptr);
+        else if (key == "max-latency-slope")
+            options.maxLatencySlope = std::strtod(value, nullptr);
+        else {
+            std::fprintf(stderr, "unknown option '%s'\n", key.c_str());
+            return false;
+        }
+    }
+
+    options.threads = std::max<size_t>(1, options.threads);
+    options.inflight = std::max<size_t>(1, options.inflight);
+    options.programs = std::max<size_t>(1, options.programs);
+    options.warmup = std::clamp(options.warmup, 0., 0.9);
+
+    return options.duration > 0 && options.interval > 0 && options.interval <= options.duration;
+}
+
+// small GHZ-like circuits, the rotation angle makes them distinct for the program cache
+std::string MakeProgram(size_t index)
+{
+    const size_t qubits = 2 + index % 6;
+    std::string text = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[" + std::to_string(qubits) +
+                       "];\ncreg c[" + std::to_string(qubits) + "];\nh q[0];\n";
+    for (size_t q = 1; q < qubits; ++q)
+        text += "cx q[" + std::to_string(q - 1) + "],q[" + std::to_string(q) + "];\n";
+    text += "rz(" + std::to_string(0.001 * static_cast<double>(index)) + ") q[0];\n";
+    text += "measure q -> c;\n";
+
+    return text;
+}
+
+size_t GetQubits(size_t index) { return 2 + index % 6; }
+
+struct Job
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    Clock::time_point submitted;
+};
+
+MAESTRO_QDMI_Device_Job Submit(MAESTRO_QDMI_Device_Session session, const std::string& program,
+                               size_t qubits, size_t shots)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    if (MAESTRO_QDMI_device_session_create_device_job(session, &job) != QDMI_SUCCESS)
+        return nullptr;
+
+    if (MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                              sizeof(size_t), &shots) != QDMI_SUCCESS ||
+        MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM1,
+                                              sizeof(size_t), &qubits) != QDMI_SUCCESS ||
+        MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                              program.length(), program.c_str()) != QDMI_SUCCESS ||
+        MAESTRO_QDMI_device_job_submit(job) != QDMI_SUCCESS) {
+        MAESTRO_QDMI_device_job_free(job);
+        return nullptr;
+    }
+
+    return job;
+}
+
+// the results are read as a client would, a done job without them is an error
+bool ReadResults(MAESTRO_QDMI_Device_Job job)
+{
+    size_t size = 0;
+    if (MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_VALUES, 0, nullptr,
+                                            &size) != QDMI_SUCCESS ||
+        size == 0)
+        return false;
+
+    std::vector<size_t> values(size / sizeof(size_t));
+
+    return MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_VALUES, size,
+                                               values.data(), nullptr) == QDMI_SUCCESS;
+}
+
+// keeps the jobs in flight, they are waited for in the order of submission
+void Drive(const Options& options, const std::vector<std::string>& programs, size_t index,
+           Shared& shared)
+{
+    MAESTRO_QDMI_Device_Session session = nullptr;
+    if (MAESTRO_QDMI_device_session_alloc(&session) != QDMI_SUCCESS ||
+        MAESTRO_QDMI_device_session_init(session) != QDMI_SUCCESS) {
+        std::lock_guard lock(shared.mutex);
+        ++shared.errors;
+        MAESTRO_QDMI_device_session_free(session);
+        return;
+    }
+
+    std::deque<Job> inFlight;
+    size_t next = index;
+    for (;;) {
+        while (!shared.stop && inFlight.size() < options.inflight) {
+            const size_t program = next++ % programs.size();
+            const auto submitted = Clock::now();
+            MAESTRO_QDMI_Device_Job job =
+                Submit(session, programs[program], GetQubits(program), options.shots);
+            if (job == nullptr) {
+                std::lock_guard lock(shared.mutex);
+                ++shared.errors;
+                break;
+            }
+            inFlight.push_back({job, submitted});
+        }
+
+        if (inFlight.empty())
+            break;
+
+        const Job job = inFlight.front();
+        inFlight.pop_front();
+
+        const bool finished = MAESTRO_QDMI_device_job_wait(job.job, 60000) == QDMI_SUCCESS;
+        const double latency =
+            std::chrono::duration<double, std::milli>(Clock::now() - job.submitted).count();
+        QDMI_Job_Status status = QDMI_JOB_STATUS_FAILED;
+        MAESTRO_QDMI_device_job_check(job.job, &status);
+        const bool done = finished && status == QDMI_JOB_STATUS_DONE && ReadResults(job.job);
+        MAESTRO_QDMI_device_job_free(job.job);
+
+        std::lock_guard lock(shared.mutex);
+        if (done) {
+            ++shared.completed;
+            shared.latencies.push_back(latency);
+        } else
+            ++shared.errors;
+    }
+
+    MAESTRO_QDMI_device_session_free(session);
+}
+
+double Percentile(const std::vector<double>& sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0;
+
+    const size_t rank =
+        static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+// the value of a key of the metrics string of the device, see GetMetrics
+size_t GetMetric(const std::string& metrics, const std::string& key)
+{
+    const std::string prefix = key + "=";
+    size_t pos = metrics.find(prefix);
+    while (pos != std::string::npos && pos != 0 && metrics[pos - 1] != ' ')
+        pos = metrics.find(prefix, pos + 1);
+    if (pos == std::string::npos)
+        return 0;
+
+    return std::strtoull(metrics.c_str() + pos + prefix.length(), nullptr, 10);
+}
+
+std::string QueryMetrics(MAESTRO_QDMI_Device_Session session)
+{
+    size_t size = 0;
+    if (MAESTRO_QDMI_device_session_query_device_property(session, QDMI_DEVICE_PROPERTY_CUSTOM5, 0,
+                                                          nullptr, &size) != QDMI_SUCCESS ||
+        size == 0)
+        return {};
+
+    std::string metrics(size, '\0');
+    if (MAESTRO_QDMI_device_session_query_device_property(session, QDMI_DEVICE_PROPERTY_CUSTOM5,
+                                                          size, metrics.data(),
+                                                          nullptr) != QDMI_SUCCESS)
+        return {};
+    metrics.resize(size - 1);
+
+    return metrics;
+}
+
+// the least squares slope of the values over the time, per hour
+double FitSlope(const std::vector<Sample>& samples, size_t first, double Sample::* value)
+{
+    const size_t count = samples.size() - first;
+    if (count < 2)
+        return 0;
+
+    double meanTime = 0;
+    double meanValue = 0;
+    for (size_t i = first; i < samples.size(); ++i) {
+        meanTime += samples[i].time;
+        meanValue += samples[i].*value;
+    }
+    meanTime /= static_cast<double>(count);
+    meanValue /= static_cast<double>(count);
+
+    double covariance = 0;
+    double variance = 0;
+    for (size_t i = first; i < samples.size(); ++i) {
+        const double dt = samples[i].time - meanTime;
+        covariance += dt * (samples[i].*value - meanValue);
+        variance += dt * dt;
+    }
+
+    return variance == 0 ? 0 : covariance / variance * 3600.;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    std::vector<std::string> programs;
+    for (size_t i = 0; i < options.programs; ++i)
+        programs.push_back(MakeProgram(i));
+
+    if (MAESTRO_QDMI_device_initialize() != QDMI_SUCCESS) {
+        std::fprintf(stderr, "cannot initialize the device\n");
+        return 1;
+    }
+
+    // the sampler has its own session for the metrics
+    MAESTRO_QDMI_Device_Session session = nullptr;
+    if (MAESTRO_QDMI_device_session_alloc(&session) != QDMI_SUCCESS ||
+        MAESTRO_QDMI_device_session_init(session) != QDMI_SUCCESS) {
+        std::fprintf(stderr, "cannot open a session\n");
+        MAESTRO_QDMI_device_finalize();
+        return 1;
+    }
+
+    Shared shared;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < options.threads; ++t)
+        threads.emplace_back(Drive, std::cref(options), std::cref(programs), t, std::ref(shared));
+
+    std::vector<Sample> samples;
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration_cast<Clock::duration>(
+                                 std::chrono::duration<double>(options.duration));
+    auto nextSample = start;
+    while (nextSample + std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double>(options.interval)) <=
+           end + std::chrono::milliseconds(1)) {
+        nextSample += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.interval));
+        std::this_thread::sleep_until(nextSample);
+
+        Sample sample;
+        std::vector<double> latencies;
+        {
+            std::lock_guard lock(shared.mutex);
+            latencies.swap(shared.latencies);
+            sample.completed = shared.completed;
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        const std::string metrics = QueryMetrics(session);
+        sample.time = std::chrono::duration<double>(Clock::now() - start).count();
+        sample.rssMB = static_cast<double>(MemoryUsage::GetResidentBytes()) / (1024. * 1024.);
+        sample.queued = GetMetric(metrics, "queued");
+        sample.liveJobs = GetMetric(metrics, "jobs");
+        sample.programs = GetMetric(metrics, "programs");
+        sample.p50 = Percentile(latencies, 0.5);
+        sample.p99 = Percentile(latencies, 0.99);
+        sample.p999 = Percentile(latencies, 0.999);
+        samples.push_back(sample);
+    }
+
+    shared.stop = true;
+    for (auto& thread : threads)
+        thread.join();
+
+    // every job is freed by now, the ones still registered leaked
+    const size_t leakedJobs = GetMetric(QueryMetrics(session), "jobs");
+
+    MAESTRO_QDMI_device_session_free(session);
+    MAESTRO_QDMI_device_finalize();
+
+    const size_t first = static_cast<size_t>(options.warmup * static_cast<double>(samples.size()));
+    const double rssSlope = FitSlope(samples, first, &Sample::rssMB);
+    const double latencySlope = FitSlope(samples, first, &Sample::p99);
+
+    const bool rssOk = rssSlope <= options.maxRssSlope;
+    const bool latencyOk = latencySlope <= options.maxLatencySlope;
+    const bool passed = rssOk && latencyOk && shared.errors == 0 && leakedJobs == 0 &&
+                        shared.completed != 0;
+
+    std::printf("{\n");
+    std::printf("  \"duration_s\": %.3f,\n", options.duration);
+    std::printf("  \"threads\": %zu,\n", options.threads);
+    std::printf("  \"completed\": %zu,\n", shared.completed);
+    std::printf("  \"errors\": %zu,\n", shared.errors);
+    std::printf("  \"leaked_jobs\": %zu,\n", leakedJobs);
+    std::printf("  \"rss_slope_mb_per_hour\": %.3f,\n", rssSlope);
+    std::printf("  \"p99_slope_ms_per_hour\": %.3f,\n", latencySlope);
+    std::printf("  \"samples\": [\n");
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const Sample& s = samples[i];
+        std::printf("    {\"t\": %.1f, \"rss_mb\": %.2f, \"queued\": %zu, \"jobs\": %zu, "
+                    "\"programs\": %zu, \"completed\": %zu, \"p50_ms\": %.3f, \"p99_ms\": %.3f, "
+                    "\"p999_ms\": %.3f}%s\n",
+                    s.time, s.rssMB, s.queued, s.liveJobs, s.programs, s.completed, s.p50, s.p99,
+                    s.p999, i + 1 < samples.size() ? "," : "");
+    }
+    std::printf("  ],\n");
+    std::printf("  \"passed\": %s\n", passed ? "true" : "false");
+    std::printf("}\n");
+
+    return passed ? 0 : 2;
+}
@@ -0,0 +1,308 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file BackendRegistry.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The simulator backends of the library and their capabilities.
+ *
+ * A job selects a backend with the simulator type and the execution type
+ * (the CUSTOM2 and CUSTOM3 job parameters). The registry resolves that pair
+ * into the simulators the library is configured with, falling back the same
+ * way for every backend: an execution type the backend does not support is
+ * replaced by its fallback list. Backends are added with Register(), the
+ * worker loop does not need to know about them.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Transpiler.hpp"
+
+// the values are the ones of the library and of the job parameters
+enum class SimulatorType : int
+{
+    Aer = 0,
+    QCSim = 1,
+    CompositeAer = 2,
+    CompositeQCSim = 3,
+    Gpu = 4,
+    QuEST = 5
+};
+
+enum class ExecutionType : int
+{
+    Statevector = 0,
+    MatrixProductState = 1,
+    Stabilizer = 2,
+    TensorNetwork = 3,
+    PauliPropagation = 4
+};
+
+enum class BackendMemory
+{
+    Host, // the state is in main memory
+    Gpu   // the state is in device memory
+};
+
+struct Backend
+{
+    SimulatorType type = SimulatorType::QCSim;
+    std::string name;
+
+    std::vector<ExecutionType> execTypes; // the supported ones
+    // what an unsupported execution type is replaced by, the library picks the
+    // fastest of them if there is more than one
+    std::vector<ExecutionType> fallback = {ExecutionType::Statevector};
+    // the ones the engines driving the gate API directly can use (noisy and
+    // unitary jobs), empty if the backend has no gate API
+    std::vector<ExecutionType> gateApiExecTypes;
+
+    size_t maxQubits = 0; // 0 - no limit
+    BackendMemory memory = BackendMemory::Host;
+
+    // an estimate of the run time for the number of qubits and gates, for scheduling,
+    // in arbitrary units comparable between the backends; unset if there is no model
+    std::function<double(ExecutionType execType, size_t qubits, size_t gates)> cost;
+
+    bool Supports(ExecutionType execType) const
+    {
+        return std::find(execTypes.begin(), execTypes.end(), execType) != execTypes.end();
+    }
+
+    bool HasGateApi() const { return !gateApiExecTypes.empty(); }
+};
+
+/**
+ * @brief The simulators a job runs on.
+ */
+struct BackendSelection
+{
+    const Backend* backend = nullptr; // nullptr - unknown type, the library picks automatically
+    std::vector<ExecutionType> execTypes;
+    TranspileTarget target = TranspileTarget::None;
+
+    int GetSimulatorType() const { return backend ? static_cast<int>(backend->type) : 0; }
+
+    int GetExecutionType() const
+    {
+        return execTypes.empty() ? 0 : static_cast<int>(execTypes.front());
+    }
+
+    bool FitsQubits(size_t qubits) const
+    {
+        return !backend || backend->maxQubits == 0 || qubits <= backend->maxQubits;
+    }
+};
+
+class BackendRegistry
+{
+public:
+    /**
+     * @brief The registry of the device, with the backends of the library registered.
+     */
+    static BackendRegistry& Get()
+    {
+        static BackendRegistry registry;
+
+        return registry;
+    }
+
+    /**
+     * @brief Adds a backend, false if there is one with the same simulator type already.
+     */
+    bool Register(Backend backend)
+    {
+        std::lock_guard lock(mutex);
+        const int key = static_cast<int>(backend.type);
+
+        return backends.emplace(key, std::make_unique<Backend>(std::move(backend))).second;
+    }
+
+    const Backend* Find(size_t simType) const
+    {
+        std::lock_guard lock(mutex);
+        const auto it = backends.find(static_cast<int>(std::min<size_t>(
+            simType, static_cast<size_t>(std::numeric_limits<int>::max()))));
+
+        return it == backends.end() ? nullptr : it->second.get();
+    }
+
+    /**
+     * @brief Resolves the simulator and execution type of a job into the simulators to configure.
+     */
+    BackendSelection Select(size_t simType, size_t simExecType) const
+    {
+        BackendSelection selection;
+        selection.backend = Find(simType);
+        if (!selection.backend)
+            return selection;
+
+        const ExecutionType execType = ToExecutionType(simExecType);
+        if (simExecType <= static_cast<size_t>(ExecutionType::PauliPropagation) &&
+            selection.backend->Supports(execType))
+            selection.execTypes.push_back(execType);
+        else
+            selection.execTypes = selection.backend->fallback;
+
+        // with several candidates it's not known which one runs the circuit
+        if (selection.execTypes.size() == 1)
+            selection.target = GetTarget(selection.execTypes.front());
+
+        return selection;
+    }
+
+    /**
+     * @brief Picks the simulator for the engines driving the gate API directly.
+     * @details Backends without the gate API are replaced by qcsim, the execution
+     * types their gate API does not have by statevector. Without clifford the
+     * stabilizer is excluded as well, it cannot apply arbitrary operations.
+     */
+    BackendSelection SelectGateApi(size_t simType, size_t simExecType, bool clifford = true) const
+    {
+        BackendSelection selection;
+        selection.backend = Find(simType);
+        if (!selection.backend || !selection.backend->HasGateApi())
+            selection.backend = Find(static_cast<size_t>(SimulatorType::QCSim));
+        if (!selection.backend)
+            return selection;
+
+        const ExecutionType execType = ToExecutionType(simExecType);
+        const auto& gateTypes = selection.backend->gateApiExecTypes;
+        const bool supported =
+            simExecType <= static_cast<size_t>(ExecutionType::PauliPropagation) &&
+            std::find(gateTypes.begin(), gateTypes.end(), execType) != gateTypes.end() &&
+            (clifford || execType != ExecutionType::Stabilizer);
+
+        selection.execTypes.push_back(supported ? execType : ExecutionType::Statevector);
+
+        return selection;
+    }
+
+    /**
+     * @brief The cost of running a circuit on the backend, infinity if there is no model.
+     */
+    double EstimateCost(size_t simType, size_t simExecType, size_t qubits, size_t gates) const
+    {
+        const BackendSelection selection = Select(simType, simExecType);
+        if (!selection.backend || !selection.backend->cost)
+            return std::numeric_limits<double>::infinity();
+
+        double best = std::numeric_limits<double>::infinity();
+        for (const ExecutionType execType : selection.execTypes)
+            best = std::min(best, selection.backend->cost(execType, qubits, gates));
+
+        return best;
+    }
+
+private:
+    BackendRegistry()
+    {
+        using E = ExecutionType;
+
+        // the statevector, the matrix product state and the stabilizer simulators
+        // are handed to the library when the execution type is not supported,
+        // it runs the circuit on the most suitable of them
+        const std::vector<E> automatic = {E::Statevector, E::MatrixProductState, E::Stabilizer};
+        const std::vector<E> gateApi = {E::Statevector, E::MatrixProductState, E::Stabilizer};
+
+        Backend aer;
+        aer.type = SimulatorType::Aer;
+        aer.name = "aer";
+        aer.execTypes = {E::Statevector, E::MatrixProductState, E::Stabilizer, E::TensorNetwork};
+        aer.fallback = automatic;
+        aer.gateApiExecTypes = gateApi;
+        Register(std::move(aer));
+
+        Backend qcsim;
+        qcsim.type = SimulatorType::QCSim;
+        qcsim.name = "qcsim";
+        qcsim.execTypes = {E::Statevector, E::MatrixProductState, E::Stabilizer, E::TensorNetwork,
+                           E::PauliPropagation};
+        qcsim.fallback = automatic;
+        qcsim.gateApiExecTypes = gateApi;
+        Register(std::move(qcsim));
+
+        // the composite simulators split the circuit, only statevector for now
+        Backend compositeAer;
+        compositeAer.type = SimulatorType::CompositeAer;
+        compositeAer.name = "composite aer";
+        compositeAer.execTypes = {E::Statevector};
+        Register(std::move(compositeAer));
+
+        Backend compositeQCSim;
+        compositeQCSim.type = SimulatorType::CompositeQCSim;
+        compositeQCSim.name = "composite qcsim";
+        compositeQCSim.execTypes = {E::Statevector};
+        Register(std::move(compositeQCSim));
+
+        Backend gpu;
+        gpu.type = SimulatorType::Gpu;
+        gpu.name = "gpu";
+        gpu.execTypes = {E::Statevector, E::MatrixProductState, E::TensorNetwork,
+                         E::PauliPropagation};
+        gpu.memory = BackendMemory::Gpu;
+        Register(std::move(gpu));
+
+        Backend quest;
+        quest.type = SimulatorType::QuEST;
+        quest.name = "quest";
+        quest.execTypes = {E::Statevector};
+        Register(std::move(quest));
+    }
+
+    // the gate set each simulator executes fastest, see Transpiler.hpp
+    static TranspileTarget GetTarget(ExecutionType execType)
+    {
+        switch (execType) {
+        case ExecutionType::Statevector:
+            return TranspileTarget::Statevector;
+        case ExecutionType::MatrixProductState:
+            return TranspileTarget::MatrixProductState;
+        case ExecutionType::Stabilizer:
+            return TranspileTarget::Stabilizer;
+        default:
+            break;
+        }
+
+        return TranspileTarget::None;
+    }
+
+    static ExecutionType ToExecutionType(size_t simExecType)
+    {
+        return simExecType <= static_cast<size_t>(ExecutionType::PauliPropagation)
+                   ? static_cast<ExecutionType>(simExecType)
+                   : ExecutionType::Statevector;
+    }
+
+    mutable std::mutex mutex;
+    // the entries are never removed or replaced, the pointers handed out stay valid
+    std::map<int, std::unique_ptr<Backend>> backends;
+};
@@ -0,0 +1,459 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file Circuit.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The internal gate stream of the device.
+ *
+ * The front ends translate the submitted programs into a circuit, the
+ * transpiler rewrites it for the selected backend and the circuit is either
+ * written back as OpenQASM 2.0 or executed gate by gate on a simulator.
+ * The gate set matches the gates exposed by the Maestro library.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+constexpr double Pi = 3.14159265358979323846;
+
+enum class GateType : uint8_t
+{
+    X,
+    Y,
+    Z,
+    H,
+    S,
+    SDG,
+    T,
+    TDG,
+    SX,
+    SXDG,
+    P,
+    Rx,
+    Ry,
+    Rz,
+    U,
+    CX,
+    CY,
+    CZ,
+    CH,
+    CSX,
+    CSXDG,
+    CP,
+    CRx,
+    CRy,
+    CRz,
+    CU,
+    Swap,
+    CCX,
+    CSwap,
+    Measure,
+    Reset,
+    Barrier
+};
+
+inline size_t GateQubits(GateType type)
+{
+    if (type >= GateType::CCX && type <= GateType::CSwap)
+        return 3;
+    if (type >= GateType::CX && type <= GateType::Swap)
+        return 2;
+
+    return 1;
+}
+
+inline size_t GateParams(GateType type)
+{
+    switch (type) {
+    case GateType::P:
+    case GateType::Rx:
+    case GateType::Ry:
+    case GateType::Rz:
+    case GateType::CP:
+    case GateType::CRx:
+    case GateType::CRy:
+    case GateType::CRz:
+        return 1;
+    case GateType::U:
+    case GateType::CU:
+        return 4;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+inline bool IsSingleQubitGate(GateType type) { return type <= GateType::U; }
+
+// the gate a controlled gate applies to its target, U for CU
+inline GateType GetControlledGate(GateType type)
+{
+    switch (type) {
+    case GateType::CX:
+        return GateType::X;
+    case GateType::CY:
+        return GateType::Y;
+    case GateType::CZ:
+        return GateType::Z;
+    case GateType::CH:
+        return GateType::H;
+    case GateType::CSX:
+        return GateType::SX;
+    case GateType::CSXDG:
+        return GateType::SXDG;
+    case GateType::CP:
+        return GateType::P;
+    case GateType::CRx:
+        return GateType::Rx;
+    case GateType::CRy:
+        return GateType::Ry;
+    case GateType::CRz:
+        return GateType::Rz;
+    default:
+        return GateType::U;
+    }
+}
+
+// the qelib1.inc names
+inline const char* GateName(GateType type)
+{
+    static const char* names[] = {"x",     "y",    "z",     "h",       "s",     "sdg",  "t",
+                                  "tdg",   "sx",   "sxdg",  "p",       "rx",    "ry",   "rz",
+                                  "u3",    "cx",   "cy",    "cz",      "ch",    "csx",  "csxdg",
+                                  "cp",    "crx",  "cry",   "crz",     "cu3",   "swap", "ccx",
+                                  "cswap", "measure", "reset", "barrier"};
+
+    return names[static_cast<size_t>(type)];
+}
+
+/**
+ * @brief A single operation of the gate stream.
+ * @details Barriers span the qubits in the [qubits[0], qubits[1]] range.
+ * A condition of size zero means the operation is unconditional, otherwise the
+ * operation is applied only if the classical bits [condOffset, condOffset + condSize)
+ * hold condValue (bit condOffset being the least significant one).
+ */
+struct Operation
+{
+    GateType type = GateType::Barrier;
+    uint32_t qubits[3] = {0, 0, 0};
+    double params[4] = {0, 0, 0, 0};
+    uint32_t cbit = 0; // measurement target
+
+    uint32_t condOffset = 0;
+    uint32_t condSize = 0;
+    uint64_t condValue = 0;
+
+    bool IsConditional() const { return condSize != 0; }
+};
+
+/**
+ * @brief The inverse of a gate, the ones without parameters are inverted by type.
+ */
+inline Operation InvertGate(const Operation& op)
+{
+    Operation inverse = op;
+
+    switch (op.type) {
+    case GateType::S:
+        inverse.type = GateType::SDG;
+        break;
+    case GateType::SDG:
+        inverse.type = GateType::S;
+        break;
+    case GateType::T:
+        inverse.type = GateType::TDG;
+        break;
+    case GateType::TDG:
+        inverse.type = GateType::T;
+        break;
+    case GateType::SX:
+        inverse.type = GateType::SXDG;
+        break;
+    case GateType::SXDG:
+        inverse.type = GateType::SX;
+        break;
+    case GateType::CSX:
+        inverse.type = GateType::CSXDG;
+        break;
+    case GateType::CSXDG:
+        inverse.type = GateType::CSX;
+        break;
+    case GateType::P:
+    case GateType::Rx:
+    case GateType::Ry:
+    case GateType::Rz:
+    case GateType::CP:
+    case GateType::CRx:
+    case GateType::CRy:
+    case GateType::CRz:
+        inverse.params[0] = -op.params[0];
+        break;
+    case GateType::U:
+    case GateType::CU:
+        // U(theta, phi, lambda, gamma)^dagger = U(-theta, -lambda, -phi, -gamma)
+        inverse.params[0] = -op.params[0];
+        inverse.params[1] = -op.params[2];
+        inverse.params[2] = -op.params[1];
+        inverse.params[3] = -op.params[3];
+        break;
+    default: // X, Y, Z, H, CX, CY, CZ, CH, Swap, CCX and CSwap are their own inverse
+        break;
+    }
+
+    return inverse;
+}
+
+struct ClassicalRegister
+{
+    std::string name;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+};
+
+class Circuit
+{
+public:
+    size_t nrQubits = 0;
+    size_t nrCbits = 0;
+
+    // kept to be able to write back the conditions on whole registers
+    std::vector<ClassicalRegister> cregs;
+    std::vector<Operation> operations;
+
+    void Add(GateType type, uint32_t q0, uint32_t q1 = 0, uint32_t q2 = 0, double p0 = 0,
+             double p1 = 0, double p2 = 0, double p3 = 0)
+    {
+        Operation op;
+        op.type = type;
+        op.qubits[0] = q0;
+        op.qubits[1] = q1;
+        op.qubits[2] = q2;
+        op.params[0] = p0;
+        op.params[1] = p1;
+        op.params[2] = p2;
+        op.params[3] = p3;
+
+        operations.push_back(op);
+    }
+
+    /**
+     * @brief Checks if the circuit needs to be simulated shot by shot.
+     * @details That is the case when it has resets, conditional operations or
+     * gates applied on a qubit after it was measured.
+     */
+    bool IsDynamic() const
+    {
+        std::vector<bool> measured(nrQubits, false);
+
+        for (const auto& op : operations) {
+            if (op.IsConditional() || op.type == GateType::Reset)
+                return true;
+            if (op.type == GateType::Measure) {
+                measured[op.qubits[0]] = true;
+                continue;
+            }
+            if (op.type == GateType::Barrier)
+                continue;
+            for (size_t q = 0; q < GateQubits(op.type); ++q)
+                if (measured[op.qubits[q]])
+                    return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Gets the classical registers the circuit is written with.
+     * @details OpenQASM 2.0 conditions compare whole registers, so the registers are
+     * split where the conditions on parts of them start and end. The bit order is kept.
+     * @return false if a condition cannot be written as a whole register comparison.
+     */
+    bool GetOutputRegisters(std::vector<ClassicalRegister>& registers) const
+    {
+        std::vector<bool> boundary(nrCbits + 1, false);
+        for (const auto& op : operations)
+            if (op.IsConditional()) {
+                boundary[op.condOffset] = true;
+                boundary[op.condOffset + op.condSize] = true;
+            }
+
+        registers.clear();
+        for (const auto& creg : cregs) {
+            const size_t first = registers.size();
+            uint32_t start = creg.offset;
+            for (uint32_t bit = creg.offset + 1; bit <= creg.offset + creg.size; ++bit)
+                if (bit == creg.offset + creg.size || boundary[bit]) {
+                    registers.push_back({creg.name, start, bit - start});
+                    start = bit;
+                }
+
+            if (registers.size() == first)
+                registers.push_back(creg);
+            else if (registers.size() - first > 1)
+                for (size_t i = first; i < registers.size(); ++i)
+                    registers[i].name += "_" + std::to_string(registers[i].offset - creg.offset);
+        }
+
+        for (size_t i = 0; i < registers.size(); ++i)
+            for (bool clash = true; clash;) {
+                clash = false;
+                for (size_t j = 0; j < registers.size(); ++j)
+                    if (j != i && registers[j].name == registers[i].name) {
+                        registers[i].name += "_";
+                        clash = true;
+                    }
+            }
+
+        for (const auto& op : operations)
+            if (op.IsConditional() && !FindRegister(registers, op.condOffset, op.condSize))
+                return false;
+
+        return true;
+    }
+
+    /**
+     * @brief Writes the circuit as an OpenQASM 2.0 program.
+     * @details The qubits are flattened into a single register, the classical
+     * registers are kept, split only if needed for the conditions.
+     */
+    std::string ToQasm() const
+    {
+        std::string qasm = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n";
+
+        std::vector<ClassicalRegister> registers;
+        GetOutputRegisters(registers);
+
+        std::string qreg = "q";
+        for (bool clash = true; clash;) {
+            clash = false;
+            for (const auto& creg : registers)
+                if (creg.name == qreg) {
+                    qreg += "q";
+                    clash = true;
+                }
+        }
+
+        qasm += "qreg " + qreg + "[" + std::to_string(nrQubits) + "];\n";
+        for (const auto& creg : registers)
+            qasm += "creg " + creg.name + "[" + std::to_string(creg.size) + "];\n";
+
+        for (const auto& op : operations)
+            WriteOperation(qasm, op, qreg, registers);
+
+        return qasm;
+    }
+
+private:
+    static std::string Number(double value)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+
+        return buffer;
+    }
+
+    static const ClassicalRegister* FindRegister(const std::vector<ClassicalRegister>& registers,
+                                                 uint32_t offset, uint32_t size)
+    {
+        for (const auto& creg : registers)
+            if (creg.offset == offset && creg.size == size)
+                return &creg;
+
+        return nullptr;
+    }
+
+    static std::string Cbit(const std::vector<ClassicalRegister>& registers, uint32_t cbit)
+    {
+        for (const auto& creg : registers)
+            if (cbit >= creg.offset && cbit < creg.offset + creg.size)
+                return creg.name + "[" + std::to_string(cbit - creg.offset) + "]";
+
+        return "c[" + std::to_string(cbit) + "]";
+    }
+
+    void WriteOperation(std::string& qasm, const Operation& op, const std::string& qreg,
+                        const std::vector<ClassicalRegister>& registers) const
+    {
+        const auto qubit = [&qreg](uint32_t q) { return qreg + "[" + std::to_string(q) + "]"; };
+
+        std::string condition;
+        if (op.IsConditional()) {
+            const ClassicalRegister* creg = FindRegister(registers, op.condOffset, op.condSize);
+            if (creg)
+                condition = "if(" + creg->name + "==" + std::to_string(op.condValue) + ") ";
+        }
+
+        std::string line;
+        switch (op.type) {
+        case GateType::Measure:
+            line = "measure " + qubit(op.qubits[0]) + " -> " + Cbit(registers, op.cbit);
+            break;
+        case GateType::Reset:
+            line = "reset " + qubit(op.qubits[0]);
+            break;
+        case GateType::Barrier:
+            line = "barrier ";
+            for (uint32_t q = op.qubits[0]; q <= op.qubits[1]; ++q)
+                line += (q == op.qubits[0] ? "" : ",") + qubit(q);
+            break;
+        case GateType::CSXDG:
+            // not in qelib1.inc, csxdg = p(-pi/4) on the control and crx(-pi/2)
+            qasm += condition + "crx(" + Number(-Pi / 2) + ") " + qubit(op.qubits[0]) + "," +
+                    qubit(op.qubits[1]) + ";\n";
+            line = "p(" + Number(-Pi / 4) + ") " + qubit(op.qubits[0]);
+            break;
+        case GateType::CU:
+            // the global phase of the controlled gate is a phase on the control
+            if (op.params[3] != 0)
+                qasm += condition + "p(" + Number(op.params[3]) + ") " + qubit(op.qubits[0]) +
+                        ";\n";
+            line = "cu3(" + Number(op.params[0]) + "," + Number(op.params[1]) + "," +
+                   Number(op.params[2]) + ") " + qubit(op.qubits[0]) + "," + qubit(op.qubits[1]);
+            break;
+        case GateType::U:
+            // the global phase is irrelevant here
+            line = "u3(" + Number(op.params[0]) + "," + Number(op.params[1]) + "," +
+                   Number(op.params[2]) + ") " + qubit(op.qubits[0]);
+            break;
+        default: {
+            line = GateName(op.type);
+            const size_t nrParams = GateParams(op.type);
+            if (nrParams) {
+                line += "(";
+                for (size_t p = 0; p < nrParams; ++p)
+                    line += (p ? "," : "") + Number(op.params[p]);
+                line += ")";
+            }
+            line += " ";
+            for (size_t q = 0; q < GateQubits(op.type); ++q)
+                line += (q ? "," : "") + qubit(op.qubits[q]);
+        } break;
+        }
+
+        qasm += condition + line + ";\n";
+    }
+};
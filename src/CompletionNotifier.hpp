@@ -0,0 +1,159 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file CompletionNotifier.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Completion notification of the jobs of a session for event loops.
+ *
+ * Once enabled, the ids of the finished jobs are queued and a file descriptor
+ * becomes readable while the queue is not empty, so it can be added to epoll,
+ * io_uring or poll next to other sources. The ids are drained without blocking,
+ * draining the last one makes the descriptor non readable again.
+ *
+ * It's an eventfd on Linux and a pipe on the other POSIX systems. On Windows
+ * there is no descriptor, Enable() fails.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+class CompletionNotifier
+{
+public:
+    CompletionNotifier() = default;
+    CompletionNotifier(const CompletionNotifier&) = delete;
+    CompletionNotifier& operator=(const CompletionNotifier&) = delete;
+
+    ~CompletionNotifier()
+    {
+#if !defined(_WIN32)
+        if (readFd != -1)
+            close(readFd);
+        if (writeFd != -1 && writeFd != readFd)
+            close(writeFd);
+#endif
+    }
+
+    /**
+     * @brief Creates the descriptor if needed, the jobs finished before are not reported.
+     * @return the descriptor to wait on for reading or -1 if it cannot be created.
+     */
+    int Enable()
+    {
+        std::lock_guard lock(mutex);
+        if (readFd != -1)
+            return readFd;
+
+#if defined(__linux__)
+        readFd = writeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#elif !defined(_WIN32)
+        int fds[2];
+        if (pipe(fds) == 0) {
+            for (const int fd : fds) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+            readFd = fds[0];
+            writeFd = fds[1];
+        }
+#endif
+
+        return readFd;
+    }
+
+    /**
+     * @brief Queues the id of a finished job, nothing is done if not enabled.
+     */
+    void Notify(size_t id)
+    {
+        std::lock_guard lock(mutex);
+        if (readFd == -1)
+            return;
+
+        // the descriptor is signaled only when the queue stops being empty
+        completed.push_back(id);
+        if (completed.size() == 1)
+            Signal();
+    }
+
+    /**
+     * @brief Moves up to max ids into ids, returns their number.
+     */
+    size_t Drain(size_t* ids, size_t max)
+    {
+        std::lock_guard lock(mutex);
+
+        size_t count = 0;
+        for (; count < max && !completed.empty(); ++count) {
+            ids[count] = completed.front();
+            completed.pop_front();
+        }
+
+        if (count != 0 && completed.empty())
+            Clear();
+
+        return count;
+    }
+
+    size_t Pending()
+    {
+        std::lock_guard lock(mutex);
+
+        return completed.size();
+    }
+
+private:
+    void Signal()
+    {
+#if !defined(_WIN32)
+        const uint64_t one = 1;
+        [[maybe_unused]] const auto written =
+            write(writeFd, &one, readFd == writeFd ? sizeof(one) : 1);
+#endif
+    }
+
+    void Clear()
+    {
+#if !defined(_WIN32)
+        uint64_t buffer = 0;
+        // the eventfd counter is reset by a single read
+        while (read(readFd, &buffer, sizeof(buffer)) > 0 && readFd != writeFd)
+            ;
+#endif
+    }
+
+    std::mutex mutex;
+    std::deque<size_t> completed;
+    int readFd = -1;
+    int writeFd = -1;
+};
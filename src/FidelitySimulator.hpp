@@ -0,0 +1,94 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file FidelitySimulator.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Computes the fidelity of the states prepared by two circuits.
+ *
+ * The overlap circuit built by OverlapProgram is run on one simulator with the
+ * gate API and the probability of the all zero outcome is read from it. With
+ * the matrix product state simulator this reaches well past the qubit counts a
+ * statevector can hold, the result is then as exact as the bond dimension allows.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "Circuit.hpp"
+#include "Simulator.hpp"
+
+class FidelitySimulator
+{
+public:
+    struct Config
+    {
+        std::string library;
+        int simType = 1;     // aer or qcsim, see CreateSimulator
+        int simExecType = 0; // statevector or matrix product state
+        size_t maxBondDim = 0;
+        bool isolated = false; // loads its own instance of the library, see Library.h
+    };
+
+    // the number of gates applied between the checks of stop
+    static constexpr size_t StopCheckGates = 1024;
+
+    /**
+     * @brief Runs the overlap circuit, fidelity is the probability of |0...0> at the end.
+     * @details stop is checked every StopCheckGates gates.
+     */
+    static SimulationResult Run(const Circuit& circuit, const Config& config, double& fidelity,
+                                const std::function<bool()>& stop = {})
+    {
+        fidelity = 0;
+        if (circuit.nrQubits == 0)
+            return SimulationResult::Failed;
+
+        try {
+            Simulator simulator;
+            if (!simulator.Init(config.library.c_str(), config.isolated) ||
+                !simulator.CreateSimulator(config.simType, config.simExecType))
+                return SimulationResult::Failed;
+            if (config.maxBondDim != 0)
+                simulator.ConfigureSimulator("matrix_product_state_max_bond_dimension",
+                                             std::to_string(config.maxBondDim).c_str());
+            simulator.AllocateQubits(static_cast<unsigned long int>(circuit.nrQubits));
+            simulator.InitializeSimulator();
+
+            size_t applied = 0;
+            for (const auto& op : circuit.operations) {
+                if (++applied % StopCheckGates == 0 && stop && stop())
+                    return SimulationResult::Stopped;
+                simulator.ApplyOperation(op);
+            }
+
+            // rounding can push it slightly out of range
+            fidelity = std::clamp(simulator.Probability(0), 0., 1.);
+        } catch (const std::exception&) {
+            return SimulationResult::Failed;
+        }
+
+        return SimulationResult::Done;
+    }
+};
@@ -0,0 +1,277 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file JobOptions.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Device specific job options.
+ *
+ * The options are passed as text, a list of `key=value` pairs separated by
+ * `;` or whitespace, for example "top_k=100; min_count=5".
+ * A session can set default options that are inherited by all of its jobs,
+ * the job options are applied on top of them.
+ * The noise model keys are described in NoiseModel.hpp.
+ */
+
+#pragma once
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+#include "NoiseModel.hpp"
+#include "VariantGenerator.hpp"
+
+enum class JobOptionsError
+{
+    None,
+    UnknownKey,
+    InvalidValue
+};
+
+class JobOptions
+{
+public:
+    // histogram selection, see the custom results of the device
+    size_t top_k = 0;     // 0 - no limit, otherwise only the k most frequent outcomes are kept
+    size_t min_count = 0; // 0 - no threshold, otherwise outcomes with fewer counts are dropped
+
+    // rewrite the program for the gate set of the selected backend, see Transpiler.hpp
+    bool transpile = true;
+
+    // 0 - all the shots are executed at once, otherwise in segments of this many shots,
+    // a canceled or aborted job stops at the end of the current segment
+    size_t segment_shots = 0;
+
+    // 0 - the jobs are queued for the worker, otherwise plain sampling jobs with up to this
+    // many qubits run in job_submit on the calling thread, skipping the thread handoff
+    size_t inline_qubits = 0;
+
+    // a job with noise is executed in Monte Carlo trajectories, see TrajectorySimulator.hpp
+    NoiseModel noise;
+    size_t trajectories = 0; // 0 - default, otherwise the shots are spread over this many, even
+                             // without noise
+
+    // compute the unitary of the circuit instead of sampling it, see UnitarySimulator.hpp
+    bool unitary = false;
+
+    // run variants of the program generated on the device, see VariantGenerator.hpp
+    size_t variants = 0; // 0 - the program as it is
+    VariantMode variant_mode = VariantMode::Twirl;
+    size_t variant_seed = 0;  // 0 - a random seed for each job
+    bool per_variant = false; // the histogram keys get the variant index as a prefix
+
+    // take classical shadow snapshots instead of sampling, see ShadowSimulator.hpp
+    size_t shadows = 0;     // 0 - no shadows, otherwise the number of snapshots
+    size_t shadow_seed = 0; // 0 - a random seed for each job
+
+    // compute the stabilizer tableau of a Clifford circuit instead of sampling it,
+    // see StabilizerTableau.hpp
+    bool tableau = false;
+
+    // evolve a matrix product state on the device and return it instead of sampling,
+    // optionally starting from an exported one, see MatrixProductState.hpp
+    bool mps = false;
+    std::string mps_initial; // empty - |0...0>, otherwise the path of an exported state
+
+    // return the Bloch vectors and the <Z_i Z_j> correlators of the matrix product state
+    // instead of the state itself, see MatrixProductState.hpp
+    bool observables = false;
+
+    // estimate the expectation value of a Pauli sum by propagating it back through the circuit
+    // instead of sampling, truncated by weight and coefficient, see PauliPropagator.hpp
+    std::string pauli_observable; // empty - sampling, otherwise the observable
+    size_t pauli_max_weight = 0;  // 0 - no limit, otherwise longer strings are dropped
+    double pauli_threshold = 0;   // strings with smaller absolute coefficients are dropped
+
+    /**
+     * @brief The number of options set that replace the sampling, at most one is allowed.
+     */
+    size_t GetResultModes() const
+    {
+        return static_cast<size_t>(unitary) + (shadows != 0) + static_cast<size_t>(tableau) +
+               static_cast<size_t>(mps) + static_cast<size_t>(observables) +
+               static_cast<size_t>(!pauli_observable.empty());
+    }
+
+    /**
+     * @brief True if the job is sampled in trajectories, it has noise or sets their number.
+     */
+    bool UsesTrajectories() const { return !noise.IsNoiseless() || trajectories != 0; }
+
+    /**
+     * @brief Parses the options text and applies the values on top of the current ones.
+     * @details Nothing is changed if an error is returned.
+     */
+    JobOptionsError Parse(const std::string& text)
+    {
+        JobOptions parsed = *this;
+
+        size_t pos = 0;
+        while (pos < text.length()) {
+            while (pos < text.length() && IsSeparator(text[pos]))
+                ++pos;
+            if (pos >= text.length())
+                break;
+
+            const size_t start = pos;
+            while (pos < text.length() && !IsSeparator(text[pos]))
+                ++pos;
+
+            const std::string pair = text.substr(start, pos - start);
+            const size_t eq = pair.find('=');
+            if (eq == std::string::npos || eq == 0)
+                return JobOptionsError::InvalidValue;
+
+            const JobOptionsError err = parsed.Set(pair.substr(0, eq), pair.substr(eq + 1));
+            if (err != JobOptionsError::None)
+                return err;
+        }
+
+        *this = parsed;
+
+        return JobOptionsError::None;
+    }
+
+private:
+    static bool IsSeparator(char c)
+    {
+        return c == ';' || std::isspace(static_cast<unsigned char>(c));
+    }
+
+    static bool ParseValue(const std::string& value, size_t& result)
+    {
+        if (value.empty())
+            return false;
+
+        size_t parsed = 0;
+        for (const char c : value) {
+            if (!std::isdigit(static_cast<unsigned char>(c)))
+                return false;
+            // values that do not fit are rejected instead of wrapping around
+            const size_t digit = static_cast<size_t>(c - '0');
+            if (parsed > (std::numeric_limits<size_t>::max() - digit) / 10)
+                return false;
+            parsed = parsed * 10 + digit;
+        }
+        result = parsed;
+
+        return true;
+    }
+
+    static bool ParseValue(const std::string& value, bool& result)
+    {
+        if (value == "1" || value == "true" || value == "on")
+            result = true;
+        else if (value == "0" || value == "false" || value == "off")
+            result = false;
+        else
+            return false;
+
+        return true;
+    }
+
+    // non negative reals only
+    static bool ParseValue(const std::string& value, double& result)
+    {
+        char* end = nullptr;
+        const double parsed = std::strtod(value.c_str(), &end);
+        if (value.empty() || *end != 0 || !std::isfinite(parsed) || parsed < 0)
+            return false;
+        result = parsed;
+
+        return true;
+    }
+
+    static bool ParseValue(const std::string& value, std::string& result)
+    {
+        if (value.empty())
+            return false;
+        result = value;
+
+        return true;
+    }
+
+    static bool ParseValue(const std::string& value, VariantMode& result)
+    {
+        if (value == "twirl")
+            result = VariantMode::Twirl;
+        else if (value == "fold")
+            result = VariantMode::Fold;
+        else
+            return false;
+
+        return true;
+    }
+
+    JobOptionsError Set(const std::string& key, const std::string& value)
+    {
+        bool valid = false;
+
+        if (key == "top_k")
+            valid = ParseValue(value, top_k);
+        else if (key == "min_count")
+            valid = ParseValue(value, min_count);
+        else if (key == "transpile")
+            valid = ParseValue(value, transpile);
+        else if (key == "segment_shots")
+            valid = ParseValue(value, segment_shots);
+        else if (key == "inline_qubits")
+            valid = ParseValue(value, inline_qubits);
+        else if (key == "trajectories")
+            valid = ParseValue(value, trajectories);
+        else if (key == "unitary")
+            valid = ParseValue(value, unitary);
+        else if (key == "variants")
+            valid = ParseValue(value, variants);
+        else if (key == "variant_mode")
+            valid = ParseValue(value, variant_mode);
+        else if (key == "variant_seed")
+            valid = ParseValue(value, variant_seed);
+        else if (key == "per_variant")
+            valid = ParseValue(value, per_variant);
+        else if (key == "shadows")
+            valid = ParseValue(value, shadows);
+        else if (key == "shadow_seed")
+            valid = ParseValue(value, shadow_seed);
+        else if (key == "tableau")
+            valid = ParseValue(value, tableau);
+        else if (key == "mps")
+            valid = ParseValue(value, mps);
+        else if (key == "mps_initial")
+            valid = ParseValue(value, mps_initial);
+        else if (key == "observables")
+            valid = ParseValue(value, observables);
+        else if (key == "pauli_observable")
+            valid = ParseValue(value, pauli_observable);
+        else if (key == "pauli_max_weight")
+            valid = ParseValue(value, pauli_max_weight);
+        else if (key == "pauli_threshold")
+            valid = ParseValue(value, pauli_threshold);
+        else if (NoiseModel::IsNoiseKey(key))
+            valid = noise.Set(key, value);
+        else
+            return JobOptionsError::UnknownKey;
+
+        return valid ? JobOptionsError::None : JobOptionsError::InvalidValue;
+    }
+};
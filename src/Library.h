@@ -24,6 +24,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
  * The library class.
  *
  * Used to dynamically load a library on linux or windows.
+ * On glibc the library can be loaded isolated, into a link map namespace of
+ * its own, then it does not share its global state with other instances.
  */
 
 #pragma once
@@ -65,10 +67,23 @@ public:
 #endif
     }
 
-    virtual bool Init(const char* libName) noexcept
+    /**
+     * @brief Loads the library.
+     * @details If isolated, the library is loaded with dlmopen into a new namespace, with its
+     * own copy of its dependencies. Where that's not available or glibc runs out of
+     * namespaces (there are 16) it's loaded normally, IsIsolated() tells which one happened.
+     */
+    virtual bool Init(const char* libName, bool isolated = false) noexcept
     {
 #if defined(__linux__) || defined(__APPLE__)
-        handle = dlopen(libName, RTLD_NOW);
+#if defined(__GLIBC__) && defined(LM_ID_NEWLM)
+        if (isolated) {
+            handle = dlmopen(LM_ID_NEWLM, libName, RTLD_NOW | RTLD_LOCAL);
+            isIsolated = handle != nullptr;
+        }
+        if (handle == nullptr)
+#endif
+            handle = dlopen(libName, RTLD_NOW);
 
         if (handle == nullptr) {
             const char* dlsym_error = dlerror();
@@ -78,6 +93,7 @@ public:
             return false;
         }
 #elif defined(_WIN32)
+        // a dll is mapped only once per process, there is no isolation
         handle = LoadLibraryA(libName);
         if (handle == nullptr) {
             const DWORD error = GetLastError();
@@ -86,6 +102,8 @@ public:
         }
 #endif
 
+        (void)isolated;
+
         return true;
     }
 
@@ -100,12 +118,15 @@ public:
 
     const void* GetHandle() const noexcept { return handle; }
 
+    bool IsIsolated() const noexcept { return isIsolated; }
+
 private:
 #if defined(__linux__) || defined(__APPLE__)
     void* handle = nullptr;
 #elif defined(_WIN32)
     HINSTANCE handle = nullptr;
 #endif
+    bool isIsolated = false;
 };
 
 } // namespace Utils
@@ -32,9 +32,9 @@ public:
 
     virtual ~MaestroLibrary() {}
 
-    bool Init(const char* libName) noexcept override
+    bool Init(const char* libName, bool isolated = false) noexcept override
     {
-        if (Utils::Library::Init(libName)) {
+        if (Utils::Library::Init(libName, isolated)) {
             fGetMaestroObject = (void* (*)())GetFunction("GetMaestroObjectWithMute");
             CheckFunction((void*)fGetMaestroObject, __LINE__);
             if (fGetMaestroObject) {
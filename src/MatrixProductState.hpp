@@ -0,0 +1,635 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file MatrixProductState.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * A matrix product state kept on the device, for checkpointing.
+ *
+ * The gate API of the library does not give access to the tensors of its
+ * matrix product state simulator, so the state that is exported or imported
+ * is evolved here. The circuit is made nearest neighbour with the matrix
+ * product state transpiler target, two qubit gates are applied to the two
+ * sites and split again with a singular value decomposition, truncated to the
+ * maximum bond dimension (0 - no limit). The state is kept in mixed canonical
+ * form so the truncation is the optimal one.
+ *
+ * The exported layout, in the native byte order:
+ * - n, the number of qubits, as uint64_t
+ * - the n + 1 bond dimensions as uint64_t, the first and the last are 1
+ * - the site tensors of the qubits 0 to n - 1, site q has
+ *   bond[q] * 2 * bond[q + 1] complex doubles (real, imaginary) indexed by
+ *   (left, physical, right) with the right index the fastest
+ * The amplitude of the basis state with bit q for qubit q is the product of
+ * the site matrices selected by the bits.
+ *
+ * The local observables are read from the canonical form in one sweep: the
+ * reduced density matrix of a qubit is its site with the center on it, and
+ * <Z_i Z_j> for all j > i comes from one transfer matrix pass started at i.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Circuit.hpp"
+#include "Simulator.hpp"
+#include "Transpiler.hpp"
+
+class MatrixProductState
+{
+public:
+    using Complex = std::complex<double>;
+    using Tensor = std::vector<Complex>;
+
+    // the number of gates applied between the checks of stop
+    static constexpr size_t StopCheckGates = 64;
+
+    // singular values smaller than this fraction of the largest one are dropped
+    static constexpr double Cutoff = 1e-13;
+
+    explicit MatrixProductState(size_t qubits = 0, size_t maxBondDim = 0)
+        : maxBond(maxBondDim)
+    {
+        Reset(qubits);
+    }
+
+    // |0...0>
+    void Reset(size_t qubits)
+    {
+        bonds.assign(qubits + 1, 1);
+        sites.assign(qubits, Tensor{1., 0.});
+        center = 0;
+    }
+
+    void SetMaxBondDim(size_t maxBondDim) { maxBond = maxBondDim; }
+
+    size_t GetNrQubits() const { return sites.size(); }
+
+    // the dimension of the bond on the left of site q, GetBondDim(n) is the last one
+    size_t GetBondDim(size_t q) const { return bonds[q]; }
+
+    /**
+     * @brief Applies the circuit to the state, which starts as |0...0> if it has no qubits.
+     * @details stop is checked every StopCheckGates gates. Failed if the circuit is dynamic
+     * or has more qubits than the state.
+     */
+    static SimulationResult Run(const Circuit& circuit, MatrixProductState& state,
+                                const std::function<bool()>& stop = {})
+    {
+        if (circuit.IsDynamic())
+            return SimulationResult::Failed;
+        if (state.GetNrQubits() == 0)
+            state.Reset(circuit.nrQubits);
+        if (state.GetNrQubits() == 0 || circuit.nrQubits > state.GetNrQubits())
+            return SimulationResult::Failed;
+
+        // without measurements at the end the layout is restored after the swap chains
+        Circuit gates = circuit;
+        gates.nrQubits = state.GetNrQubits();
+        gates.operations.clear();
+        for (const auto& op : circuit.operations)
+            if (op.type != GateType::Measure && op.type != GateType::Barrier)
+                gates.operations.push_back(op);
+
+        const Circuit lowered = Transpiler::Transpile(gates, TranspileTarget::MatrixProductState);
+
+        size_t applied = 0;
+        for (const auto& op : lowered.operations) {
+            if (++applied % StopCheckGates == 0 && stop && stop())
+                return SimulationResult::Stopped;
+            if (!state.Apply(op))
+                return SimulationResult::Failed;
+        }
+
+        return SimulationResult::Done;
+    }
+
+    /**
+     * @brief Applies a gate, false if it acts on more than two qubits or on sites that are
+     * not neighbours.
+     * @details Measurements and barriers are ignored.
+     */
+    bool Apply(const Operation& op)
+    {
+        if (op.type == GateType::Measure || op.type == GateType::Barrier)
+            return true;
+
+        const size_t nrQubits = GateQubits(op.type);
+        for (size_t q = 0; q < nrQubits; ++q)
+            if (op.qubits[q] >= GetNrQubits())
+                return false;
+
+        if (nrQubits == 1) {
+            Transpiler::Matrix m;
+            Transpiler::GetMatrix(op, m);
+            ApplySingle(op.qubits[0], m);
+            return true;
+        }
+
+        const uint32_t a = op.qubits[0];
+        const uint32_t b = op.qubits[1];
+        if (nrQubits != 2 || (a + 1 != b && b + 1 != a))
+            return false;
+
+        // the two qubit matrix in the basis |s_left s_right>, row is the output
+        Complex g[4][4] = {};
+        if (op.type == GateType::Swap) {
+            g[0][0] = g[1][2] = g[2][1] = g[3][3] = 1.;
+        } else {
+            Operation target = op;
+            target.type = GetControlledGate(op.type);
+            Transpiler::Matrix m;
+            Transpiler::GetMatrix(target, m);
+
+            // the control is the first qubit of the operation
+            const bool controlLeft = a < b;
+            for (int in = 0; in < 4; ++in) {
+                const int control = controlLeft ? in >> 1 : in & 1;
+                const int t = controlLeft ? in & 1 : in >> 1;
+                if (control == 0) {
+                    g[in][in] = 1.;
+                    continue;
+                }
+                for (int out = 0; out < 2; ++out) {
+                    const int row = controlLeft ? 2 + out : 2 * out + 1;
+                    g[row][in] = m[out][t];
+                }
+            }
+        }
+
+        ApplyTwo(std::min(a, b), g);
+
+        return true;
+    }
+
+    /**
+     * @brief The amplitude of a basis state, bit q is the value of qubit q.
+     */
+    Complex Amplitude(uint64_t basis) const
+    {
+        Tensor row{1.};
+        for (size_t q = 0; q < sites.size(); ++q) {
+            const size_t right = bonds[q + 1];
+            const size_t s = (basis >> q) & 1;
+            Tensor next(right, 0.);
+            for (size_t l = 0; l < row.size(); ++l)
+                for (size_t r = 0; r < right; ++r)
+                    next[r] += row[l] * sites[q][(l * 2 + s) * right + r];
+            row = std::move(next);
+        }
+
+        return row[0];
+    }
+
+    std::vector<uint8_t> Export() const
+    {
+        size_t size = (bonds.size() + 1) * sizeof(uint64_t);
+        for (const auto& site : sites)
+            size += site.size() * sizeof(Complex);
+
+        std::vector<uint8_t> bytes(size);
+        uint8_t* out = bytes.data();
+        const uint64_t nrQubits = sites.size();
+        std::memcpy(out, &nrQubits, sizeof(nrQubits));
+        out += sizeof(nrQubits);
+        for (const size_t bond : bonds) {
+            const uint64_t value = bond;
+            std::memcpy(out, &value, sizeof(value));
+            out += sizeof(value);
+        }
+        for (const auto& site : sites) {
+            std::memcpy(out, site.data(), site.size() * sizeof(Complex));
+            out += site.size() * sizeof(Complex);
+        }
+
+        return bytes;
+    }
+
+    /**
+     * @brief Reads a state in the exported layout, nothing is changed if it's not valid.
+     */
+    bool Import(const std::vector<uint8_t>& bytes)
+    {
+        uint64_t nrQubits = 0;
+        if (bytes.size() < sizeof(nrQubits))
+            return false;
+        std::memcpy(&nrQubits, bytes.data(), sizeof(nrQubits));
+        if (nrQubits == 0 || nrQubits > bytes.size() / sizeof(uint64_t))
+            return false;
+
+        size_t pos = sizeof(nrQubits);
+        std::vector<size_t> readBonds(static_cast<size_t>(nrQubits) + 1);
+        if (bytes.size() - pos < readBonds.size() * sizeof(uint64_t))
+            return false;
+        for (auto& bond : readBonds) {
+            uint64_t value = 0;
+            std::memcpy(&value, bytes.data() + pos, sizeof(value));
+            pos += sizeof(value);
+            if (value == 0 || value > bytes.size())
+                return false;
+            bond = static_cast<size_t>(value);
+        }
+        if (readBonds.front() != 1 || readBonds.back() != 1)
+            return false;
+
+        std::vector<Tensor> readSites(static_cast<size_t>(nrQubits));
+        for (size_t q = 0; q < readSites.size(); ++q) {
+            const size_t count = readBonds[q] * 2 * readBonds[q + 1];
+            if ((bytes.size() - pos) / sizeof(Complex) < count)
+                return false;
+            readSites[q].resize(count);
+            std::memcpy(readSites[q].data(), bytes.data() + pos, count * sizeof(Complex));
+            pos += count * sizeof(Complex);
+        }
+        if (pos != bytes.size())
+            return false;
+
+        bonds = std::move(readBonds);
+        sites = std::move(readSites);
+
+        // a sweep from the right brings any state to the canonical form
+        center = sites.size() - 1;
+        MoveCenter(0);
+
+        return true;
+    }
+
+    /**
+     * @brief The Bloch vectors of all the qubits and the <Z_i Z_j> correlators.
+     * @details bloch gets <X>, <Y>, <Z> for each qubit, 3n values, zz the n x n symmetric
+     * matrix in row major order with ones on the diagonal. The canonical center is moved.
+     */
+    void GetLocalObservables(std::vector<double>& bloch, std::vector<double>& zz)
+    {
+        const size_t n = sites.size();
+        bloch.assign(3 * n, 0.);
+        zz.assign(n * n, 0.);
+
+        for (size_t i = 0; i < n; ++i) {
+            MoveCenter(i);
+
+            // the reduced density matrix of qubit i, rho[s][t] = <s|rho|t>
+            const Tensor& site = sites[i];
+            const size_t left = bonds[i];
+            const size_t right = bonds[i + 1];
+            Complex rho[2][2] = {};
+            for (size_t l = 0; l < left; ++l)
+                for (size_t r = 0; r < right; ++r)
+                    for (size_t s = 0; s < 2; ++s)
+                        for (size_t t = 0; t < 2; ++t)
+                            rho[s][t] += site[(l * 2 + s) * right + r] *
+                                         std::conj(site[(l * 2 + t) * right + r]);
+
+            const double norm = std::real(rho[0][0] + rho[1][1]);
+            if (norm <= 0)
+                continue;
+            bloch[3 * i] = 2 * std::real(rho[0][1]) / norm;
+            bloch[3 * i + 1] = -2 * std::imag(rho[0][1]) / norm;
+            bloch[3 * i + 2] = std::real(rho[0][0] - rho[1][1]) / norm;
+            zz[i * n + i] = 1.;
+
+            // the left part is an isometry, the environment starts at the center with Z on it
+            Tensor env(right * right, 0.);
+            for (size_t l = 0; l < left; ++l)
+                for (size_t s = 0; s < 2; ++s)
+                    for (size_t r = 0; r < right; ++r)
+                        for (size_t r2 = 0; r2 < right; ++r2)
+                            env[r * right + r2] += (s == 0 ? 1. : -1.) *
+                                                   std::conj(site[(l * 2 + s) * right + r]) *
+                                                   site[(l * 2 + s) * right + r2];
+
+            for (size_t j = i + 1; j < n; ++j) {
+                // the right part is an isometry, the trace with Z on j closes the network
+                const Tensor withZ = Transfer(env, j, true);
+                Complex trace = 0;
+                for (size_t r = 0; r < bonds[j + 1]; ++r)
+                    trace += withZ[r * bonds[j + 1] + r];
+                zz[i * n + j] = zz[j * n + i] = std::real(trace) / norm;
+
+                if (j + 1 < n)
+                    env = Transfer(env, j, false);
+            }
+        }
+    }
+
+    /**
+     * @brief Reads an exported state from a file, nothing is changed if it's not valid.
+     */
+    bool Load(const std::string& path)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return false;
+
+        std::vector<uint8_t> bytes;
+        uint8_t buffer[65536];
+        size_t read = 0;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+            bytes.insert(bytes.end(), buffer, buffer + read);
+        const bool success = std::ferror(file) == 0;
+        std::fclose(file);
+
+        return success && Import(bytes);
+    }
+
+private:
+    static std::ptrdiff_t Offset(size_t index) { return static_cast<std::ptrdiff_t>(index); }
+
+    // env(r, r') moved over site q, optionally with Z on it
+    Tensor Transfer(const Tensor& env, size_t q, bool withZ) const
+    {
+        const Tensor& site = sites[q];
+        const size_t left = bonds[q];
+        const size_t right = bonds[q + 1];
+
+        // t(m, s, r') = sum over m' of env(m, m') site(m', s, r')
+        Tensor t(left * 2 * right, 0.);
+        for (size_t m = 0; m < left; ++m)
+            for (size_t m2 = 0; m2 < left; ++m2) {
+                const Complex e = env[m * left + m2];
+                if (e == 0.)
+                    continue;
+                for (size_t k = 0; k < 2 * right; ++k)
+                    t[m * 2 * right + k] += e * site[m2 * 2 * right + k];
+            }
+
+        Tensor result(right * right, 0.);
+        for (size_t m = 0; m < left; ++m)
+            for (size_t s = 0; s < 2; ++s) {
+                const double sign = withZ && s == 1 ? -1. : 1.;
+                for (size_t r = 0; r < right; ++r) {
+                    const Complex b = sign * std::conj(site[(m * 2 + s) * right + r]);
+                    if (b == 0.)
+                        continue;
+                    for (size_t r2 = 0; r2 < right; ++r2)
+                        result[r * right + r2] += b * t[(m * 2 + s) * right + r2];
+                }
+            }
+
+        return result;
+    }
+
+    void ApplySingle(size_t q, const Transpiler::Matrix& m)
+    {
+        Tensor& site = sites[q];
+        const size_t left = bonds[q];
+        const size_t right = bonds[q + 1];
+        for (size_t l = 0; l < left; ++l)
+            for (size_t r = 0; r < right; ++r) {
+                Complex& s0 = site[(l * 2) * right + r];
+                Complex& s1 = site[(l * 2 + 1) * right + r];
+                const Complex v0 = s0;
+                s0 = m[0][0] * v0 + m[0][1] * s1;
+                s1 = m[1][0] * v0 + m[1][1] * s1;
+            }
+    }
+
+    // applies g to the sites p and p + 1, the canonical center ends up on p + 1
+    void ApplyTwo(size_t p, const Complex (&g)[4][4])
+    {
+        MoveCenter(p);
+
+        const size_t left = bonds[p];
+        const size_t middle = bonds[p + 1];
+        const size_t right = bonds[p + 2];
+        const Tensor& a = sites[p];
+        const Tensor& b = sites[p + 1];
+
+        // theta(l, sa, sb, r) contracted over the middle bond, then the gate
+        Tensor theta(left * 4 * right, 0.);
+        for (size_t l = 0; l < left; ++l)
+            for (size_t sa = 0; sa < 2; ++sa)
+                for (size_t m = 0; m < middle; ++m) {
+                    const Complex am = a[(l * 2 + sa) * middle + m];
+                    if (am == 0.)
+                        continue;
+                    for (size_t sb = 0; sb < 2; ++sb)
+                        for (size_t r = 0; r < right; ++r)
+                            theta[((l * 2 + sa) * 2 + sb) * right + r] +=
+                                am * b[(m * 2 + sb) * right + r];
+                }
+
+        Tensor gated(theta.size(), 0.);
+        for (size_t l = 0; l < left; ++l)
+            for (size_t out = 0; out < 4; ++out)
+                for (size_t in = 0; in < 4; ++in) {
+                    if (g[out][in] == 0.)
+                        continue;
+                    for (size_t r = 0; r < right; ++r)
+                        gated[((l * 4) + out) * right + r] +=
+                            g[out][in] * theta[((l * 4) + in) * right + r];
+                }
+
+        // the rows are (l, sa) and the columns (sb, r)
+        Split(gated, p, left * 2, 2 * right, maxBond, true);
+    }
+
+    // splits the matrix into sites p and p + 1, the singular values go right or left
+    void Split(const Tensor& matrix, size_t p, size_t rows, size_t cols, size_t limit,
+               bool toRight)
+    {
+        Tensor u;
+        Tensor v;
+        std::vector<double> s;
+        Svd(matrix, rows, cols, u, s, v);
+
+        // truncation, the kept values are rescaled to keep the norm
+        size_t k = 1;
+        while (k < s.size() && s[k] > Cutoff * s[0] && (limit == 0 || k < limit))
+            ++k;
+        const double total = std::accumulate(s.begin(), s.end(), 0., [](double sum, double x) {
+            return sum + x * x;
+        });
+        const double kept = std::accumulate(s.begin(), std::next(s.begin(), Offset(k)), 0.,
+                                            [](double sum, double x) { return sum + x * x; });
+        const double scale = kept > 0 ? std::sqrt(total / kept) : 1.;
+
+        const size_t left = bonds[p];
+        const size_t right = bonds[p + 2];
+        Tensor a(left * 2 * k);
+        Tensor b(k * 2 * right);
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < k; ++j)
+                a[i * k + j] = u[j * rows + i] * (toRight ? 1. : s[j] * scale);
+        for (size_t j = 0; j < k; ++j)
+            for (size_t i = 0; i < cols; ++i)
+                b[j * cols + i] = std::conj(v[j * cols + i]) * (toRight ? s[j] * scale : 1.);
+
+        sites[p] = std::move(a);
+        sites[p + 1] = std::move(b);
+        bonds[p + 1] = k;
+        center = toRight ? p + 1 : p;
+    }
+
+    // moves the canonical center to site q, the sites it passes become isometries
+    void MoveCenter(size_t q)
+    {
+        while (center < q) {
+            // the two sites as one, then split with the singular values on the right
+            const size_t p = center;
+            Tensor pair = Merge(p);
+            Split(pair, p, bonds[p] * 2, 2 * bonds[p + 2], 0, true);
+        }
+        while (center > q) {
+            const size_t p = center - 1;
+            Tensor pair = Merge(p);
+            Split(pair, p, bonds[p] * 2, 2 * bonds[p + 2], 0, false);
+        }
+    }
+
+    // the sites p and p + 1 contracted, rows (l, sa) and columns (sb, r)
+    Tensor Merge(size_t p) const
+    {
+        const size_t left = bonds[p];
+        const size_t middle = bonds[p + 1];
+        const size_t right = bonds[p + 2];
+        Tensor pair(left * 4 * right, 0.);
+        for (size_t row = 0; row < left * 2; ++row)
+            for (size_t m = 0; m < middle; ++m) {
+                const Complex am = sites[p][row * middle + m];
+                if (am == 0.)
+                    continue;
+                for (size_t col = 0; col < 2 * right; ++col)
+                    pair[row * 2 * right + col] += am * sites[p + 1][m * 2 * right + col];
+            }
+
+        return pair;
+    }
+
+    /**
+     * @brief The singular value decomposition a = u diag(s) v^dagger, one sided Jacobi.
+     * @details a is row major, rows x cols. u and v are stored by columns, k = min(rows, cols)
+     * of them, the singular values are in decreasing order.
+     */
+    static void Svd(const Tensor& a, size_t rows, size_t cols, Tensor& u, std::vector<double>& s,
+                    Tensor& v)
+    {
+        // the columns of w are orthogonalized, w is a or a^dagger so that it's tall
+        const bool tall = rows >= cols;
+        const size_t m = tall ? rows : cols;
+        const size_t n = tall ? cols : rows;
+
+        Tensor w(m * n);
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j) {
+                if (tall)
+                    w[j * m + i] = a[i * cols + j];
+                else
+                    w[i * m + j] = std::conj(a[i * cols + j]);
+            }
+
+        Tensor rot(n * n, 0.);
+        for (size_t j = 0; j < n; ++j)
+            rot[j * n + j] = 1.;
+
+        const double eps = 1e-15;
+        for (int sweep = 0; sweep < 60; ++sweep) {
+            bool rotated = false;
+            for (size_t p = 0; p + 1 < n; ++p)
+                for (size_t q = p + 1; q < n; ++q) {
+                    Complex* wp = &w[p * m];
+                    Complex* wq = &w[q * m];
+                    double alpha = 0;
+                    double beta = 0;
+                    Complex gamma = 0;
+                    for (size_t i = 0; i < m; ++i) {
+                        alpha += std::norm(wp[i]);
+                        beta += std::norm(wq[i]);
+                        gamma += std::conj(wp[i]) * wq[i];
+                    }
+
+                    const double g = std::abs(gamma);
+                    if (g <= eps * std::sqrt(alpha * beta) || g == 0)
+                        continue;
+                    rotated = true;
+
+                    const double zeta = (beta - alpha) / (2 * g);
+                    const double t =
+                        (zeta >= 0 ? 1. : -1.) / (std::abs(zeta) + std::sqrt(1 + zeta * zeta));
+                    const double c = 1. / std::sqrt(1 + t * t);
+                    const double sn = c * t;
+                    const Complex phase = std::conj(gamma) / g;
+
+                    const auto rotate = [&](Complex* x, Complex* y, size_t size) {
+                        for (size_t i = 0; i < size; ++i) {
+                            const Complex xi = x[i];
+                            const Complex yi = y[i] * phase;
+                            x[i] = c * xi - sn * yi;
+                            y[i] = sn * xi + c * yi;
+                        }
+                    };
+                    rotate(wp, wq, m);
+                    rotate(&rot[p * n], &rot[q * n], n);
+                }
+            if (!rotated)
+                break;
+        }
+
+        std::vector<double> norms(n);
+        for (size_t j = 0; j < n; ++j) {
+            double sum = 0;
+            for (size_t i = 0; i < m; ++i)
+                sum += std::norm(w[j * m + i]);
+            norms[j] = std::sqrt(sum);
+        }
+
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(),
+                  [&norms](size_t x, size_t y) { return norms[x] > norms[y]; });
+
+        // w = left diag(s) rot^dagger, with left the normalized columns of w
+        Tensor left(m * n, 0.);
+        Tensor right(n * n);
+        s.resize(n);
+        for (size_t j = 0; j < n; ++j) {
+            const size_t from = order[j];
+            s[j] = norms[from];
+            if (s[j] > 0)
+                for (size_t i = 0; i < m; ++i)
+                    left[j * m + i] = w[from * m + i] / s[j];
+            std::copy(std::next(rot.begin(), Offset(from * n)),
+                      std::next(rot.begin(), Offset((from + 1) * n)),
+                      std::next(right.begin(), Offset(j * n)));
+        }
+
+        // for a^dagger = left diag(s) right^dagger, a = right diag(s) left^dagger
+        u = tall ? std::move(left) : std::move(right);
+        v = tall ? std::move(right) : std::move(left);
+    }
+
+    size_t maxBond = 0;
+    std::vector<size_t> bonds; // bonds[q] is on the left of site q
+    std::vector<Tensor> sites;
+    size_t center = 0; // the sites on the left of it are left isometries, on the right right ones
+};
@@ -0,0 +1,79 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file MemoryUsage.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The memory of the process, for the idle policy of the device.
+ *
+ * The resident size is read from /proc on Linux, the free heap memory is
+ * handed back with malloc_trim on glibc. Elsewhere both do nothing.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+class MemoryUsage
+{
+public:
+    /**
+     * @brief The resident set size of the process in bytes, 0 if it's not known.
+     */
+    static size_t GetResidentBytes()
+    {
+#if defined(__linux__)
+        std::FILE* file = std::fopen("/proc/self/statm", "r");
+        if (file == nullptr)
+            return 0;
+
+        unsigned long long int total = 0;
+        unsigned long long int resident = 0;
+        const int read = std::fscanf(file, "%llu %llu", &total, &resident);
+        std::fclose(file);
+
+        if (read != 2)
+            return 0;
+
+        return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Returns the free heap memory to the operating system.
+     */
+    static void Trim()
+    {
+#if defined(__GLIBC__)
+        malloc_trim(0);
+#endif
+    }
+};
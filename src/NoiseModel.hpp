@@ -0,0 +1,166 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file NoiseModel.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The noise model of a job.
+ *
+ * Set with the job options, for example
+ * "depolarizing=0.001; depolarizing.cx=0.01; amplitude_damping=0.0005; readout_error=0.02".
+ * A key without a gate name applies to all the gates, the ones with a gate name
+ * (as in qelib1.inc) override it for that gate, no matter the order they are given in.
+ * The noisy jobs are executed by TrajectorySimulator.hpp.
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "Circuit.hpp"
+
+class NoiseModel
+{
+public:
+    static constexpr size_t NrGateTypes = static_cast<size_t>(GateType::Barrier) + 1;
+
+    NoiseModel()
+    {
+        depolarizingGate.fill(Unset);
+        dampingGate.fill(Unset);
+    }
+
+    /**
+     * @brief Sets a noise parameter, returns false if the key is not a noise parameter
+     * or the value is not a probability.
+     */
+    bool Set(const std::string& key, const std::string& value)
+    {
+        const size_t dot = key.find('.');
+        const std::string channel = key.substr(0, dot);
+
+        double probability = 0;
+        if (!ParseProbability(value, probability))
+            return false;
+
+        if (channel == "readout_error" && dot == std::string::npos) {
+            readoutError = probability;
+            return true;
+        }
+
+        double* all = nullptr;
+        std::array<double, NrGateTypes>* gates = nullptr;
+        if (channel == "depolarizing") {
+            all = &depolarizing;
+            gates = &depolarizingGate;
+        } else if (channel == "amplitude_damping") {
+            all = &damping;
+            gates = &dampingGate;
+        } else
+            return false;
+
+        if (dot == std::string::npos) {
+            *all = probability;
+            return true;
+        }
+
+        const std::string gate = key.substr(dot + 1);
+        for (size_t type = 0; type <= static_cast<size_t>(GateType::CSwap); ++type)
+            if (gate == GateName(static_cast<GateType>(type))) {
+                (*gates)[type] = probability;
+                return true;
+            }
+
+        return false;
+    }
+
+    static bool IsNoiseKey(const std::string& key)
+    {
+        const std::string channel = key.substr(0, key.find('.'));
+
+        return channel == "depolarizing" || channel == "amplitude_damping" ||
+               channel == "readout_error";
+    }
+
+    bool IsNoiseless() const
+    {
+        if (readoutError != 0)
+            return false;
+
+        for (size_t type = 0; type < NrGateTypes; ++type)
+            if (GetDepolarizing(static_cast<GateType>(type)) != 0 ||
+                GetAmplitudeDamping(static_cast<GateType>(type)) != 0)
+                return false;
+
+        return true;
+    }
+
+    bool HasAmplitudeDamping() const
+    {
+        for (size_t type = 0; type < NrGateTypes; ++type)
+            if (GetAmplitudeDamping(static_cast<GateType>(type)) != 0)
+                return true;
+
+        return false;
+    }
+
+    // probability of a random non identity Pauli on the qubits of the gate after it
+    double GetDepolarizing(GateType type) const
+    {
+        return Get(depolarizing, depolarizingGate, type);
+    }
+
+    // decay probability of each qubit of the gate after it
+    double GetAmplitudeDamping(GateType type) const { return Get(damping, dampingGate, type); }
+
+    // probability of a measured bit being flipped
+    double GetReadoutError() const { return readoutError; }
+
+private:
+    static constexpr double Unset = -1;
+
+    static double Get(double all, const std::array<double, NrGateTypes>& gates, GateType type)
+    {
+        // measurements, resets and barriers get only the readout error
+        if (type > GateType::CSwap)
+            return 0;
+
+        const double gate = gates[static_cast<size_t>(type)];
+
+        return gate == Unset ? all : gate;
+    }
+
+    static bool ParseProbability(const std::string& value, double& probability)
+    {
+        char* end = nullptr;
+        probability = std::strtod(value.c_str(), &end);
+
+        return !value.empty() && *end == 0 && probability >= 0 && probability <= 1;
+    }
+
+    double depolarizing = 0;
+    double damping = 0;
+    double readoutError = 0;
+    std::array<double, NrGateTypes> depolarizingGate;
+    std::array<double, NrGateTypes> dampingGate;
+};
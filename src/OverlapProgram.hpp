@@ -0,0 +1,113 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file OverlapProgram.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The overlap of the states prepared by two circuits.
+ *
+ * The program is two OpenQASM programs one after the other, the second one
+ * starting with its own `OPENQASM` line. Both start from |0...0>, the fidelity
+ * |<psi1|psi2>|^2 = |<0|U1^dagger U2|0>|^2 is the probability of the all zero
+ * outcome after running the second circuit followed by the inverse of the first
+ * one, so a single simulator is enough and no state leaves it.
+ *
+ * The circuits must be unitary: measurements at the end and barriers are
+ * dropped, resets, conditions and gates after measurements are rejected.
+ * A circuit with fewer qubits leaves the remaining ones in |0>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <thread>
+
+#include "Circuit.hpp"
+#include "QasmParser.hpp"
+
+class OverlapProgram
+{
+public:
+    /**
+     * @brief Builds the circuit whose all zero probability is the fidelity of the two programs.
+     */
+    static bool Build(const std::string& text, Circuit& circuit)
+    {
+        circuit = Circuit();
+
+        const size_t second = FindSecondProgram(text);
+        if (second == std::string::npos)
+            return false;
+
+        Circuit first;
+        Circuit other;
+        QasmParser parser;
+        parser.SetThreads(std::thread::hardware_concurrency());
+        if (!parser.Parse(text.substr(0, second), first) ||
+            !parser.Parse(text.substr(second), other) || first.IsDynamic() || other.IsDynamic())
+            return false;
+
+        circuit.nrQubits = std::max(first.nrQubits, other.nrQubits);
+        if (circuit.nrQubits == 0)
+            return false;
+
+        for (const auto& op : other.operations)
+            if (IsGate(op))
+                circuit.operations.push_back(op);
+
+        for (auto it = first.operations.rbegin(); it != first.operations.rend(); ++it)
+            if (IsGate(*it))
+                circuit.operations.push_back(InvertGate(*it));
+
+        return true;
+    }
+
+private:
+    static bool IsGate(const Operation& op)
+    {
+        return op.type != GateType::Measure && op.type != GateType::Barrier;
+    }
+
+    // the start of the line with the second OPENQASM header, npos unless there are exactly two
+    static size_t FindSecondProgram(const std::string& text)
+    {
+        size_t found = std::string::npos;
+        size_t headers = 0;
+
+        size_t lineStart = 0;
+        while (lineStart < text.length()) {
+            size_t pos = lineStart;
+            while (pos < text.length() && (text[pos] == ' ' || text[pos] == '\t'))
+                ++pos;
+
+            if (text.compare(pos, 8, "OPENQASM") == 0 && ++headers == 2)
+                found = lineStart;
+
+            lineStart = text.find('\n', pos);
+            if (lineStart == std::string::npos)
+                break;
+            ++lineStart;
+        }
+
+        return headers == 2 ? found : std::string::npos;
+    }
+};
@@ -0,0 +1,510 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+/**
+ * @file PauliPropagator.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Expectation values by Pauli propagation in the Heisenberg picture.
+ *
+ * The observable O = sum_j c_j P_j is moved back through the circuit,
+ * O <- G^dagger O G for the gates from the last one to the first, and its
+ * expectation value in |0...0> is the sum of the coefficients of the strings
+ * with only I and Z factors. A Clifford gate maps a string to a single one,
+ * the other gates split it into up to 3 (one qubit) or 15 (two qubits), so
+ * shallow circuits stay cheap far beyond the qubit counts of a statevector.
+ * The gate API of the library has no observables, the propagation runs here.
+ *
+ * Two truncations keep the number of strings in check, both are applied to
+ * the strings a gate produces:
+ * - max weight: strings with more non identity factors are dropped (0 - no limit)
+ * - threshold: strings with a smaller absolute coefficient are dropped
+ * A dropped c P would add c <psi|P|psi> with |<psi|P|psi>| <= 1, so the sum of
+ * the dropped |c| bounds the error of the expectation value.
+ *
+ * The observable is a sum of terms without spaces, each an optional real
+ * coefficient followed by `*` and a Pauli string, either dense (character i
+ * acts on qubit i) or sparse (the non identity factors with their qubits):
+ *
+ *     Z0Z1+0.5*X3-1e-2*Y0Y7
+ *     ZZII-0.25*IXXI
+ *
+ * A number alone is a multiple of the identity.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cctype>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Circuit.hpp"
+#include "Simulator.hpp"
+#include "Transpiler.hpp"
+
+class PauliPropagator
+{
+public:
+    using Complex = std::complex<double>;
+
+    // the number of gates applied between the checks of stop
+    static constexpr size_t StopCheckGates = 16;
+
+    // coefficients and transfer matrix entries smaller than this are rounding errors
+    static constexpr double Zero = 1e-12;
+
+    explicit PauliPropagator(size_t maxPauliWeight = 0, double coefficientThreshold = 0)
+        : maxWeight(maxPauliWeight), threshold(coefficientThreshold)
+    {
+    }
+
+    /**
+     * @brief Parses the observable on the given number of qubits.
+     * @details Nothing is changed if the text is not valid or acts on other qubits.
+     */
+    bool SetObservable(const std::string& text, size_t qubits)
+    {
+        std::vector<std::pair<double, Factors>> parsed;
+        if (qubits == 0 || !Parse(text, qubits, parsed))
+            return false;
+
+        nrQubits = qubits;
+        words = (qubits + 63) / 64;
+        terms.clear();
+        truncationError = 0;
+
+        for (const auto& [coefficient, factors] : parsed) {
+            Key key(2 * words, 0);
+            for (const auto& [q, pauli] : factors)
+                SetPauli(key, q, pauli);
+            terms[key] += coefficient;
+        }
+
+        return true;
+    }
+
+    size_t GetNrQubits() const { return nrQubits; }
+
+    // the number of Pauli strings of the observable
+    size_t GetNrTerms() const { return terms.size(); }
+
+    // the sum of the dropped |c|, it bounds the error of GetExpectation
+    double GetTruncationError() const { return truncationError; }
+
+    /**
+     * @brief Moves the observable back through the circuit, GetExpectation is then its
+     * expectation value in the state the circuit prepares from |0...0>.
+     * @details stop is checked every StopCheckGates gates. Failed if the circuit is dynamic
+     * or has more qubits than the observable.
+     */
+    SimulationResult Run(const Circuit& circuit, const std::function<bool()>& stop = {})
+    {
+        if (circuit.IsDynamic() || circuit.nrQubits > nrQubits)
+            return SimulationResult::Failed;
+
+        Circuit gates = circuit;
+        gates.operations.clear();
+        for (const auto& op : circuit.operations)
+            if (op.type != GateType::Measure && op.type != GateType::Barrier)
+                gates.operations.push_back(op);
+
+        const Circuit lowered = Transpiler::Transpile(gates, TranspileTarget::PauliPropagation);
+
+        size_t applied = 0;
+        for (auto it = lowered.operations.rbegin(); it != lowered.operations.rend(); ++it) {
+            if (++applied % StopCheckGates == 0 && stop && stop())
+                return SimulationResult::Stopped;
+            if (!Apply(*it))
+                return SimulationResult::Failed;
+        }
+
+        return SimulationResult::Done;
+    }
+
+    /**
+     * @brief Conjugates the observable with a gate, O <- G^dagger O G, and truncates the
+     * strings it produces.
+     * @details Measurements and barriers are ignored, false for three qubit gates.
+     */
+    bool Apply(const Operation& op)
+    {
+        if (op.type == GateType::Measure || op.type == GateType::Barrier)
+            return true;
+
+        const size_t nrGateQubits = GateQubits(op.type);
+        if (nrGateQubits > 2 || (nrGateQubits == 2 && op.qubits[0] == op.qubits[1]))
+            return false;
+        for (size_t q = 0; q < nrGateQubits; ++q)
+            if (op.qubits[q] >= nrQubits)
+                return false;
+
+        const Transfer& transfer = GetTransfer(op);
+
+        produced.clear();
+        for (auto it = terms.begin(); it != terms.end();) {
+            const size_t a = GetLocal(it->first, op);
+            const auto& row = transfer[a];
+            if (row.size() == 1 && row.front().first == a && row.front().second == 1.) {
+                ++it;
+                continue;
+            }
+
+            for (const auto& [b, value] : row) {
+                Key key = it->first;
+                SetLocal(key, op, b);
+                produced.emplace_back(std::move(key), it->second * value);
+            }
+            it = terms.erase(it);
+        }
+
+        for (const auto& [key, coefficient] : produced)
+            terms[key] += coefficient;
+
+        for (const auto& term : produced) {
+            const auto it = terms.find(term.first);
+            if (it == terms.end())
+                continue;
+
+            const double magnitude = std::abs(it->second);
+            if (magnitude < Zero || magnitude < threshold ||
+                (maxWeight != 0 && GetWeight(it->first) > maxWeight)) {
+                truncationError += magnitude;
+                terms.erase(it);
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief The expectation value of the observable in |0...0>.
+     */
+    double GetExpectation() const
+    {
+        double expectation = 0;
+        for (const auto& [key, coefficient] : terms)
+            if (std::all_of(key.begin(), std::next(key.begin(), static_cast<std::ptrdiff_t>(words)),
+                            [](uint64_t w) { return w == 0; }))
+                expectation += coefficient;
+
+        return expectation;
+    }
+
+private:
+    // the x bits of the qubits followed by their z bits, Y has both
+    using Key = std::vector<uint64_t>;
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            uint64_t hash = 0;
+            for (const uint64_t w : key)
+                hash ^= w + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    // the non identity factors of a string, 1 - X, 2 - Y, 3 - Z
+    using Factors = std::vector<std::pair<uint32_t, int>>;
+
+    // row a has the expansion of G^dagger P_a G in the strings P_b on the qubits of the gate,
+    // the first qubit of the operation is the high one
+    using Transfer = std::vector<std::vector<std::pair<size_t, double>>>;
+
+    // the transfer depends only on the gate, not on its qubits
+    using TransferKey = std::pair<GateType, std::array<double, 4>>;
+
+    static int ToPauli(char c)
+    {
+        switch (c) {
+        case 'I':
+            return 0;
+        case 'X':
+            return 1;
+        case 'Y':
+            return 2;
+        case 'Z':
+            return 3;
+        default:
+            return -1;
+        }
+    }
+
+    static bool IsDigit(char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; }
+
+    static bool Parse(const std::string& text, size_t qubits,
+                      std::vector<std::pair<double, Factors>>& parsed)
+    {
+        size_t pos = 0;
+        while (pos < text.length()) {
+            double sign = 1;
+            if (text[pos] == '+' || text[pos] == '-') {
+                sign = text[pos] == '-' ? -1 : 1;
+                ++pos;
+            }
+
+            double coefficient = 1;
+            if (pos < text.length() && (IsDigit(text[pos]) || text[pos] == '.')) {
+                char* end = nullptr;
+                coefficient = std::strtod(text.c_str() + pos, &end);
+                pos = static_cast<size_t>(end - text.c_str());
+                if (!std::isfinite(coefficient))
+                    return false;
+
+                if (pos == text.length() || text[pos] == '+' || text[pos] == '-') {
+                    parsed.emplace_back(sign * coefficient, Factors());
+                    continue;
+                }
+                if (text[pos] != '*')
+                    return false;
+                ++pos;
+            }
+
+            const size_t start = pos;
+            while (pos < text.length() && text[pos] != '+' && text[pos] != '-')
+                ++pos;
+
+            Factors factors;
+            if (!ParseString(text.substr(start, pos - start), qubits, factors))
+                return false;
+            parsed.emplace_back(sign * coefficient, std::move(factors));
+        }
+
+        return !parsed.empty();
+    }
+
+    static bool ParseString(const std::string& text, size_t qubits, Factors& factors)
+    {
+        if (text.empty())
+            return false;
+
+        if (std::none_of(text.begin(), text.end(), IsDigit)) {
+            if (text.length() > qubits)
+                return false;
+            for (size_t q = 0; q < text.length(); ++q) {
+                const int pauli = ToPauli(text[q]);
+                if (pauli < 0)
+                    return false;
+                if (pauli != 0)
+                    factors.emplace_back(static_cast<uint32_t>(q), pauli);
+            }
+
+            return true;
+        }
+
+        size_t pos = 0;
+        while (pos < text.length()) {
+            const int pauli = ToPauli(text[pos++]);
+
+            const size_t start = pos;
+            size_t q = 0;
+            while (pos < text.length() && IsDigit(text[pos]) && q < qubits)
+                q = q * 10 + static_cast<size_t>(text[pos++] - '0');
+
+            if (pauli < 0 || pos == start || q >= qubits ||
+                std::any_of(factors.begin(), factors.end(),
+                            [q](const auto& factor) { return factor.first == q; }))
+                return false;
+            if (pauli != 0)
+                factors.emplace_back(static_cast<uint32_t>(q), pauli);
+        }
+
+        return true;
+    }
+
+    int GetPauli(const Key& key, size_t q) const
+    {
+        const bool x = (key[q / 64] >> (q % 64)) & 1;
+        const bool z = (key[words + q / 64] >> (q % 64)) & 1;
+
+        return x ? (z ? 2 : 1) : (z ? 3 : 0);
+    }
+
+    void SetPauli(Key& key, size_t q, int pauli) const
+    {
+        const uint64_t bit = uint64_t(1) << (q % 64);
+        uint64_t& x = key[q / 64];
+        uint64_t& z = key[words + q / 64];
+
+        x = pauli == 1 || pauli == 2 ? x | bit : x & ~bit;
+        z = pauli == 2 || pauli == 3 ? z | bit : z & ~bit;
+    }
+
+    size_t GetLocal(const Key& key, const Operation& op) const
+    {
+        if (GateQubits(op.type) == 1)
+            return static_cast<size_t>(GetPauli(key, op.qubits[0]));
+
+        return static_cast<size_t>(4 * GetPauli(key, op.qubits[0]) + GetPauli(key, op.qubits[1]));
+    }
+
+    void SetLocal(Key& key, const Operation& op, size_t local) const
+    {
+        if (GateQubits(op.type) == 1) {
+            SetPauli(key, op.qubits[0], static_cast<int>(local));
+            return;
+        }
+
+        SetPauli(key, op.qubits[0], static_cast<int>(local >> 2));
+        SetPauli(key, op.qubits[1], static_cast<int>(local & 3));
+    }
+
+    size_t GetWeight(const Key& key) const
+    {
+        size_t weight = 0;
+        for (size_t w = 0; w < words; ++w)
+            weight += std::bitset<64>(key[w] | key[words + w]).count();
+
+        return weight;
+    }
+
+    // the row major matrix of a one or two qubit gate, the first qubit is the high bit
+    static std::vector<Complex> GetUnitary(const Operation& op)
+    {
+        Transpiler::Matrix m;
+        if (GateQubits(op.type) == 1) {
+            Transpiler::GetMatrix(op, m);
+            return {m[0][0], m[0][1], m[1][0], m[1][1]};
+        }
+
+        std::vector<Complex> u(16, 0.);
+        if (op.type == GateType::Swap) {
+            u[0] = u[6] = u[9] = u[15] = 1.;
+            return u;
+        }
+
+        Operation target = op;
+        target.type = GetControlledGate(op.type);
+        Transpiler::GetMatrix(target, m);
+
+        u[0] = u[5] = 1.;
+        for (size_t out = 0; out < 2; ++out)
+            for (size_t in = 0; in < 2; ++in)
+                u[(2 + out) * 4 + 2 + in] = m[out][in];
+
+        return u;
+    }
+
+    // the row major matrix of the string with index pauli on nrGateQubits qubits
+    static std::vector<Complex> GetPauliMatrix(size_t pauli, size_t nrGateQubits)
+    {
+        using namespace std::complex_literals;
+        static const Complex sigma[4][2][2] = {{{1., 0.}, {0., 1.}},
+                                               {{0., 1.}, {1., 0.}},
+                                               {{0., -1i}, {1i, 0.}},
+                                               {{1., 0.}, {0., -1.}}};
+
+        const size_t dim = size_t(1) << nrGateQubits;
+        std::vector<Complex> matrix(dim * dim, 1.);
+        for (size_t r = 0; r < dim; ++r)
+            for (size_t c = 0; c < dim; ++c)
+                for (size_t j = 0; j < nrGateQubits; ++j) {
+                    const size_t shift = nrGateQubits - 1 - j;
+                    matrix[r * dim + c] *=
+                        sigma[(pauli >> (2 * shift)) & 3][(r >> shift) & 1][(c >> shift) & 1];
+                }
+
+        return matrix;
+    }
+
+    // computed once for each distinct gate, the repeated ones are looked up
+    const Transfer& GetTransfer(const Operation& op)
+    {
+        const TransferKey key{op.type, {op.params[0], op.params[1], op.params[2], op.params[3]}};
+        auto it = transfers.find(key);
+        if (it == transfers.end())
+            it = transfers.emplace(key, ComputeTransfer(op)).first;
+
+        return it->second;
+    }
+
+    // the entries are Tr(P_b G^dagger P_a G) / dim, real for Hermitian strings
+    static Transfer ComputeTransfer(const Operation& op)
+    {
+        const size_t nrGateQubits = GateQubits(op.type);
+        const size_t dim = size_t(1) << nrGateQubits;
+        const size_t nrPaulis = dim * dim;
+
+        const std::vector<Complex> u = GetUnitary(op);
+        std::vector<std::vector<Complex>> paulis(nrPaulis);
+        for (size_t p = 0; p < nrPaulis; ++p)
+            paulis[p] = GetPauliMatrix(p, nrGateQubits);
+
+        Transfer transfer(nrPaulis);
+        std::vector<Complex> pu(dim * dim);
+        std::vector<Complex> conjugated(dim * dim);
+        for (size_t a = 0; a < nrPaulis; ++a) {
+            for (size_t r = 0; r < dim; ++r)
+                for (size_t c = 0; c < dim; ++c) {
+                    Complex sum = 0;
+                    for (size_t i = 0; i < dim; ++i)
+                        sum += paulis[a][r * dim + i] * u[i * dim + c];
+                    pu[r * dim + c] = sum;
+                }
+            for (size_t r = 0; r < dim; ++r)
+                for (size_t c = 0; c < dim; ++c) {
+                    Complex sum = 0;
+                    for (size_t i = 0; i < dim; ++i)
+                        sum += std::conj(u[i * dim + r]) * pu[i * dim + c];
+                    conjugated[r * dim + c] = sum;
+                }
+
+            for (size_t b = 0; b < nrPaulis; ++b) {
+                double value = 0;
+                for (size_t r = 0; r < dim; ++r)
+                    for (size_t c = 0; c < dim; ++c)
+                        value += (paulis[b][r * dim + c] * conjugated[c * dim + r]).real();
+                value /= static_cast<double>(dim);
+
+                // exact for the Cliffords, so their strings are recognized as unchanged
+                if (std::abs(std::abs(value) - 1.) < Zero)
+                    value = value > 0 ? 1. : -1.;
+                if (std::abs(value) >= Zero)
+                    transfer[a].emplace_back(b, value);
+            }
+        }
+
+        return transfer;
+    }
+
+    size_t maxWeight = 0;
+    double threshold = 0;
+    size_t nrQubits = 0;
+    size_t words = 0;
+    double truncationError = 0;
+    std::unordered_map<Key, double, KeyHash> terms;
+    std::vector<std::pair<Key, double>> produced;
+    std::map<TransferKey, Transfer> transfers;
+};
@@ -0,0 +1,221 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file ProgramCache.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Interning of the submitted programs.
+ *
+ * Jobs with byte identical programs share a single reference counted copy,
+ * no matter which session they belong to. The program is parsed and
+ * transpiled at most once, the results are kept along with the text.
+ * Two jobs have the same program exactly when they point to the same
+ * interned program.
+ *
+ * Besides OpenQASM, programs can be generators that are expanded on the
+ * device, see TrotterGenerator.hpp, or pairs of programs whose overlap is
+ * computed, see OverlapProgram.hpp. The format is part of the identity of
+ * an interned program.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "OverlapProgram.hpp"
+#include "QasmParser.hpp"
+#include "Transpiler.hpp"
+#include "TrotterGenerator.hpp"
+
+enum class ProgramFormat
+{
+    Qasm,    // OpenQASM 2.0 or 3
+    Trotter, // Trotterized time evolution, see TrotterGenerator.hpp
+    Overlap  // two OpenQASM programs, the circuit is the overlap one, see OverlapProgram.hpp
+};
+
+class InternedProgram
+{
+public:
+    InternedProgram(std::string program, size_t programHash,
+                    ProgramFormat programFormat = ProgramFormat::Qasm)
+        : text(std::move(program)), hash(programHash), format(programFormat)
+    {
+    }
+
+    const std::string& GetText() const { return text; }
+
+    size_t GetHash() const { return hash; }
+
+    ProgramFormat GetFormat() const { return format; }
+
+    /**
+     * @brief Returns the parsed program, nullptr if the front end cannot handle it.
+     */
+    const Circuit* GetCircuit() const
+    {
+        std::lock_guard lock(mutex);
+
+        return ParseCircuit();
+    }
+
+    /**
+     * @brief Returns the program rewritten for the gate set of the target.
+     * @details Programs the front end cannot handle are returned unchanged.
+     * The library executes only OpenQASM 2.0, translate forces other programs
+     * through the front end even if there is nothing to rewrite for the target.
+     * Generators are always expanded.
+     */
+    const std::string& GetTranspiled(TranspileTarget target, bool translate = false) const
+    {
+        if (target == TranspileTarget::None && !translate && format == ProgramFormat::Qasm)
+            return text;
+
+        std::lock_guard lock(mutex);
+
+        auto& program = transpiled[static_cast<size_t>(target)];
+        if (!program) {
+            const Circuit* source = ParseCircuit();
+            if (source)
+                program = std::make_unique<std::string>(
+                    Transpiler::Transpile(*source, target).ToQasm());
+            else if (format == ProgramFormat::Qasm)
+                program = std::make_unique<std::string>(text);
+            else // a generator that cannot be expanded has nothing to run
+                program = std::make_unique<std::string>();
+        }
+
+        return *program;
+    }
+
+private:
+    const Circuit* ParseCircuit() const
+    {
+        if (!parseDone) {
+            if (format == ProgramFormat::Trotter) {
+                TrotterGenerator generator;
+                parsed = generator.Generate(text, circuit);
+            } else if (format == ProgramFormat::Overlap) {
+                parsed = OverlapProgram::Build(text, circuit);
+            } else {
+                QasmParser parser;
+                parser.SetThreads(std::thread::hardware_concurrency());
+                parsed = parser.Parse(text, circuit);
+            }
+            parseDone = true;
+        }
+
+        return parsed ? &circuit : nullptr;
+    }
+
+    const std::string text;
+    const size_t hash;
+    const ProgramFormat format;
+
+    // filled in lazily, the first job that needs them does the work
+    mutable std::mutex mutex;
+    mutable bool parseDone = false;
+    mutable bool parsed = false;
+    mutable Circuit circuit;
+    // one for each TranspileTarget
+    mutable std::array<std::unique_ptr<std::string>,
+                       static_cast<size_t>(TranspileTarget::PauliPropagation) + 1>
+        transpiled;
+};
+
+class ProgramCache
+{
+public:
+    /**
+     * @brief Returns the interned copy of the program, adding it if it's not there yet.
+     * @details The entry goes away when the last job holding the program is freed.
+     */
+    std::shared_ptr<const InternedProgram> Intern(std::string_view program,
+                                                  ProgramFormat format = ProgramFormat::Qasm)
+    {
+        const size_t hash = std::hash<std::string_view>{}(program);
+
+        std::lock_guard lock(mutex);
+
+        const auto range = programs.equal_range(hash);
+        for (auto it = range.first; it != range.second;) {
+            auto interned = it->second.lock();
+            if (!interned) {
+                it = programs.erase(it);
+                continue;
+            }
+            if (interned->GetFormat() == format && interned->GetText() == program)
+                return interned;
+            ++it;
+        }
+
+        auto interned = std::make_shared<const InternedProgram>(std::string(program), hash, format);
+        programs.emplace(hash, interned);
+
+        // the entries of freed programs are dropped lazily
+        if (programs.size() >= sweepSize)
+            Sweep();
+
+        return interned;
+    }
+
+    size_t Size()
+    {
+        std::lock_guard lock(mutex);
+        Sweep();
+
+        return programs.size();
+    }
+
+    /**
+     * @brief Drops the entries of the freed programs and shrinks the table to its contents.
+     */
+    void Compact()
+    {
+        std::lock_guard lock(mutex);
+        Sweep();
+        programs.rehash(0);
+    }
+
+private:
+    void Sweep()
+    {
+        for (auto it = programs.begin(); it != programs.end();) {
+            if (it->second.expired())
+                it = programs.erase(it);
+            else
+                ++it;
+        }
+
+        sweepSize = std::max<size_t>(64, 2 * programs.size());
+    }
+
+    std::mutex mutex;
+    std::unordered_multimap<size_t, std::weak_ptr<const InternedProgram>> programs;
+    size_t sweepSize = 64;
+};
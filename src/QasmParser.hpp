@@ -0,0 +1,1573 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file QasmParser.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The OpenQASM front end of the device.
+ *
+ * Translates a program into the internal gate stream. The qelib1.inc gates are
+ * built in, user defined gates are expanded, opaque gates are not supported.
+ *
+ * The common subset of OpenQASM 3 is handled as well: qubit and bit
+ * declarations, the stdgates.inc gates, compile time classical variables,
+ * for loops, measurement assignments and if/else statements. Loops and
+ * conditions on classical variables are resolved while compiling, conditions
+ * on measured bits end up on the operations of the gate stream.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Circuit.hpp"
+
+/**
+ * @brief Runs function(0), ..., function(count - 1) on separate threads.
+ */
+template <class Function>
+void QasmRunInParallel(size_t count, const Function& function)
+{
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < count; ++i)
+        workers.emplace_back([&function, i] { function(i); });
+
+    function(0);
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+enum class QasmTokenType : uint8_t
+{
+    Identifier,
+    Number,
+    String,
+    Symbol,
+    End
+};
+
+// the token text points into the program, which has to outlive the tokens
+struct QasmToken
+{
+    std::string_view text;
+    double value = 0;
+    uint32_t line = 0;
+    QasmTokenType type = QasmTokenType::End;
+};
+
+class QasmLexer
+{
+public:
+    // programs smaller than this are not worth splitting between threads
+    static constexpr size_t ParallelMinSize = 1 << 20;
+
+    /**
+     * @brief Splits the program into tokens.
+     * @details Large programs are split at line ends into chunks that are
+     * tokenized in parallel, unless they contain block comments or strings
+     * past the first chunk, which could span the chunk boundaries.
+     */
+    static std::vector<QasmToken> Tokenize(const std::string& program, size_t threads = 1)
+    {
+        std::vector<QasmToken> tokens;
+
+        const char* begin = program.c_str();
+        const char* end = begin + program.length();
+
+        std::vector<const char*> bounds = {begin};
+        if (threads > 1 && program.length() >= ParallelMinSize &&
+            program.find("/*") == std::string::npos) {
+            for (size_t k = 1; k < threads; ++k) {
+                const char* split = std::max(bounds.back(), begin + program.length() / threads * k);
+                const void* eol = std::memchr(split, '\n', static_cast<size_t>(end - split));
+                if (eol == nullptr)
+                    break;
+                bounds.push_back(static_cast<const char*>(eol) + 1);
+            }
+            if (bounds.size() > 1 &&
+                std::memchr(bounds[1], '"', static_cast<size_t>(end - bounds[1])) != nullptr)
+                bounds.resize(1);
+        }
+        bounds.push_back(end);
+
+        if (bounds.size() == 2) {
+            tokens.reserve(program.length() / 2);
+            const uint32_t line = Scan(begin, end, 1, tokens);
+            tokens.push_back({{}, 0, line, QasmTokenType::End});
+            return tokens;
+        }
+
+        const size_t chunks = bounds.size() - 1;
+        std::vector<std::vector<QasmToken>> parts(chunks);
+        std::vector<uint32_t> lines(chunks, 0);
+        std::vector<bool> failed(chunks, false);
+
+        QasmRunInParallel(chunks, [&](size_t c) {
+            try {
+                parts[c].reserve(static_cast<size_t>(bounds[c + 1] - bounds[c]) / 2);
+                lines[c] = Scan(bounds[c], bounds[c + 1], 0, parts[c]);
+            } catch (const std::exception&) {
+                failed[c] = true;
+            }
+        });
+
+        // the line numbers in the chunks are relative, redo it to report the right line
+        if (std::find(failed.begin(), failed.end(), true) != failed.end())
+            return Tokenize(program);
+
+        std::vector<size_t> offsets(chunks, 0);
+        size_t total = 0;
+        uint32_t line = 1;
+        for (size_t c = 0; c < chunks; ++c) {
+            offsets[c] = total;
+            total += parts[c].size();
+            lines[c] = std::exchange(line, line + lines[c]);
+        }
+
+        tokens.reserve(total + 1);
+        tokens.resize(total);
+        QasmRunInParallel(chunks, [&](size_t c) {
+            QasmToken* out = tokens.data() + offsets[c];
+            for (const auto& token : parts[c]) {
+                *out = token;
+                out->line += lines[c];
+                ++out;
+            }
+        });
+        tokens.push_back({{}, 0, line, QasmTokenType::End});
+
+        return tokens;
+    }
+
+private:
+    enum class CharClass : uint8_t
+    {
+        Symbol,
+        Space,
+        Newline,
+        Letter,
+        Digit
+    };
+
+    static const std::array<CharClass, 256>& CharClasses()
+    {
+        static const std::array<CharClass, 256> classes = [] {
+            std::array<CharClass, 256> table{};
+            for (size_t i = 0; i < table.size(); ++i) {
+                const char c = static_cast<char>(i);
+                if (c == '\n')
+                    table[i] = CharClass::Newline;
+                else if (c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f')
+                    table[i] = CharClass::Space;
+                else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+                    table[i] = CharClass::Letter;
+                else if (c >= '0' && c <= '9')
+                    table[i] = CharClass::Digit;
+                else
+                    table[i] = CharClass::Symbol;
+            }
+            return table;
+        }();
+
+        return classes;
+    }
+
+    static CharClass Classify(char c) { return CharClasses()[static_cast<unsigned char>(c)]; }
+
+    static void Add(std::vector<QasmToken>& tokens, QasmTokenType type, const char* begin,
+                    const char* end, uint32_t line, double value = 0)
+    {
+        const auto length = static_cast<size_t>(end - begin);
+        tokens.push_back({std::string_view(begin, length), value, line, type});
+    }
+
+    // tokenizes [begin, end), returns the line number at the end
+    static uint32_t Scan(const char* begin, const char* end, uint32_t line,
+                         std::vector<QasmToken>& tokens)
+    {
+        const char* p = begin;
+
+        while (p < end) {
+            const char c = *p;
+
+            switch (Classify(c)) {
+            case CharClass::Newline:
+                ++line;
+                ++p;
+                break;
+            case CharClass::Space:
+                ++p;
+                break;
+            case CharClass::Letter: {
+                const char* start = p++;
+                while (p < end && (Classify(*p) == CharClass::Letter ||
+                                   Classify(*p) == CharClass::Digit))
+                    ++p;
+                Add(tokens, QasmTokenType::Identifier, start, p, line);
+            } break;
+            case CharClass::Digit:
+                p = ScanNumber(p, end, line, tokens);
+                break;
+            default:
+                if (c == '/' && p + 1 < end && p[1] == '/') {
+                    // the newline is left for the line count
+                    const void* eol = std::memchr(p, '\n', static_cast<size_t>(end - p));
+                    p = eol ? static_cast<const char*>(eol) : end;
+                } else if (c == '/' && p + 1 < end && p[1] == '*') {
+                    const char* close = p + 2;
+                    for (;;) {
+                        const void* star =
+                            std::memchr(close, '*', static_cast<size_t>(end - close));
+                        if (star == nullptr || static_cast<const char*>(star) + 1 >= end) {
+                            close = end;
+                            break;
+                        }
+                        close = static_cast<const char*>(star) + 1;
+                        if (*close == '/') {
+                            ++close;
+                            break;
+                        }
+                    }
+                    line += static_cast<uint32_t>(std::count(p, close, '\n'));
+                    p = close;
+                } else if (c == '.' && p + 1 < end && Classify(p[1]) == CharClass::Digit) {
+                    p = ScanNumber(p, end, line, tokens);
+                } else if (c == '"') {
+                    const char* start = ++p;
+                    const void* quote = std::memchr(p, '"', static_cast<size_t>(end - p));
+                    p = quote ? static_cast<const char*>(quote) : end;
+                    Add(tokens, QasmTokenType::String, start, p, line);
+                    if (p < end)
+                        ++p;
+                } else if (p + 1 < end && IsTwoCharSymbol(c, p[1])) {
+                    Add(tokens, QasmTokenType::Symbol, p, p + 2, line);
+                    p += 2;
+                } else {
+                    Add(tokens, QasmTokenType::Symbol, p, p + 1, line);
+                    ++p;
+                }
+                break;
+            }
+        }
+
+        return line;
+    }
+
+    static const char* ScanNumber(const char* p, const char* end, uint32_t line,
+                                  std::vector<QasmToken>& tokens)
+    {
+        double value = 0;
+        const char* stop = ScanDecimal(p, end, value);
+        if (stop == nullptr) {
+            // the program text is null terminated, so strtod stops at its end at the latest
+            char* strtodStop = nullptr;
+            value = std::strtod(p, &strtodStop);
+            if (strtodStop == p)
+                throw std::runtime_error("invalid number at line " + std::to_string(line));
+            stop = strtodStop;
+        }
+
+        Add(tokens, QasmTokenType::Number, p, stop, line, value);
+
+        return stop;
+    }
+
+    /**
+     * @brief Converts the common decimal numbers without strtod.
+     * @details Up to 15 significant digits and a decimal exponent of at most 22 both
+     * the digits and the power of ten are exact doubles, so a single multiplication
+     * or division gives the correctly rounded value. Returns nullptr otherwise.
+     */
+    static const char* ScanDecimal(const char* p, const char* end, double& value)
+    {
+        static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+
+        const char* q = p;
+        for (; q < end && Classify(*q) == CharClass::Digit; ++q) {
+            if (mantissa == 0 && *q == '0')
+                continue;
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+            ++digits;
+        }
+        if (q < end && *q == '.') {
+            for (++q; q < end && Classify(*q) == CharClass::Digit; ++q) {
+                --exponent;
+                if (mantissa == 0 && *q == '0')
+                    continue;
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+                ++digits;
+            }
+        }
+        if (q == p || (q == p + 1 && *p == '.'))
+            return nullptr;
+
+        if (q < end && (*q == 'e' || *q == 'E')) {
+            const char* e = q + 1;
+            bool negative = false;
+            if (e < end && (*e == '+' || *e == '-'))
+                negative = *e++ == '-';
+            if (e >= end || Classify(*e) != CharClass::Digit)
+                return nullptr;
+            int power = 0;
+            for (; e < end && Classify(*e) == CharClass::Digit; ++e)
+                if (power < 1000)
+                    power = power * 10 + (*e - '0');
+            exponent += negative ? -power : power;
+            q = e;
+        }
+
+        if (digits > 15 || exponent > 22 || exponent < -22)
+            return nullptr;
+
+        value = static_cast<double>(mantissa);
+        if (exponent >= 0)
+            value *= powers[exponent];
+        else
+            value /= powers[-exponent];
+
+        return q;
+    }
+
+    static bool IsTwoCharSymbol(char first, char second)
+    {
+        if (second == '=')
+            return first == '=' || first == '!' || first == '<' || first == '>' ||
+                   first == '+' || first == '-' || first == '*' || first == '/';
+
+        return (first == '-' && second == '>') || (first == '&' && second == '&') ||
+               (first == '|' && second == '|');
+    }
+};
+
+class QasmParser
+{
+public:
+    /**
+     * @brief Parses an OpenQASM 2.0 or 3 program.
+     * @return true on success, otherwise the error can be retrieved with GetError().
+     */
+    bool Parse(const std::string& program, Circuit& circuit)
+    {
+        error.clear();
+        qregs.clear();
+        gates.clear();
+        variables.clear();
+        circuit = Circuit();
+        out = &circuit;
+
+        bool success = true;
+        try {
+            tokens = QasmLexer::Tokenize(program, threads);
+            tokenData = tokens.data();
+            pos = 0;
+
+            ParseStatements();
+
+            std::vector<ClassicalRegister> registers;
+            if (!circuit.GetOutputRegisters(registers))
+                throw std::runtime_error("conditions on overlapping parts of a register");
+        } catch (const std::exception& ex) {
+            error = ex.what();
+            success = false;
+        }
+
+        // the tokens point into the program text
+        tokens.clear();
+        tokens.shrink_to_fit();
+        tokenData = nullptr;
+
+        return success;
+    }
+
+    const std::string& GetError() const { return error; }
+
+    /**
+     * @brief Sets how many threads can be used for large programs.
+     */
+    void SetThreads(size_t nrThreads) { threads = std::max<size_t>(1, nrThreads); }
+
+private:
+    struct QuantumRegister
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    struct GateDefinition
+    {
+        std::vector<std::string> params;
+        std::vector<std::string> args;
+        size_t bodyBegin = 0;
+        size_t bodyEnd = 0;
+    };
+
+    // the scope of a user defined gate body being expanded
+    struct Scope
+    {
+        std::unordered_map<std::string, double> params;
+        std::unordered_map<std::string, uint32_t> args;
+    };
+
+    // classical variables are known at compile time
+    struct Variable
+    {
+        std::string type; // int, uint, float, angle or bool
+        double value = 0;
+        bool constant = false;
+    };
+
+    // programs with fewer tokens are parsed on a single thread
+    static constexpr size_t ParallelMinTokens = 1 << 16;
+
+    void ParseStatements()
+    {
+        size_t start = 0;
+        if (threads > 1 && tokens.size() >= ParallelMinTokens && FindParallelStart(start)) {
+            while (pos < start)
+                ParseStatement(Operation());
+            ParseInParallel(start);
+            return;
+        }
+
+        while (Peek().type != QasmTokenType::End)
+            ParseStatement(Operation());
+    }
+
+    /**
+     * @brief Finds where the statements that can be parsed in parallel start.
+     * @details Those are the gates, measurements, resets and barriers after the last
+     * declaration or assignment. Programs with blocks outside gate definitions are not
+     * split, a block can change the meaning of the statements in it.
+     */
+    bool FindParallelStart(size_t& start) const
+    {
+        start = 0;
+        bool simple = true;
+        bool first = true;
+
+        for (size_t i = 0; i + 1 < tokens.size(); ++i) {
+            const QasmToken& token = tokens[i];
+
+            if (token.type == QasmTokenType::Identifier) {
+                const Keyword keyword = GetKeyword(token.text);
+                if (first && keyword == Keyword::Gate) {
+                    while (i + 1 < tokens.size() &&
+                           !(tokens[i].type == QasmTokenType::Symbol && tokens[i].text == "}"))
+                        ++i;
+                    start = i + 1;
+                    continue;
+                }
+                if (keyword == Keyword::For || keyword == Keyword::Else ||
+                    keyword == Keyword::Unsupported)
+                    return false;
+                if (keyword != Keyword::None && keyword != Keyword::If)
+                    simple = false;
+            } else if (token.type == QasmTokenType::Symbol) {
+                if (token.text == "{" || token.text == "}")
+                    return false;
+                if (token.text == ";") {
+                    if (!simple)
+                        start = i + 1;
+                    simple = true;
+                    first = true;
+                    continue;
+                } else if (IsAssignment(token))
+                    simple = false;
+            }
+            first = false;
+        }
+
+        return true;
+    }
+
+    void ParseInParallel(size_t start)
+    {
+        const size_t end = tokens.size() - 1;
+
+        // the chunks end at statement ends
+        std::vector<size_t> bounds = {start};
+        for (size_t k = 1; k < threads; ++k) {
+            size_t split = std::max(bounds.back(), start + (end - start) / threads * k);
+            while (split < end &&
+                   !(tokens[split].type == QasmTokenType::Symbol && tokens[split].text == ";"))
+                ++split;
+            if (split >= end)
+                break;
+            bounds.push_back(split + 1);
+        }
+        bounds.push_back(end);
+
+        const size_t chunks = bounds.size() - 1;
+        std::vector<Circuit> parts(chunks);
+        std::vector<std::string> errors(chunks);
+
+        QasmRunInParallel(chunks, [&](size_t c) {
+            // the declarations are all known by now, each chunk gets a copy
+            QasmParser chunk;
+            chunk.qregs = qregs;
+            chunk.gates = gates;
+            chunk.variables = variables;
+            chunk.tokenData = tokenData;
+            chunk.pos = bounds[c];
+
+            parts[c].nrQubits = out->nrQubits;
+            parts[c].nrCbits = out->nrCbits;
+            parts[c].cregs = out->cregs;
+            chunk.out = &parts[c];
+
+            try {
+                while (chunk.pos < bounds[c + 1])
+                    chunk.ParseStatement(Operation());
+            } catch (const std::exception& ex) {
+                errors[c] = ex.what();
+            }
+        });
+
+        for (const auto& err : errors)
+            if (!err.empty())
+                throw std::runtime_error(err);
+
+        size_t total = out->operations.size();
+        for (const auto& part : parts)
+            total += part.operations.size();
+        out->operations.reserve(total);
+
+        for (const auto& part : parts)
+            out->operations.insert(out->operations.end(), part.operations.begin(),
+                                   part.operations.end());
+        pos = end;
+    }
+
+    const QasmToken& Peek() const { return tokenData[pos]; }
+
+    const QasmToken& Next()
+    {
+        const QasmToken& token = tokenData[pos];
+        if (token.type != QasmTokenType::End)
+            ++pos;
+
+        return token;
+    }
+
+    [[noreturn]] void Fail(const std::string& message) const
+    {
+        throw std::runtime_error(message + " at line " + std::to_string(Peek().line));
+    }
+
+    bool IsSymbol(const char* symbol) const
+    {
+        return Peek().type == QasmTokenType::Symbol && Peek().text == symbol;
+    }
+
+    bool Accept(const char* symbol)
+    {
+        if (!IsSymbol(symbol))
+            return false;
+        Next();
+
+        return true;
+    }
+
+    void Expect(const char* symbol)
+    {
+        if (!Accept(symbol))
+            Fail(std::string("expected '") + symbol + "'");
+    }
+
+    bool AcceptKeyword(const char* keyword)
+    {
+        if (Peek().type != QasmTokenType::Identifier || Peek().text != keyword)
+            return false;
+        Next();
+
+        return true;
+    }
+
+    std::string ExpectIdentifier()
+    {
+        if (Peek().type != QasmTokenType::Identifier)
+            Fail("expected an identifier");
+
+        return std::string(Next().text);
+    }
+
+    // indices, sizes and condition values, integer expressions in OpenQASM 3
+    uint64_t ParseInteger(const Scope* scope)
+    {
+        const double value = ParseExpression(scope);
+        if (value < 0 || std::floor(value) != value ||
+            value >= static_cast<double>(std::numeric_limits<uint32_t>::max()))
+            Fail("expected a non negative integer");
+
+        return static_cast<uint64_t>(value);
+    }
+
+    enum class Keyword : uint8_t
+    {
+        None,
+        OpenQasm,
+        Include,
+        QReg,
+        CReg,
+        Qubit,
+        Bit,
+        Const,
+        ClassicalType,
+        Gate,
+        Opaque,
+        If,
+        For,
+        Else,
+        Modifier,
+        Unsupported
+    };
+
+    static Keyword GetKeyword(std::string_view name)
+    {
+        static const std::unordered_map<std::string_view, Keyword> keywords = {
+            {"OPENQASM", Keyword::OpenQasm},
+            {"include", Keyword::Include},
+            {"qreg", Keyword::QReg},
+            {"creg", Keyword::CReg},
+            {"qubit", Keyword::Qubit},
+            {"bit", Keyword::Bit},
+            {"const", Keyword::Const},
+            {"int", Keyword::ClassicalType},
+            {"uint", Keyword::ClassicalType},
+            {"float", Keyword::ClassicalType},
+            {"angle", Keyword::ClassicalType},
+            {"bool", Keyword::ClassicalType},
+            {"gate", Keyword::Gate},
+            {"opaque", Keyword::Opaque},
+            {"if", Keyword::If},
+            {"for", Keyword::For},
+            {"else", Keyword::Else},
+            {"ctrl", Keyword::Modifier},
+            {"negctrl", Keyword::Modifier},
+            {"inv", Keyword::Modifier},
+            {"pow", Keyword::Modifier},
+            {"input", Keyword::Unsupported},
+            {"output", Keyword::Unsupported},
+            {"while", Keyword::Unsupported},
+            {"def", Keyword::Unsupported},
+            {"let", Keyword::Unsupported},
+            {"extern", Keyword::Unsupported},
+            {"switch", Keyword::Unsupported}};
+
+        const auto it = keywords.find(name);
+
+        return it == keywords.end() ? Keyword::None : it->second;
+    }
+
+    void ParseStatement(const Operation& condition)
+    {
+        const QasmToken& token = Peek();
+        if (token.type == QasmTokenType::Symbol && token.text == "{") {
+            ParseBranch(condition);
+            return;
+        }
+        if (token.type != QasmTokenType::Identifier)
+            Fail("unexpected '" + std::string(token.text) + "'");
+
+        const std::string_view keyword = token.text;
+
+        switch (GetKeyword(keyword)) {
+        case Keyword::OpenQasm:
+            Next();
+            if (Peek().type != QasmTokenType::Number || Peek().value < 2 || Next().value >= 4)
+                Fail("only OpenQASM 2.0 and 3 are supported");
+            Expect(";");
+            break;
+        case Keyword::Include:
+            Next();
+            if (Peek().type != QasmTokenType::String ||
+                (Peek().text != "qelib1.inc" && Peek().text != "stdgates.inc"))
+                Fail("only qelib1.inc and stdgates.inc can be included");
+            Next();
+            Expect(";");
+            break;
+        case Keyword::QReg:
+        case Keyword::CReg: {
+            const bool quantum = keyword == "qreg";
+            Next();
+            const std::string name = ExpectIdentifier();
+            Expect("[");
+            const auto size = static_cast<uint32_t>(ParseInteger(nullptr));
+            Expect("]");
+            Expect(";");
+            DeclareRegister(name, size, quantum);
+        } break;
+        case Keyword::Qubit:
+        case Keyword::Bit: {
+            const bool quantum = keyword == "qubit";
+            Next();
+            uint32_t size = 1;
+            if (Accept("[")) {
+                size = static_cast<uint32_t>(ParseInteger(nullptr));
+                Expect("]");
+            }
+            const std::string name = ExpectIdentifier();
+            DeclareRegister(name, size, quantum);
+            if (!quantum && Accept("=")) {
+                const ClassicalRegister* creg = FindCreg(name);
+                std::vector<uint32_t> cbits(creg->size);
+                for (uint32_t i = 0; i < creg->size; ++i)
+                    cbits[i] = creg->offset + i;
+                ParseMeasureAssignment(condition, cbits);
+            } else
+                Expect(";");
+        } break;
+        case Keyword::Const:
+        case Keyword::ClassicalType: {
+            const bool constant = keyword == "const";
+            Next();
+            const std::string type = constant ? ExpectIdentifier() : std::string(keyword);
+            ParseVariableDeclaration(type, constant, condition);
+        } break;
+        case Keyword::Gate:
+            Next();
+            ParseGateDefinition();
+            break;
+        case Keyword::Opaque:
+            Fail("opaque gates are not supported");
+        case Keyword::If:
+            Next();
+            ParseIf(condition);
+            break;
+        case Keyword::For:
+            Next();
+            ParseFor(condition);
+            break;
+        case Keyword::Else:
+            Fail("else without if");
+        case Keyword::Modifier:
+            Fail("gate modifiers are not supported");
+        case Keyword::Unsupported:
+            Fail(std::string(keyword) + " is not supported");
+        default:
+            if (FindCreg(keyword)) {
+                // c = measure q; or c[i] = measure q[j];
+                const auto cbits = ParseClassicalArgument();
+                Expect("=");
+                ParseMeasureAssignment(condition, cbits);
+            } else if (!variables.empty() && variables.count(std::string(keyword)) &&
+                       IsAssignment(tokenData[pos + 1]))
+                ParseAssignment(condition);
+            else
+                ParseQuantumOperation(condition);
+            break;
+        }
+    }
+
+    void DeclareRegister(const std::string& name, uint32_t size, bool quantum)
+    {
+        if (qregs.count(name) || FindCreg(name) || variables.count(name))
+            Fail("register " + name + " redeclared");
+
+        if (quantum) {
+            qregs[name] = {static_cast<uint32_t>(out->nrQubits), size};
+            out->nrQubits += size;
+        } else {
+            out->cregs.push_back({name, static_cast<uint32_t>(out->nrCbits), size});
+            out->nrCbits += size;
+        }
+    }
+
+    static bool IsAssignment(const QasmToken& token)
+    {
+        return token.type == QasmTokenType::Symbol &&
+               (token.text == "=" || token.text == "+=" || token.text == "-=" ||
+                token.text == "*=" || token.text == "/=");
+    }
+
+    static bool IsClassicalType(std::string_view name)
+    {
+        return name == "int" || name == "uint" || name == "float" || name == "angle" ||
+               name == "bool";
+    }
+
+    static double Convert(const std::string& type, double value)
+    {
+        if (type == "bool")
+            return value != 0 ? 1 : 0;
+        if (type == "int" || type == "uint")
+            return std::trunc(value);
+
+        return value;
+    }
+
+    void ParseVariableDeclaration(const std::string& type, bool constant,
+                                  const Operation& condition)
+    {
+        if (!IsClassicalType(type))
+            Fail("unsupported type " + type);
+        if (condition.IsConditional())
+            Fail("classical variables cannot depend on measurements");
+
+        if (Accept("[")) {
+            ParseInteger(nullptr);
+            Expect("]");
+        }
+        const std::string name = ExpectIdentifier();
+        if (qregs.count(name) || FindCreg(name))
+            Fail(name + " redeclared");
+
+        double value = 0;
+        if (Accept("="))
+            value = ParseCondition(nullptr);
+        else if (constant)
+            Fail("constant " + name + " needs a value");
+        Expect(";");
+
+        // a declaration in a loop body is seen once per iteration
+        variables[name] = {type, Convert(type, value), constant};
+    }
+
+    void ParseAssignment(const Operation& condition)
+    {
+        const std::string name = ExpectIdentifier();
+        Variable& variable = variables[name];
+        if (variable.constant)
+            Fail("cannot assign to " + name);
+        if (condition.IsConditional())
+            Fail("classical variables cannot depend on measurements");
+
+        double value = variable.value;
+        if (Accept("="))
+            value = ParseCondition(nullptr);
+        else if (Accept("+="))
+            value += ParseExpression(nullptr);
+        else if (Accept("-="))
+            value -= ParseExpression(nullptr);
+        else if (Accept("*="))
+            value *= ParseExpression(nullptr);
+        else if (Accept("/="))
+            value /= ParseExpression(nullptr);
+        else
+            Fail("expected an assignment");
+        Expect(";");
+
+        variable.value = Convert(variable.type, value);
+    }
+
+    void ParseMeasureAssignment(const Operation& condition, const std::vector<uint32_t>& cbits)
+    {
+        if (!AcceptKeyword("measure"))
+            Fail("expected a measurement");
+
+        const auto qubits = ParseArgument(nullptr);
+        Expect(";");
+        EmitMeasurements(condition, qubits, cbits);
+    }
+
+    void EmitMeasurements(const Operation& condition, const std::vector<uint32_t>& qubits,
+                          const std::vector<uint32_t>& cbits)
+    {
+        if (qubits.size() != cbits.size())
+            Fail("measure register sizes differ");
+
+        for (size_t i = 0; i < qubits.size(); ++i) {
+            Operation op = condition;
+            op.type = GateType::Measure;
+            op.qubits[0] = qubits[i];
+            op.cbit = cbits[i];
+            out->operations.push_back(op);
+        }
+    }
+
+    // a statement or a block of statements
+    void ParseBranch(const Operation& condition)
+    {
+        if (!Accept("{")) {
+            ParseStatement(condition);
+            return;
+        }
+
+        while (!Accept("}")) {
+            if (Peek().type == QasmTokenType::End)
+                Fail("unterminated block");
+            ParseStatement(condition);
+        }
+    }
+
+    // moves past a statement or block without compiling it, used for the branches not taken
+    void SkipBranch()
+    {
+        if (IsSymbol("{")) {
+            SkipBalanced("{", "}");
+        } else if (AcceptKeyword("if")) {
+            SkipBalanced("(", ")");
+            SkipBranch();
+            if (AcceptKeyword("else"))
+                SkipBranch();
+        } else if (AcceptKeyword("for")) {
+            while (!AcceptKeyword("in")) {
+                if (Peek().type == QasmTokenType::End)
+                    Fail("unterminated for loop");
+                Next();
+            }
+            if (IsSymbol("["))
+                SkipBalanced("[", "]");
+            else
+                SkipBalanced("{", "}");
+            SkipBranch();
+        } else {
+            while (!Accept(";")) {
+                if (Peek().type == QasmTokenType::End)
+                    Fail("expected ';'");
+                Next();
+            }
+        }
+    }
+
+    void SkipBalanced(const char* open, const char* close)
+    {
+        Expect(open);
+        for (size_t depth = 1; depth != 0; Next()) {
+            if (Peek().type == QasmTokenType::End)
+                Fail(std::string("expected '") + close + "'");
+            if (IsSymbol(open))
+                ++depth;
+            else if (IsSymbol(close))
+                --depth;
+        }
+    }
+
+    bool IsMeasurementCondition() const
+    {
+        size_t p = pos;
+        if (tokenData[p].type == QasmTokenType::Symbol && tokenData[p].text == "!")
+            ++p;
+
+        return tokenData[p].type == QasmTokenType::Identifier && FindCreg(tokenData[p].text);
+    }
+
+    void ParseIf(const Operation& condition)
+    {
+        Expect("(");
+
+        if (!IsMeasurementCondition()) {
+            // resolved at compile time
+            const bool taken = ParseCondition(nullptr) != 0;
+            Expect(")");
+            if (taken)
+                ParseBranch(condition);
+            else
+                SkipBranch();
+            if (AcceptKeyword("else")) {
+                if (taken)
+                    SkipBranch();
+                else
+                    ParseBranch(condition);
+            }
+            return;
+        }
+
+        if (condition.IsConditional())
+            Fail("nested conditions on measurements are not supported");
+
+        const bool negated = Accept("!");
+        const ClassicalRegister* creg = FindCreg(ExpectIdentifier());
+
+        Operation branch;
+        branch.condOffset = creg->offset;
+        branch.condSize = creg->size;
+        if (Accept("[")) {
+            const uint64_t index = ParseInteger(nullptr);
+            Expect("]");
+            if (index >= creg->size)
+                Fail("bit index out of range");
+            branch.condOffset += static_cast<uint32_t>(index);
+            branch.condSize = 1;
+        }
+
+        bool equal = !negated;
+        if (!negated && Accept("=="))
+            branch.condValue = ParseInteger(nullptr);
+        else if (!negated && Accept("!=")) {
+            branch.condValue = ParseInteger(nullptr);
+            equal = false;
+        } else if (branch.condSize == 1)
+            branch.condValue = 1;
+        else
+            Fail("a register can only be compared with a value");
+        Expect(")");
+
+        if (branch.condSize == 1 && branch.condValue > 1)
+            Fail("a bit can only be compared with 0 or 1");
+        if (!equal) {
+            if (branch.condSize != 1)
+                Fail("only single bits can be compared with !=");
+            branch.condValue ^= 1;
+        }
+
+        ParseBranch(branch);
+
+        if (AcceptKeyword("else")) {
+            if (branch.condSize != 1)
+                Fail("else is only supported for conditions on single bits");
+            branch.condValue ^= 1;
+            ParseBranch(branch);
+        }
+    }
+
+    // the loop is compiled into the gate stream, the body once per iteration
+    void ParseFor(const Operation& condition)
+    {
+        std::string name = ExpectIdentifier();
+        if (Accept("[")) {
+            ParseInteger(nullptr);
+            Expect("]");
+        }
+        if (Peek().type != QasmTokenType::Identifier || Peek().text != "in")
+            name = ExpectIdentifier(); // the first identifier was the type
+        if (!AcceptKeyword("in"))
+            Fail("expected 'in'");
+
+        std::vector<double> values;
+        if (Accept("[")) {
+            // ranges include their end
+            const double start = ParseExpression(nullptr);
+            Expect(":");
+            double step = 1;
+            double stop = ParseExpression(nullptr);
+            if (Accept(":")) {
+                step = stop;
+                stop = ParseExpression(nullptr);
+            }
+            Expect("]");
+            if (step == 0)
+                Fail("the range step cannot be zero");
+
+            const double count = std::floor((stop - start) / step) + 1;
+            for (double i = 0; i < count; ++i)
+                values.push_back(start + i * step);
+        } else {
+            Expect("{");
+            do
+                values.push_back(ParseExpression(nullptr));
+            while (Accept(","));
+            Expect("}");
+        }
+
+        const size_t bodyBegin = pos;
+        SkipBranch();
+        const size_t bodyEnd = pos;
+
+        const auto it = variables.find(name);
+        const bool shadows = it != variables.end();
+        const Variable saved = shadows ? it->second : Variable();
+
+        for (const double value : values) {
+            variables[name] = {"float", value, true};
+            pos = bodyBegin;
+            ParseBranch(condition);
+        }
+
+        pos = bodyEnd;
+        if (shadows)
+            variables[name] = saved;
+        else
+            variables.erase(name);
+    }
+
+    void ParseGateDefinition()
+    {
+        const std::string name = ExpectIdentifier();
+        GateDefinition def;
+
+        if (Accept("(")) {
+            if (!IsSymbol(")")) {
+                do
+                    def.params.push_back(ExpectIdentifier());
+                while (Accept(","));
+            }
+            Expect(")");
+        }
+        do
+            def.args.push_back(ExpectIdentifier());
+        while (Accept(","));
+
+        Expect("{");
+        def.bodyBegin = pos;
+        while (!IsSymbol("}")) {
+            if (Peek().type == QasmTokenType::End)
+                Fail("unterminated gate definition");
+            Next();
+        }
+        def.bodyEnd = pos;
+        Next();
+
+        gates[name] = std::move(def);
+    }
+
+    // qop: measure, reset, barrier or a gate application, optionally in a gate body
+    void ParseQuantumOperation(const Operation& condition, const Scope* scope = nullptr,
+                               size_t depth = 0)
+    {
+        const std::string name = ExpectIdentifier();
+
+        if (name == "measure" && !scope) {
+            const auto qubits = ParseArgument(nullptr);
+            Expect("->");
+            const auto cbits = ParseClassicalArgument();
+            Expect(";");
+            EmitMeasurements(condition, qubits, cbits);
+            return;
+        }
+
+        if (name == "reset" && !scope) {
+            const auto qubits = ParseArgument(nullptr);
+            Expect(";");
+            for (const auto qubit : qubits) {
+                Operation op = condition;
+                op.type = GateType::Reset;
+                op.qubits[0] = qubit;
+                out->operations.push_back(op);
+            }
+            return;
+        }
+
+        std::vector<double> params;
+        if (name != "barrier" && Accept("(")) {
+            if (!IsSymbol(")")) {
+                do
+                    params.push_back(ParseExpression(scope));
+                while (Accept(","));
+            }
+            Expect(")");
+        }
+
+        // the global phase is not observable without gate modifiers
+        if (name == "gphase") {
+            if (params.size() != 1)
+                Fail("wrong number of parameters for gphase");
+            Expect(";");
+            return;
+        }
+
+        std::vector<std::vector<uint32_t>> args;
+        if (name == "barrier" && !scope && IsSymbol(";")) {
+            // a barrier on all the qubits
+            std::vector<uint32_t> all(out->nrQubits);
+            for (uint32_t q = 0; q < all.size(); ++q)
+                all[q] = q;
+            args.push_back(std::move(all));
+        } else {
+            do
+                args.push_back(ParseArgument(scope));
+            while (Accept(","));
+        }
+        Expect(";");
+
+        if (name == "barrier") {
+            if (args[0].empty())
+                return;
+
+            uint32_t first = std::numeric_limits<uint32_t>::max();
+            uint32_t last = 0;
+            for (const auto& arg : args)
+                for (const auto qubit : arg) {
+                    first = std::min(first, qubit);
+                    last = std::max(last, qubit);
+                }
+            Operation op = condition;
+            op.type = GateType::Barrier;
+            op.qubits[0] = first;
+            op.qubits[1] = last;
+            out->operations.push_back(op);
+            return;
+        }
+
+        // broadcast over whole registers
+        size_t width = 1;
+        for (const auto& arg : args) {
+            if (arg.size() != 1 && width != 1 && arg.size() != width)
+                Fail("register sizes differ");
+            width = std::max(width, arg.size());
+        }
+
+        std::vector<uint32_t> qubits(args.size());
+        for (size_t i = 0; i < width; ++i) {
+            for (size_t a = 0; a < args.size(); ++a)
+                qubits[a] = args[a].size() == 1 ? args[a][0] : args[a][i];
+            ApplyGate(name, params, qubits, condition, depth);
+        }
+    }
+
+    std::vector<uint32_t> ParseArgument(const Scope* scope)
+    {
+        const std::string name = ExpectIdentifier();
+
+        if (scope) {
+            const auto it = scope->args.find(name);
+            if (it == scope->args.end())
+                Fail("unknown gate argument " + name);
+            return {it->second};
+        }
+
+        const auto it = qregs.find(name);
+        if (it == qregs.end())
+            Fail("unknown quantum register " + name);
+
+        if (Accept("[")) {
+            const uint64_t index = ParseInteger(nullptr);
+            Expect("]");
+            if (index >= it->second.size)
+                Fail("qubit index out of range");
+            return {it->second.offset + static_cast<uint32_t>(index)};
+        }
+
+        std::vector<uint32_t> qubits(it->second.size);
+        for (uint32_t i = 0; i < it->second.size; ++i)
+            qubits[i] = it->second.offset + i;
+
+        return qubits;
+    }
+
+    std::vector<uint32_t> ParseClassicalArgument()
+    {
+        const ClassicalRegister* creg = FindCreg(ExpectIdentifier());
+        if (!creg)
+            Fail("unknown classical register");
+
+        if (Accept("[")) {
+            const uint64_t index = ParseInteger(nullptr);
+            Expect("]");
+            if (index >= creg->size)
+                Fail("bit index out of range");
+            return {creg->offset + static_cast<uint32_t>(index)};
+        }
+
+        std::vector<uint32_t> cbits(creg->size);
+        for (uint32_t i = 0; i < creg->size; ++i)
+            cbits[i] = creg->offset + i;
+
+        return cbits;
+    }
+
+    const ClassicalRegister* FindCreg(std::string_view name) const
+    {
+        for (const auto& creg : out->cregs)
+            if (creg.name == name)
+                return &creg;
+
+        return nullptr;
+    }
+
+    // conditions, the comparisons and logical operators of OpenQASM 3
+    double ParseCondition(const Scope* scope)
+    {
+        double value = ParseConjunction(scope);
+        while (Accept("||")) {
+            const double other = ParseConjunction(scope);
+            value = value != 0 || other != 0 ? 1 : 0;
+        }
+
+        return value;
+    }
+
+    double ParseConjunction(const Scope* scope)
+    {
+        double value = ParseComparison(scope);
+        while (Accept("&&")) {
+            const double other = ParseComparison(scope);
+            value = value != 0 && other != 0 ? 1 : 0;
+        }
+
+        return value;
+    }
+
+    double ParseComparison(const Scope* scope)
+    {
+        const double value = ParseExpression(scope);
+
+        if (Accept("=="))
+            return value == ParseExpression(scope) ? 1 : 0;
+        if (Accept("!="))
+            return value != ParseExpression(scope) ? 1 : 0;
+        if (Accept("<="))
+            return value <= ParseExpression(scope) ? 1 : 0;
+        if (Accept(">="))
+            return value >= ParseExpression(scope) ? 1 : 0;
+        if (Accept("<"))
+            return value < ParseExpression(scope) ? 1 : 0;
+        if (Accept(">"))
+            return value > ParseExpression(scope) ? 1 : 0;
+
+        return value;
+    }
+
+    // expressions, with the usual precedence: +- < */% < ^ < unary minus
+    double ParseExpression(const Scope* scope)
+    {
+        double value = ParseTerm(scope);
+        for (;;) {
+            if (Accept("+"))
+                value += ParseTerm(scope);
+            else if (Accept("-"))
+                value -= ParseTerm(scope);
+            else
+                return value;
+        }
+    }
+
+    double ParseTerm(const Scope* scope)
+    {
+        double value = ParseFactor(scope);
+        for (;;) {
+            if (Accept("*"))
+                value *= ParseFactor(scope);
+            else if (Accept("/"))
+                value /= ParseFactor(scope);
+            else if (Accept("%"))
+                value = std::fmod(value, ParseFactor(scope));
+            else
+                return value;
+        }
+    }
+
+    double ParseFactor(const Scope* scope)
+    {
+        const double base = ParseUnary(scope);
+        if (Accept("^"))
+            return std::pow(base, ParseFactor(scope));
+
+        return base;
+    }
+
+    double ParseUnary(const Scope* scope)
+    {
+        if (Accept("-"))
+            return -ParseUnary(scope);
+        if (Accept("+"))
+            return ParseUnary(scope);
+        if (Accept("!"))
+            return ParseUnary(scope) == 0 ? 1 : 0;
+
+        if (Accept("(")) {
+            const double value = ParseExpression(scope);
+            Expect(")");
+            return value;
+        }
+
+        if (Peek().type == QasmTokenType::Number)
+            return Next().value;
+
+        const std::string name = ExpectIdentifier();
+        if (name == "pi")
+            return Pi;
+        if (name == "tau")
+            return 2 * Pi;
+        if (name == "euler")
+            return std::exp(1.);
+        if (name == "true" || name == "false")
+            return name == "true" ? 1 : 0;
+
+        if (scope) {
+            const auto it = scope->params.find(name);
+            if (it != scope->params.end())
+                return it->second;
+        }
+
+        const auto var = variables.find(name);
+        if (var != variables.end())
+            return var->second.value;
+
+        static const std::unordered_map<std::string, double (*)(double)> functions = {
+            {"sin", [](double x) { return std::sin(x); }},
+            {"cos", [](double x) { return std::cos(x); }},
+            {"tan", [](double x) { return std::tan(x); }},
+            {"exp", [](double x) { return std::exp(x); }},
+            {"ln", [](double x) { return std::log(x); }},
+            {"log", [](double x) { return std::log(x); }},
+            {"sqrt", [](double x) { return std::sqrt(x); }},
+            {"arcsin", [](double x) { return std::asin(x); }},
+            {"arccos", [](double x) { return std::acos(x); }},
+            {"arctan", [](double x) { return std::atan(x); }},
+            {"floor", [](double x) { return std::floor(x); }},
+            {"ceiling", [](double x) { return std::ceil(x); }}};
+
+        const auto it = functions.find(name);
+        if (it == functions.end())
+            Fail("unknown identifier " + name);
+
+        Expect("(");
+        const double value = ParseExpression(scope);
+        Expect(")");
+
+        return it->second(value);
+    }
+
+    void ApplyGate(const std::string& name, const std::vector<double>& params,
+                   const std::vector<uint32_t>& qubits, const Operation& condition, size_t depth)
+    {
+        if (EmitBuiltin(name, params, qubits, condition))
+            return;
+
+        const auto it = gates.find(name);
+        if (it == gates.end())
+            Fail("unknown gate " + name);
+
+        const GateDefinition& def = it->second;
+        if (def.params.size() != params.size() || def.args.size() != qubits.size())
+            Fail("wrong number of parameters or arguments for gate " + name);
+        if (depth > 64)
+            Fail("gate definitions nested too deep");
+
+        Scope scope;
+        for (size_t i = 0; i < params.size(); ++i)
+            scope.params[def.params[i]] = params[i];
+        for (size_t i = 0; i < qubits.size(); ++i)
+            scope.args[def.args[i]] = qubits[i];
+
+        const size_t savedPos = pos;
+        pos = def.bodyBegin;
+        while (pos < def.bodyEnd)
+            ParseQuantumOperation(condition, &scope, depth + 1);
+        pos = savedPos;
+    }
+
+    void Emit(const Operation& condition, GateType type, uint32_t q0, uint32_t q1 = 0,
+              uint32_t q2 = 0, double p0 = 0, double p1 = 0, double p2 = 0, double p3 = 0)
+    {
+        out->Add(type, q0, q1, q2, p0, p1, p2, p3);
+
+        Operation& op = out->operations.back();
+        op.condOffset = condition.condOffset;
+        op.condSize = condition.condSize;
+        op.condValue = condition.condValue;
+    }
+
+    bool EmitBuiltin(const std::string& name, const std::vector<double>& params,
+                     const std::vector<uint32_t>& qubits, const Operation& condition)
+    {
+        struct Builtin
+        {
+            GateType type;
+            size_t nrParams;
+            size_t nrQubits;
+        };
+
+        // the gates that map directly on a gate of the gate stream
+        static const std::unordered_map<std::string, Builtin> builtins = {
+            {"x", {GateType::X, 0, 1}},          {"y", {GateType::Y, 0, 1}},
+            {"z", {GateType::Z, 0, 1}},          {"h", {GateType::H, 0, 1}},
+            {"s", {GateType::S, 0, 1}},          {"sdg", {GateType::SDG, 0, 1}},
+            {"t", {GateType::T, 0, 1}},          {"tdg", {GateType::TDG, 0, 1}},
+            {"sx", {GateType::SX, 0, 1}},        {"sxdg", {GateType::SXDG, 0, 1}},
+            {"p", {GateType::P, 1, 1}},          {"u1", {GateType::P, 1, 1}},
+            {"phase", {GateType::P, 1, 1}},      {"cphase", {GateType::CP, 1, 2}},
+            {"rx", {GateType::Rx, 1, 1}},        {"ry", {GateType::Ry, 1, 1}},
+            {"rz", {GateType::Rz, 1, 1}},        {"u3", {GateType::U, 3, 1}},
+            {"u", {GateType::U, 3, 1}},          {"U", {GateType::U, 3, 1}},
+            {"cx", {GateType::CX, 0, 2}},        {"CX", {GateType::CX, 0, 2}},
+            {"cy", {GateType::CY, 0, 2}},        {"cz", {GateType::CZ, 0, 2}},
+            {"ch", {GateType::CH, 0, 2}},        {"csx", {GateType::CSX, 0, 2}},
+            {"cp", {GateType::CP, 1, 2}},        {"cu1", {GateType::CP, 1, 2}},
+            {"crx", {GateType::CRx, 1, 2}},      {"cry", {GateType::CRy, 1, 2}},
+            {"crz", {GateType::CRz, 1, 2}},      {"cu3", {GateType::CU, 3, 2}},
+            {"cu", {GateType::CU, 4, 2}},        {"swap", {GateType::Swap, 0, 2}},
+            {"ccx", {GateType::CCX, 0, 3}},      {"cswap", {GateType::CSwap, 0, 3}},
+            {"id", {GateType::Barrier, 0, 1}},   {"u0", {GateType::Barrier, 1, 1}},
+            {"u2", {GateType::U, 2, 1}},         {"rzz", {GateType::CX, 1, 2}},
+            {"rxx", {GateType::CX, 1, 2}},       {"ryy", {GateType::CX, 1, 2}}};
+
+        const auto it = builtins.find(name);
+        if (it == builtins.end() || gates.count(name))
+            return false;
+
+        const Builtin& builtin = it->second;
+        if (params.size() != builtin.nrParams || qubits.size() != builtin.nrQubits)
+            Fail("wrong number of parameters or arguments for gate " + name);
+        for (size_t i = 0; i < qubits.size(); ++i)
+            for (size_t j = 0; j < i; ++j)
+                if (qubits[i] == qubits[j])
+                    Fail("repeated qubit argument for gate " + name);
+
+        const uint32_t q0 = qubits[0];
+        const uint32_t q1 = qubits.size() > 1 ? qubits[1] : 0;
+        const uint32_t q2 = qubits.size() > 2 ? qubits[2] : 0;
+
+        if (name == "id" || name == "u0")
+            return true;
+        if (name == "u2") {
+            Emit(condition, GateType::U, q0, 0, 0, Pi / 2, params[0], params[1]);
+            return true;
+        }
+        if (name == "rzz") {
+            Emit(condition, GateType::CX, q0, q1);
+            Emit(condition, GateType::Rz, q1, 0, 0, params[0]);
+            Emit(condition, GateType::CX, q0, q1);
+            return true;
+        }
+        if (name == "rxx" || name == "ryy") {
+            const bool xx = name == "rxx";
+            for (const auto q : {q0, q1})
+                Emit(condition, xx ? GateType::H : GateType::Rx, q, 0, 0, Pi / 2);
+            Emit(condition, GateType::CX, q0, q1);
+            Emit(condition, GateType::Rz, q1, 0, 0, params[0]);
+            Emit(condition, GateType::CX, q0, q1);
+            for (const auto q : {q0, q1})
+                Emit(condition, xx ? GateType::H : GateType::Rx, q, 0, 0, -Pi / 2);
+            return true;
+        }
+
+        double p[4] = {0, 0, 0, 0};
+        for (size_t i = 0; i < params.size(); ++i)
+            p[i] = params[i];
+
+        Emit(condition, builtin.type, q0, q1, q2, p[0], p[1], p[2], p[3]);
+
+        return true;
+    }
+
+    std::vector<QasmToken> tokens;
+    const QasmToken* tokenData = nullptr; // shared with the parsers of the chunks
+    size_t pos = 0;
+    size_t threads = 1;
+
+    std::map<std::string, QuantumRegister> qregs;
+    std::unordered_map<std::string, GateDefinition> gates;
+    std::unordered_map<std::string, Variable> variables;
+
+    Circuit* out = nullptr;
+    std::string error;
+};
@@ -0,0 +1,196 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file ResultSpill.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The results of a job moved out of memory into a file.
+ *
+ * Finished jobs that are not accessed for a while have their results spilled,
+ * if a spill directory is configured, and read back when they are asked for.
+ * The file is in the native byte order, it is not meant to outlive the process.
+ */
+
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ResultSpill
+{
+public:
+    using Histogram = std::map<std::string, size_t>;
+    using Selection = std::vector<std::pair<std::string, size_t>>;
+    using Unitary = std::vector<std::complex<double>>;
+    using Records = std::vector<uint8_t>; // the byte results, see the CUSTOM5 job result
+
+    static bool Write(const std::string& path, const Histogram& results,
+                      const Selection& selected, const Unitary& unitary, const Records& records)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        bool success = WriteCounts(file, results.size(), results.begin(), results.end()) &&
+                       WriteCounts(file, selected.size(), selected.begin(), selected.end()) &&
+                       WriteValue(file, unitary.size()) &&
+                       std::fwrite(unitary.data(), sizeof(std::complex<double>), unitary.size(),
+                                   file) == unitary.size() &&
+                       WriteValue(file, records.size()) &&
+                       std::fwrite(records.data(), 1, records.size(), file) == records.size();
+        success = std::fclose(file) == 0 && success;
+
+        if (!success)
+            std::remove(path.c_str());
+
+        return success;
+    }
+
+    /**
+     * @brief Reads back the results, nothing is changed if the file cannot be read.
+     */
+    static bool Read(const std::string& path, Histogram& results, Selection& selected,
+                     Unitary& unitary, Records& records)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return false;
+
+        Histogram readResults;
+        Selection readSelected;
+        Unitary readUnitary;
+        Records readRecords;
+
+        uint64_t size = 0;
+        bool success = ReadValue(file, size);
+        for (uint64_t i = 0; success && i < size; ++i) {
+            std::pair<std::string, size_t> entry;
+            success = ReadCount(file, entry);
+            readResults.insert(std::move(entry));
+        }
+
+        success = success && ReadValue(file, size);
+        for (uint64_t i = 0; success && i < size; ++i) {
+            readSelected.emplace_back();
+            success = ReadCount(file, readSelected.back());
+        }
+
+        success = success && ReadValue(file, size);
+        if (success) {
+            readUnitary.resize(static_cast<size_t>(size));
+            success = std::fread(readUnitary.data(), sizeof(std::complex<double>),
+                                 readUnitary.size(), file) == readUnitary.size();
+        }
+
+        success = success && ReadValue(file, size);
+        if (success) {
+            readRecords.resize(static_cast<size_t>(size));
+            success = std::fread(readRecords.data(), 1, readRecords.size(), file) ==
+                      readRecords.size();
+        }
+        std::fclose(file);
+
+        if (!success)
+            return false;
+
+        results = std::move(readResults);
+        selected = std::move(readSelected);
+        unitary = std::move(readUnitary);
+        records = std::move(readRecords);
+
+        return true;
+    }
+
+    /**
+     * @brief The approximate heap memory taken by the results.
+     */
+    static size_t GetMemoryUsage(const Histogram& results, const Selection& selected,
+                                 const Unitary& unitary, const Records& records)
+    {
+        // a map node holds the pair and three pointers plus the color
+        constexpr size_t nodeOverhead = 4 * sizeof(void*);
+
+        size_t bytes = unitary.capacity() * sizeof(std::complex<double>) +
+                       selected.capacity() * sizeof(Selection::value_type) + records.capacity();
+        for (const auto& [key, count] : results)
+            bytes += sizeof(Histogram::value_type) + nodeOverhead + KeyBytes(key);
+        for (const auto& entry : selected)
+            bytes += KeyBytes(entry.first);
+
+        return bytes;
+    }
+
+private:
+    // the short keys are stored inside the string object
+    static size_t KeyBytes(const std::string& key)
+    {
+        return key.capacity() > std::string().capacity() ? key.capacity() + 1 : 0;
+    }
+
+    template <class Value>
+    static bool WriteValue(std::FILE* file, const Value& value)
+    {
+        const uint64_t converted = static_cast<uint64_t>(value);
+
+        return std::fwrite(&converted, sizeof(converted), 1, file) == 1;
+    }
+
+    template <class Iterator>
+    static bool WriteCounts(std::FILE* file, size_t size, Iterator begin, Iterator end)
+    {
+        if (!WriteValue(file, size))
+            return false;
+
+        for (auto it = begin; it != end; ++it)
+            if (!WriteValue(file, it->first.length()) || !WriteValue(file, it->second) ||
+                std::fwrite(it->first.data(), 1, it->first.length(), file) != it->first.length())
+                return false;
+
+        return true;
+    }
+
+    static bool ReadValue(std::FILE* file, uint64_t& value)
+    {
+        return std::fread(&value, sizeof(value), 1, file) == 1;
+    }
+
+    static bool ReadCount(std::FILE* file, std::pair<std::string, size_t>& entry)
+    {
+        uint64_t length = 0;
+        uint64_t count = 0;
+        if (!ReadValue(file, length) || !ReadValue(file, count))
+            return false;
+
+        // the keys are bit strings, anything longer is a corrupted file
+        if (length > (uint64_t(1) << 20))
+            return false;
+
+        entry.first.resize(static_cast<size_t>(length));
+        entry.second = static_cast<size_t>(count);
+
+        return std::fread(entry.first.data(), 1, entry.first.length(), file) ==
+               entry.first.length();
+    }
+};
@@ -0,0 +1,197 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file ShadowSimulator.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Classical shadow snapshots of the state prepared by a circuit.
+ *
+ * Each worker simulates the circuit once and saves the state. A snapshot
+ * restores it, rotates every qubit into a random Pauli basis and measures all
+ * of them, so the cost of the circuit is paid once per worker, not once per
+ * snapshot. The basis of snapshot s depends only on the seed and s, not on
+ * the worker that takes it.
+ *
+ * Snapshot s is the record at s * GetRecordSize(qubits), with two parts:
+ * - bases: ceil(2 n / 8) bytes, the basis of qubit q in bits 2q and 2q + 1
+ *   (0 - X, 1 - Y, 2 - Z)
+ * - outcomes: ceil(n / 8) bytes, the outcome of qubit q in bit q
+ * Bit i is bit i % 8 of byte i / 8 of its part.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Circuit.hpp"
+#include "Simulator.hpp"
+
+class ShadowSimulator
+{
+public:
+    enum Basis : uint8_t
+    {
+        X = 0,
+        Y = 1,
+        Z = 2
+    };
+
+    struct Config
+    {
+        std::string library;
+        int simType = 1;     // aer or qcsim, see CreateSimulator
+        int simExecType = 0; // statevector or matrix product state
+        size_t maxBondDim = 0;
+        size_t workers = 1;
+        bool isolated = false; // each worker loads its own instance of the library, see Library.h
+        uint64_t seed = 0;
+    };
+
+    static size_t GetBasesSize(size_t qubits) { return (2 * qubits + 7) / 8; }
+
+    static size_t GetRecordSize(size_t qubits) { return GetBasesSize(qubits) + (qubits + 7) / 8; }
+
+    /**
+     * @brief Checks if the state of the circuit can be snapshotted.
+     * @details Measurements at the end and barriers are skipped, the state must
+     * not depend on measurements, resets or conditions.
+     */
+    static bool IsSupported(const Circuit& circuit)
+    {
+        return circuit.nrQubits != 0 && !circuit.IsDynamic();
+    }
+
+    /**
+     * @brief Takes the snapshots, records is resized to hold all of them.
+     * @details stop is checked between snapshots.
+     */
+    static SimulationResult Run(const Circuit& circuit, size_t snapshots, const Config& config,
+                                std::vector<uint8_t>& records,
+                                const std::function<bool()>& stop = {})
+    {
+        if (!IsSupported(circuit) || snapshots == 0)
+            return SimulationResult::Failed;
+
+        const size_t nrQubits = circuit.nrQubits;
+        const size_t recordSize = GetRecordSize(nrQubits);
+        records.assign(snapshots * recordSize, 0);
+
+        const size_t workers = std::max<size_t>(1, std::min(config.workers, snapshots));
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+        std::atomic<bool> stopped{false};
+
+        const auto work = [&]() {
+            try {
+                Simulator simulator;
+                if (!simulator.Init(config.library.c_str(), config.isolated) ||
+                    !simulator.CreateSimulator(config.simType, config.simExecType))
+                    throw std::runtime_error("cannot create the simulator");
+                if (config.maxBondDim != 0)
+                    simulator.ConfigureSimulator("matrix_product_state_max_bond_dimension",
+                                                 std::to_string(config.maxBondDim).c_str());
+                simulator.AllocateQubits(static_cast<unsigned long int>(nrQubits));
+                simulator.InitializeSimulator();
+                // the parallelism is over the snapshots
+                simulator.SetMultithreading(0);
+
+                for (const auto& op : circuit.operations)
+                    if (op.type != GateType::Measure && op.type != GateType::Barrier)
+                        simulator.ApplyOperation(op);
+                simulator.SaveState();
+
+                std::vector<unsigned long int> qubits(nrQubits);
+                for (size_t q = 0; q < nrQubits; ++q)
+                    qubits[q] = static_cast<unsigned long int>(q);
+
+                std::uniform_int_distribution<int> basis(X, Z);
+                for (;;) {
+                    if (failed || stopped)
+                        break;
+                    if (stop && stop()) {
+                        stopped = true;
+                        break;
+                    }
+
+                    const size_t s = next++;
+                    if (s >= snapshots)
+                        break;
+
+                    std::seed_seq seed{static_cast<uint32_t>(config.seed),
+                                       static_cast<uint32_t>(config.seed >> 32),
+                                       static_cast<uint32_t>(s), static_cast<uint32_t>(s >> 32)};
+                    std::mt19937_64 rng(seed);
+
+                    simulator.RestoreState();
+
+                    uint8_t* record = records.data() + s * recordSize;
+                    for (size_t q = 0; q < nrQubits; ++q) {
+                        const int b = basis(rng);
+                        record[q / 4] |= static_cast<uint8_t>(b << (2 * (q % 4)));
+                        if (b == Y)
+                            simulator.ApplySDG(static_cast<int>(q));
+                        if (b != Z)
+                            simulator.ApplyH(static_cast<int>(q));
+                    }
+
+                    // the library measures up to 64 qubits at once
+                    uint8_t* outcomes = record + GetBasesSize(nrQubits);
+                    for (size_t first = 0; first < nrQubits; first += 64) {
+                        const size_t count = std::min<size_t>(64, nrQubits - first);
+                        const unsigned long long int bits = simulator.Measure(
+                            qubits.data() + first, static_cast<unsigned long int>(count));
+                        for (size_t q = 0; q < count; ++q)
+                            if ((bits >> q) & 1)
+                                outcomes[(first + q) / 8] |=
+                                    static_cast<uint8_t>(1 << ((first + q) % 8));
+                    }
+                }
+            } catch (const std::exception&) {
+                failed = true;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (size_t w = 1; w < workers; ++w)
+            threads.emplace_back(work);
+        work();
+        for (auto& thread : threads)
+            thread.join();
+
+        if (failed || stopped) {
+            records.clear();
+            records.shrink_to_fit();
+        }
+
+        if (failed)
+            return SimulationResult::Failed;
+
+        return stopped ? SimulationResult::Stopped : SimulationResult::Done;
+    }
+};
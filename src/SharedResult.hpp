@@ -0,0 +1,156 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file SharedResult.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The results of a job in a POSIX shared memory segment.
+ *
+ * Processes on the same host map the segment read only and use the results in
+ * place. The layout, in the native byte order, is a SharedResultHeader followed
+ * by the sections it points to:
+ * - counts: `entries` uint64_t, the shots of the outcomes
+ * - keys: `entries` bit strings of `keyLength` characters each, without
+ *   separators, in the same order as the counts, character i is classical bit i
+ * - unitary: `unitaryDim` x `unitaryDim` complex doubles (real, imaginary) in
+ *   column major order, only for the jobs with the unitary option
+ * The offsets are from the start of the segment, counts and unitary are 16 byte
+ * aligned. The segment stays valid for the processes that mapped it even after
+ * the device removes it.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+struct SharedResultHeader
+{
+    static constexpr char Magic[8] = {'M', 'Q', 'D', 'M', 'I', 'R', 'E', 'S'};
+    static constexpr uint32_t CurrentVersion = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t keyLength;
+    uint64_t entries;
+    uint64_t shots; // the sum of the counts
+    uint64_t unitaryDim;
+    uint64_t countsOffset;
+    uint64_t keysOffset;
+    uint64_t unitaryOffset;
+    uint64_t size; // of the whole segment
+};
+
+class SharedResult
+{
+public:
+    /**
+     * @brief Creates the segment with the results, replacing one with the same name.
+     * @return the size of the segment, 0 if it cannot be created or the keys are not all
+     * of the same length.
+     */
+    static size_t Create(const std::string& name, const std::map<std::string, size_t>& results,
+                         const std::vector<std::complex<double>>& unitary)
+    {
+#if defined(_WIN32)
+        (void)name;
+        (void)results;
+        (void)unitary;
+
+        return 0;
+#else
+        if (!results.empty()) {
+            const size_t keyLength = results.begin()->first.length();
+            for (const auto& result : results)
+                if (result.first.length() != keyLength)
+                    return 0;
+        }
+
+        SharedResultHeader header{};
+        std::memcpy(header.magic, SharedResultHeader::Magic, sizeof(header.magic));
+        header.version = SharedResultHeader::CurrentVersion;
+        header.keyLength =
+            results.empty() ? 0 : static_cast<uint32_t>(results.begin()->first.length());
+        header.entries = results.size();
+        header.unitaryDim = static_cast<uint64_t>(
+            std::llround(std::sqrt(static_cast<double>(unitary.size()))));
+
+        header.countsOffset = Align(sizeof(SharedResultHeader));
+        header.keysOffset = header.countsOffset + header.entries * sizeof(uint64_t);
+        header.unitaryOffset = Align(header.keysOffset + header.entries * header.keyLength);
+        header.size = header.unitaryOffset + unitary.size() * sizeof(std::complex<double>);
+
+        const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+        if (fd == -1)
+            return 0;
+
+        void* memory = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(header.size)) == 0)
+            memory = mmap(nullptr, header.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (memory == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            return 0;
+        }
+
+        char* base = static_cast<char*>(memory);
+        uint64_t* counts = reinterpret_cast<uint64_t*>(base + header.countsOffset);
+        char* keys = base + header.keysOffset;
+        for (const auto& [key, count] : results) {
+            *counts++ = count;
+            header.shots += count;
+            key.copy(keys, header.keyLength);
+            keys += header.keyLength;
+        }
+        if (!unitary.empty())
+            std::memcpy(base + header.unitaryOffset, unitary.data(),
+                        unitary.size() * sizeof(std::complex<double>));
+        std::memcpy(base, &header, sizeof(header));
+
+        munmap(memory, header.size);
+
+        return static_cast<size_t>(header.size);
+#endif
+    }
+
+    static void Remove(const std::string& name)
+    {
+#if !defined(_WIN32)
+        shm_unlink(name.c_str());
+#else
+        (void)name;
+#endif
+    }
+
+private:
+    static uint64_t Align(uint64_t offset) { return (offset + 15) & ~uint64_t(15); }
+};
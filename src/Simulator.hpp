@@ -17,8 +17,17 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include "Circuit.hpp"
 #include "MaestroLib.hpp"
 
+// how a simulation driven through the gate API ended
+enum class SimulationResult
+{
+    Done,
+    Failed,
+    Stopped // stopped early, the job was canceled or the device is aborting
+};
+
 class SimpleSimulator : protected MaestroLibrary
 {
 public:
@@ -30,9 +39,9 @@ public:
             DestroySimpleSimulator(handle);
     }
 
-    bool Init(const char* libName) noexcept override
+    bool Init(const char* libName, bool isolated = false) noexcept override
     {
-        if (MaestroLibrary::Init(libName))
+        if (MaestroLibrary::Init(libName, isolated))
             return true;
 
         return false;
@@ -72,6 +81,18 @@ public:
 
     void FreeResult(char* result) override { MaestroLibrary::FreeResult(result); }
 
+    // frees the simulator and its state, the next CreateSimpleSimulator makes a new one
+    bool Release()
+    {
+        if (!handle)
+            return false;
+
+        DestroySimpleSimulator(handle);
+        handle = 0;
+
+        return true;
+    }
+
 private:
     unsigned long int handle = 0;
 };
@@ -87,9 +108,9 @@ public:
             DestroySimulator(handle);
     }
 
-    bool Init(const char* libName) noexcept override
+    bool Init(const char* libName, bool isolated = false) noexcept override
     {
-        if (MaestroLibrary::Init(libName))
+        if (MaestroLibrary::Init(libName, isolated))
             return true;
 
         return false;
@@ -510,6 +531,114 @@ public:
         return 0;
     }
 
+    /**
+     * @brief Applies an operation of the gate stream, ignoring its condition.
+     * @details Measurements and barriers are left to the caller.
+     */
+    void ApplyOperation(const Operation& op)
+    {
+        const int q0 = static_cast<int>(op.qubits[0]);
+        const int q1 = static_cast<int>(op.qubits[1]);
+        const int q2 = static_cast<int>(op.qubits[2]);
+        const double* p = op.params;
+
+        switch (op.type) {
+        case GateType::X:
+            ApplyX(q0);
+            break;
+        case GateType::Y:
+            ApplyY(q0);
+            break;
+        case GateType::Z:
+            ApplyZ(q0);
+            break;
+        case GateType::H:
+            ApplyH(q0);
+            break;
+        case GateType::S:
+            ApplyS(q0);
+            break;
+        case GateType::SDG:
+            ApplySDG(q0);
+            break;
+        case GateType::T:
+            ApplyT(q0);
+            break;
+        case GateType::TDG:
+            ApplyTDG(q0);
+            break;
+        case GateType::SX:
+            ApplySX(q0);
+            break;
+        case GateType::SXDG:
+            ApplySXDG(q0);
+            break;
+        case GateType::P:
+            ApplyP(q0, p[0]);
+            break;
+        case GateType::Rx:
+            ApplyRx(q0, p[0]);
+            break;
+        case GateType::Ry:
+            ApplyRy(q0, p[0]);
+            break;
+        case GateType::Rz:
+            ApplyRz(q0, p[0]);
+            break;
+        case GateType::U:
+            ApplyU(q0, p[0], p[1], p[2], p[3]);
+            break;
+        case GateType::CX:
+            ApplyCX(q0, q1);
+            break;
+        case GateType::CY:
+            ApplyCY(q0, q1);
+            break;
+        case GateType::CZ:
+            ApplyCZ(q0, q1);
+            break;
+        case GateType::CH:
+            ApplyCH(q0, q1);
+            break;
+        case GateType::CSX:
+            ApplyCSX(q0, q1);
+            break;
+        case GateType::CSXDG:
+            ApplyCSXDG(q0, q1);
+            break;
+        case GateType::CP:
+            ApplyCP(q0, q1, p[0]);
+            break;
+        case GateType::CRx:
+            ApplyCRx(q0, q1, p[0]);
+            break;
+        case GateType::CRy:
+            ApplyCRy(q0, q1, p[0]);
+            break;
+        case GateType::CRz:
+            ApplyCRz(q0, q1, p[0]);
+            break;
+        case GateType::CU:
+            ApplyCU(q0, q1, p[0], p[1], p[2], p[3]);
+            break;
+        case GateType::Swap:
+            ApplySwap(q0, q1);
+            break;
+        case GateType::CCX:
+            ApplyCCX(q0, q1, q2);
+            break;
+        case GateType::CSwap:
+            ApplyCSwap(q0, q1, q2);
+            break;
+        case GateType::Reset: {
+            const unsigned long int qubit = op.qubits[0];
+            ApplyReset(&qubit, 1);
+        } break;
+        default:
+            break;
+        }
+    }
+
 private:
     unsigned long int handle = 0;
     void* simulatorPtr = nullptr;
@@ -0,0 +1,241 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file StabilizerTableau.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The stabilizer tableau of the state prepared by a Clifford circuit.
+ *
+ * The tableau is tracked on the device, the gate API of the library only
+ * samples. The circuit is first lowered with the stabilizer transpiler target,
+ * any gate left that is not H, S, Sdg, a Pauli, CX, CY, CZ or swap makes it
+ * fail. Measurements at the end and barriers are skipped, resets and
+ * conditions are rejected. The columns of the tableau are bit sets over the
+ * rows, so a gate costs O(n / 64) word operations.
+ *
+ * The packed layout has 2n rows, n destabilizers followed by n stabilizers,
+ * row i being (-1)^r_i times X, Z or Y (both bits) on each qubit. Row i is
+ * 2 ceil(n / 8) bytes, the x bits of the qubits followed by the z bits, and
+ * after the rows come ceil(2n / 8) bytes with the phase r_i in bit i.
+ * Bit i is bit i % 8 of byte i / 8 of its part.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "Circuit.hpp"
+#include "Simulator.hpp"
+#include "Transpiler.hpp"
+
+class StabilizerTableau
+{
+public:
+    // the number of gates applied between the checks of stop
+    static constexpr size_t StopCheckGates = 1024;
+
+    explicit StabilizerTableau(size_t qubits = 0) { Reset(qubits); }
+
+    // |0...0>, destabilizer i is X_i and stabilizer i is Z_i
+    void Reset(size_t qubits)
+    {
+        nrQubits = qubits;
+        rowWords = (2 * qubits + 63) / 64;
+        x.assign(qubits, std::vector<uint64_t>(rowWords, 0));
+        z.assign(qubits, std::vector<uint64_t>(rowWords, 0));
+        r.assign(rowWords, 0);
+
+        for (size_t q = 0; q < qubits; ++q) {
+            x[q][q / 64] |= uint64_t(1) << (q % 64);
+            z[q][(qubits + q) / 64] |= uint64_t(1) << ((qubits + q) % 64);
+        }
+    }
+
+    size_t GetNrQubits() const { return nrQubits; }
+
+    static size_t GetPackedSize(size_t qubits)
+    {
+        return 2 * qubits * 2 * ((qubits + 7) / 8) + (2 * qubits + 7) / 8;
+    }
+
+    /**
+     * @brief Computes the tableau at the end of the circuit.
+     * @details stop is checked every StopCheckGates gates. Failed if the
+     * circuit is dynamic or not Clifford.
+     */
+    static SimulationResult Run(const Circuit& circuit, StabilizerTableau& tableau,
+                                const std::function<bool()>& stop = {})
+    {
+        if (circuit.nrQubits == 0 || circuit.IsDynamic())
+            return SimulationResult::Failed;
+
+        const Circuit lowered = Transpiler::Transpile(circuit, TranspileTarget::Stabilizer);
+        tableau.Reset(circuit.nrQubits);
+
+        size_t applied = 0;
+        for (const auto& op : lowered.operations) {
+            if (++applied % StopCheckGates == 0 && stop && stop())
+                return SimulationResult::Stopped;
+            if (!tableau.Apply(op))
+                return SimulationResult::Failed;
+        }
+
+        return SimulationResult::Done;
+    }
+
+    /**
+     * @brief Applies a gate, false if it's not one of the supported Cliffords.
+     * @details Measurements and barriers are ignored.
+     */
+    bool Apply(const Operation& op)
+    {
+        const uint32_t a = op.qubits[0];
+        const uint32_t b = op.qubits[1];
+
+        switch (op.type) {
+        case GateType::Measure:
+        case GateType::Barrier:
+            break;
+        case GateType::X:
+            ApplyPauli(a, false, true);
+            break;
+        case GateType::Y:
+            ApplyPauli(a, true, true);
+            break;
+        case GateType::Z:
+            ApplyPauli(a, true, false);
+            break;
+        case GateType::H:
+            ApplyH(a);
+            break;
+        case GateType::S:
+            ApplyS(a);
+            break;
+        case GateType::SDG:
+            ApplySDG(a);
+            break;
+        case GateType::CX:
+            ApplyCX(a, b);
+            break;
+        case GateType::CY:
+            // CY = S_b CX Sdg_b
+            ApplySDG(b);
+            ApplyCX(a, b);
+            ApplyS(b);
+            break;
+        case GateType::CZ:
+            ApplyH(b);
+            ApplyCX(a, b);
+            ApplyH(b);
+            break;
+        case GateType::Swap:
+            std::swap(x[a], x[b]);
+            std::swap(z[a], z[b]);
+            break;
+        default:
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Writes the tableau in the packed layout described above.
+     */
+    std::vector<uint8_t> Pack() const
+    {
+        const size_t rows = 2 * nrQubits;
+        const size_t partSize = (nrQubits + 7) / 8;
+        std::vector<uint8_t> packed(GetPackedSize(nrQubits), 0);
+
+        for (size_t q = 0; q < nrQubits; ++q) {
+            const uint8_t bit = static_cast<uint8_t>(1 << (q % 8));
+            for (size_t row = 0; row < rows; ++row) {
+                uint8_t* bytes = packed.data() + row * 2 * partSize;
+                if (Get(x[q], row))
+                    bytes[q / 8] |= bit;
+                if (Get(z[q], row))
+                    bytes[partSize + q / 8] |= bit;
+            }
+        }
+
+        uint8_t* phases = packed.data() + rows * 2 * partSize;
+        for (size_t row = 0; row < rows; ++row)
+            if (Get(r, row))
+                phases[row / 8] |= static_cast<uint8_t>(1 << (row % 8));
+
+        return packed;
+    }
+
+private:
+    static bool Get(const std::vector<uint64_t>& bits, size_t row)
+    {
+        return (bits[row / 64] >> (row % 64)) & 1;
+    }
+
+    // a Pauli flips the phase of the rows that anticommute with it
+    void ApplyPauli(uint32_t a, bool withX, bool withZ)
+    {
+        for (size_t w = 0; w < rowWords; ++w)
+            r[w] ^= (withX ? x[a][w] : 0) ^ (withZ ? z[a][w] : 0);
+    }
+
+    void ApplyH(uint32_t a)
+    {
+        for (size_t w = 0; w < rowWords; ++w)
+            r[w] ^= x[a][w] & z[a][w];
+        std::swap(x[a], z[a]);
+    }
+
+    void ApplyS(uint32_t a)
+    {
+        for (size_t w = 0; w < rowWords; ++w) {
+            r[w] ^= x[a][w] & z[a][w];
+            z[a][w] ^= x[a][w];
+        }
+    }
+
+    // X -> -Y, Y -> X
+    void ApplySDG(uint32_t a)
+    {
+        for (size_t w = 0; w < rowWords; ++w) {
+            r[w] ^= x[a][w] & ~z[a][w];
+            z[a][w] ^= x[a][w];
+        }
+    }
+
+    void ApplyCX(uint32_t a, uint32_t b)
+    {
+        for (size_t w = 0; w < rowWords; ++w) {
+            r[w] ^= x[a][w] & z[b][w] & ~(x[b][w] ^ z[a][w]);
+            x[b][w] ^= x[a][w];
+            z[a][w] ^= z[b][w];
+        }
+    }
+
+    size_t nrQubits = 0;
+    size_t rowWords = 0;
+    std::vector<std::vector<uint64_t>> x; // x[q] - the x bits of qubit q in all the rows
+    std::vector<std::vector<uint64_t>> z;
+    std::vector<uint64_t> r;
+};
@@ -0,0 +1,295 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file TrajectorySimulator.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Monte Carlo trajectory simulation of noisy circuits.
+ *
+ * Each trajectory applies the gates of the circuit with the gate API of the
+ * library, inserting the errors sampled from the noise model after them:
+ * - depolarizing: a random non identity Pauli on the qubits of the gate
+ * - amplitude damping: a decay of each qubit of the gate, done exactly with an
+ *   ancilla qubit that is rotated conditionally, swapped in and reset
+ * - readout error: the measured bits are flipped
+ *
+ * If the measurements are all at the end, the state of a trajectory is sampled
+ * for a batch of shots, otherwise every shot is a trajectory of its own.
+ * The trajectories are distributed over workers, each with its own simulator,
+ * and their histograms are merged at the end. The simulators run single
+ * threaded, the throughput scales with the number of workers.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Circuit.hpp"
+#include "NoiseModel.hpp"
+#include "Simulator.hpp"
+
+class TrajectorySimulator
+{
+public:
+    // used when the number of trajectories is not set
+    static constexpr size_t DefaultTrajectories = 1024;
+
+    struct Config
+    {
+        std::string library;
+        int simType = 1;    // aer or qcsim, see CreateSimulator
+        int simExecType = 0; // statevector, matrix product state or stabilizer
+        size_t maxBondDim = 0;
+        size_t workers = 1;
+        bool isolated = false; // each worker loads its own instance of the library, see Library.h
+        size_t trajectories = 0; // 0 - default, it's capped to the number of shots anyway
+        uint64_t seed = 0;
+        size_t keyLength = 0; // 0 - the classical bits of the circuit, otherwise at least those
+    };
+
+    /**
+     * @brief Runs the noisy circuit and adds the histogram of the shots to counts.
+     * @details stop is checked between trajectories, if it returns true the
+     * simulation ends early and the counts are incomplete. The keys have the layout of the
+     * library results: keyLength characters, the one at position i is classical bit i.
+     * Failed if the circuit has more classical bits than keyLength.
+     */
+    static SimulationResult Run(const Circuit& circuit, const NoiseModel& noise, size_t shots,
+                                const Config& config, std::map<std::string, size_t>& counts,
+                                const std::function<bool()>& stop = {})
+    {
+        const size_t keyLength = config.keyLength ? config.keyLength : circuit.nrCbits;
+        if (keyLength < circuit.nrCbits)
+            return SimulationResult::Failed;
+        if (shots == 0)
+            return SimulationResult::Done;
+
+        const bool ancilla = noise.HasAmplitudeDamping();
+        const size_t nrQubits = circuit.nrQubits + (ancilla ? 1 : 0);
+
+        // the sampled state has to fit into a single word
+        const bool batched = !circuit.IsDynamic() && nrQubits <= 64;
+        const size_t trajectories =
+            batched ? std::min(shots, config.trajectories ? config.trajectories
+                                                          : DefaultTrajectories)
+                    : shots;
+        const size_t workers = std::max<size_t>(1, std::min(config.workers, trajectories));
+
+        std::vector<std::map<std::string, size_t>> workerCounts(workers);
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+        std::atomic<bool> stopped{false};
+
+        const auto work = [&](size_t w) {
+            try {
+                Simulator simulator;
+                if (!simulator.Init(config.library.c_str(), config.isolated) ||
+                    !simulator.CreateSimulator(config.simType, config.simExecType))
+                    throw std::runtime_error("cannot create the simulator");
+                if (config.maxBondDim != 0)
+                    simulator.ConfigureSimulator("matrix_product_state_max_bond_dimension",
+                                                 std::to_string(config.maxBondDim).c_str());
+                simulator.AllocateQubits(static_cast<unsigned long int>(nrQubits));
+                simulator.InitializeSimulator();
+                // the parallelism is over the trajectories
+                simulator.SetMultithreading(0);
+
+                Trajectory trajectory(simulator, circuit, noise, circuit.nrQubits, keyLength);
+                for (;;) {
+                    if (failed || stopped)
+                        break;
+                    if (stop && stop()) {
+                        stopped = true;
+                        break;
+                    }
+
+                    const size_t t = next++;
+                    if (t >= trajectories)
+                        break;
+
+                    // the shots are spread evenly, the first trajectories get the remainder
+                    const size_t trajectoryShots =
+                        shots / trajectories + (t < shots % trajectories ? 1 : 0);
+
+                    std::seed_seq seed{static_cast<uint32_t>(config.seed),
+                                       static_cast<uint32_t>(config.seed >> 32),
+                                       static_cast<uint32_t>(t), static_cast<uint32_t>(t >> 32)};
+                    trajectory.rng.seed(seed);
+
+                    simulator.ResetSimulator();
+                    if (batched)
+                        trajectory.RunBatch(trajectoryShots, workerCounts[w]);
+                    else
+                        trajectory.RunShot(workerCounts[w]);
+                }
+            } catch (const std::exception&) {
+                failed = true;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (size_t w = 1; w < workers; ++w)
+            threads.emplace_back(work, w);
+        work(0);
+        for (auto& thread : threads)
+            thread.join();
+
+        if (failed)
+            return SimulationResult::Failed;
+
+        for (const auto& partial : workerCounts)
+            for (const auto& [key, count] : partial)
+                counts[key] += count;
+
+        return stopped ? SimulationResult::Stopped : SimulationResult::Done;
+    }
+
+private:
+    class Trajectory
+    {
+    public:
+        Trajectory(Simulator& sim, const Circuit& c, const NoiseModel& model, size_t ancillaQubit,
+                   size_t length)
+            : simulator(sim), circuit(c), noise(model), ancilla(static_cast<int>(ancillaQubit)),
+              keyLength(length)
+        {
+        }
+
+        // the gates are applied once, the final state is sampled for all the shots
+        void RunBatch(size_t shots, std::map<std::string, size_t>& counts)
+        {
+            for (const auto& op : circuit.operations)
+                if (op.type != GateType::Measure)
+                    ApplyNoisy(op);
+
+            std::string key;
+            for (size_t shot = 0; shot < shots; ++shot) {
+                const unsigned long long int sample = simulator.MeasureNoCollapse();
+
+                key.assign(keyLength, '0');
+                for (const auto& op : circuit.operations)
+                    if (op.type == GateType::Measure)
+                        key[op.cbit] = ReadOut(((sample >> op.qubits[0]) & 1) != 0) ? '1' : '0';
+                ++counts[key];
+            }
+        }
+
+        // mid circuit measurements, resets or conditions, the shot is the trajectory
+        void RunShot(std::map<std::string, size_t>& counts)
+        {
+            std::string key(keyLength, '0');
+
+            for (const auto& op : circuit.operations) {
+                if (op.IsConditional()) {
+                    uint64_t value = 0;
+                    for (uint32_t b = 0; b < op.condSize; ++b)
+                        if (key[op.condOffset + b] == '1')
+                            value |= uint64_t(1) << b;
+                    if (value != op.condValue)
+                        continue;
+                }
+
+                if (op.type == GateType::Measure) {
+                    const unsigned long int qubit = op.qubits[0];
+                    const bool bit = (simulator.Measure(&qubit, 1) & 1) != 0;
+                    key[op.cbit] = ReadOut(bit) ? '1' : '0';
+                } else
+                    ApplyNoisy(op);
+            }
+
+            ++counts[key];
+        }
+
+        std::mt19937_64 rng;
+
+    private:
+        bool Chance(double probability)
+        {
+            return probability != 0 && std::uniform_real_distribution<double>()(rng) < probability;
+        }
+
+        bool ReadOut(bool bit) { return Chance(noise.GetReadoutError()) ? !bit : bit; }
+
+        void ApplyNoisy(const Operation& op)
+        {
+            simulator.ApplyOperation(op);
+
+            if (op.type == GateType::Reset || op.type == GateType::Barrier)
+                return;
+
+            const size_t nrQubits = GateQubits(op.type);
+
+            if (Chance(noise.GetDepolarizing(op.type))) {
+                // uniform over the non identity Paulis, two bits per qubit
+                const uint64_t paulis = std::uniform_int_distribution<uint64_t>(
+                    1, (uint64_t(1) << (2 * nrQubits)) - 1)(rng);
+                for (size_t q = 0; q < nrQubits; ++q) {
+                    const int qubit = static_cast<int>(op.qubits[q]);
+                    switch ((paulis >> (2 * q)) & 3) {
+                    case 1:
+                        simulator.ApplyX(qubit);
+                        break;
+                    case 2:
+                        simulator.ApplyY(qubit);
+                        break;
+                    case 3:
+                        simulator.ApplyZ(qubit);
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+
+            const double damping = noise.GetAmplitudeDamping(op.type);
+            if (damping != 0)
+                for (size_t q = 0; q < nrQubits; ++q)
+                    Decay(static_cast<int>(op.qubits[q]), damping);
+        }
+
+        // the ancilla takes the excitation with probability gamma, resetting it
+        // picks the Kraus operator of the channel
+        void Decay(int qubit, double gamma)
+        {
+            simulator.ApplyCRy(qubit, ancilla, 2. * std::asin(std::sqrt(gamma)));
+            simulator.ApplyCX(ancilla, qubit);
+
+            const unsigned long int ancillaQubit = static_cast<unsigned long int>(ancilla);
+            simulator.ApplyReset(&ancillaQubit, 1);
+        }
+
+        Simulator& simulator;
+        const Circuit& circuit;
+        const NoiseModel& noise;
+        const int ancilla;
+        const size_t keyLength;
+    };
+};
@@ -0,0 +1,518 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file Transpiler.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Backend aware rewriting of the gate stream.
+ *
+ * Each backend gets the gate set it executes fastest:
+ * - statevector: runs of single qubit gates are fused into a single U gate,
+ * - matrix product state: three qubit gates are decomposed and two qubit gates
+ *   are made nearest neighbour with swap chains,
+ * - stabilizer: rotations by multiples of pi/2 and the gates that are
+ *   Cliffords up to a phase are written with H, S, Sdg, Paulis and CX, CY, CZ,
+ * - Pauli propagation: three qubit gates are decomposed and runs of single
+ *   qubit gates are fused, for the observables propagated on the device, see
+ *   PauliPropagator.hpp.
+ * The other backends get the circuit unchanged. The target of a job is picked
+ * by the backend registry, see BackendRegistry.hpp.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <utility>
+#include <vector>
+
+#include "Circuit.hpp"
+
+enum class TranspileTarget
+{
+    None,
+    Statevector,
+    MatrixProductState,
+    Stabilizer,
+    PauliPropagation
+};
+
+class Transpiler
+{
+public:
+    static Circuit Transpile(const Circuit& circuit, TranspileTarget target)
+    {
+        switch (target) {
+        case TranspileTarget::Statevector:
+            return FuseSingleQubitGates(circuit);
+        case TranspileTarget::MatrixProductState:
+            return FuseSingleQubitGates(MakeNearestNeighbour(DecomposeThreeQubitGates(circuit)));
+        case TranspileTarget::Stabilizer:
+            return LowerToClifford(circuit);
+        case TranspileTarget::PauliPropagation:
+            return FuseSingleQubitGates(DecomposeThreeQubitGates(circuit));
+        default:
+            break;
+        }
+
+        return circuit;
+    }
+
+    using Matrix = std::complex<double>[2][2];
+
+    /**
+     * @brief Gets the matrix of a single qubit gate.
+     */
+    static void GetMatrix(const Operation& op, Matrix& m)
+    {
+        using namespace std::complex_literals;
+        const double r = 1. / std::sqrt(2.);
+        const double half = op.params[0] / 2;
+
+        switch (op.type) {
+        case GateType::X:
+            Set(m, 0, 1, 1, 0);
+            break;
+        case GateType::Y:
+            Set(m, 0, -1i, 1i, 0);
+            break;
+        case GateType::Z:
+            Set(m, 1, 0, 0, -1);
+            break;
+        case GateType::H:
+            Set(m, r, r, r, -r);
+            break;
+        case GateType::S:
+            Set(m, 1, 0, 0, 1i);
+            break;
+        case GateType::SDG:
+            Set(m, 1, 0, 0, -1i);
+            break;
+        case GateType::T:
+            Set(m, 1, 0, 0, std::polar(1., Pi / 4));
+            break;
+        case GateType::TDG:
+            Set(m, 1, 0, 0, std::polar(1., -Pi / 4));
+            break;
+        case GateType::SX:
+            Set(m, (1. + 1i) / 2., (1. - 1i) / 2., (1. - 1i) / 2., (1. + 1i) / 2.);
+            break;
+        case GateType::SXDG:
+            Set(m, (1. - 1i) / 2., (1. + 1i) / 2., (1. + 1i) / 2., (1. - 1i) / 2.);
+            break;
+        case GateType::P:
+            Set(m, 1, 0, 0, std::polar(1., op.params[0]));
+            break;
+        case GateType::Rx:
+            Set(m, std::cos(half), -1i * std::sin(half), -1i * std::sin(half), std::cos(half));
+            break;
+        case GateType::Ry:
+            Set(m, std::cos(half), -std::sin(half), std::sin(half), std::cos(half));
+            break;
+        case GateType::Rz:
+            Set(m, std::polar(1., -half), 0, 0, std::polar(1., half));
+            break;
+        default: {
+            // U(theta, phi, lambda, gamma)
+            const std::complex<double> phase = std::polar(1., op.params[3]);
+            Set(m, phase * std::cos(half), -phase * std::polar(1., op.params[2]) * std::sin(half),
+                phase * std::polar(1., op.params[1]) * std::sin(half),
+                phase * std::polar(1., op.params[1] + op.params[2]) * std::cos(half));
+        } break;
+        }
+    }
+
+    /**
+     * @brief Finds the U(theta, phi, lambda, gamma) parameters of a unitary 2x2 matrix.
+     */
+    static void GetUParams(const Matrix& m, double params[4])
+    {
+        const double eps = 1e-12;
+
+        const double c = std::abs(m[0][0]);
+        const double s = std::abs(m[1][0]);
+        params[0] = 2 * std::atan2(s, c);
+
+        if (c > eps) {
+            params[3] = std::arg(m[0][0]);
+            if (s > eps) {
+                params[1] = std::arg(m[1][0]) - params[3];
+                params[2] = std::arg(-m[0][1]) - params[3];
+            } else {
+                params[1] = 0;
+                params[2] = std::arg(m[1][1]) - params[3];
+            }
+        } else {
+            params[3] = 0;
+            params[1] = std::arg(m[1][0]);
+            params[2] = std::arg(-m[0][1]);
+        }
+    }
+
+private:
+    static void Set(Matrix& m, std::complex<double> m00, std::complex<double> m01,
+                    std::complex<double> m10, std::complex<double> m11)
+    {
+        m[0][0] = m00;
+        m[0][1] = m01;
+        m[1][0] = m10;
+        m[1][1] = m11;
+    }
+
+    // result = a * b
+    static void Multiply(const Matrix& a, const Matrix& b, Matrix& result)
+    {
+        Matrix r;
+        for (int i = 0; i < 2; ++i)
+            for (int j = 0; j < 2; ++j)
+                r[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j];
+
+        for (int i = 0; i < 2; ++i)
+            for (int j = 0; j < 2; ++j)
+                result[i][j] = r[i][j];
+    }
+
+    static bool IsFusable(const Operation& op)
+    {
+        return IsSingleQubitGate(op.type) && !op.IsConditional();
+    }
+
+    static Circuit FuseSingleQubitGates(const Circuit& circuit)
+    {
+        struct Pending
+        {
+            Matrix matrix;
+            Operation first;
+            size_t count = 0;
+        };
+
+        Circuit result = circuit;
+        result.operations.clear();
+        result.operations.reserve(circuit.operations.size());
+
+        std::vector<Pending> pending(circuit.nrQubits);
+
+        const auto flush = [&result, &pending](uint32_t qubit) {
+            Pending& p = pending[qubit];
+            if (p.count == 1)
+                result.operations.push_back(p.first);
+            else if (p.count > 1) {
+                double params[4];
+                GetUParams(p.matrix, params);
+                result.Add(GateType::U, qubit, 0, 0, params[0], params[1], params[2], params[3]);
+            }
+            p.count = 0;
+        };
+
+        for (const auto& op : circuit.operations) {
+            if (IsFusable(op)) {
+                Pending& p = pending[op.qubits[0]];
+                Matrix m;
+                GetMatrix(op, m);
+                if (p.count == 0) {
+                    p.first = op;
+                    for (int i = 0; i < 2; ++i)
+                        for (int j = 0; j < 2; ++j)
+                            p.matrix[i][j] = m[i][j];
+                } else
+                    Multiply(m, p.matrix, p.matrix);
+                ++p.count;
+                continue;
+            }
+
+            if (op.type == GateType::Barrier) {
+                for (uint32_t q = op.qubits[0]; q <= op.qubits[1] && q < circuit.nrQubits; ++q)
+                    flush(q);
+            } else {
+                for (size_t q = 0; q < GateQubits(op.type); ++q)
+                    flush(op.qubits[q]);
+            }
+
+            result.operations.push_back(op);
+        }
+
+        for (uint32_t q = 0; q < circuit.nrQubits; ++q)
+            flush(q);
+
+        return result;
+    }
+
+    static void Emit(Circuit& circuit, const Operation& like, GateType type, uint32_t q0,
+                     uint32_t q1 = 0, uint32_t q2 = 0, double p0 = 0)
+    {
+        Operation op = like;
+        op.type = type;
+        op.qubits[0] = q0;
+        op.qubits[1] = q1;
+        op.qubits[2] = q2;
+        op.params[0] = p0;
+
+        circuit.operations.push_back(op);
+    }
+
+    static Circuit DecomposeThreeQubitGates(const Circuit& circuit)
+    {
+        Circuit result = circuit;
+        result.operations.clear();
+
+        for (const auto& op : circuit.operations) {
+            const uint32_t a = op.qubits[0];
+            const uint32_t b = op.qubits[1];
+            const uint32_t c = op.qubits[2];
+
+            if (op.type == GateType::CCX)
+                EmitToffoli(result, op, a, b, c);
+            else if (op.type == GateType::CSwap) {
+                Emit(result, op, GateType::CX, c, b);
+                EmitToffoli(result, op, a, b, c);
+                Emit(result, op, GateType::CX, c, b);
+            } else
+                result.operations.push_back(op);
+        }
+
+        return result;
+    }
+
+    static void EmitToffoli(Circuit& circuit, const Operation& like, uint32_t a, uint32_t b,
+                            uint32_t c)
+    {
+        Emit(circuit, like, GateType::H, c);
+        Emit(circuit, like, GateType::CX, b, c);
+        Emit(circuit, like, GateType::TDG, c);
+        Emit(circuit, like, GateType::CX, a, c);
+        Emit(circuit, like, GateType::T, c);
+        Emit(circuit, like, GateType::CX, b, c);
+        Emit(circuit, like, GateType::TDG, c);
+        Emit(circuit, like, GateType::CX, a, c);
+        Emit(circuit, like, GateType::T, b);
+        Emit(circuit, like, GateType::T, c);
+        Emit(circuit, like, GateType::H, c);
+        Emit(circuit, like, GateType::CX, a, b);
+        Emit(circuit, like, GateType::T, a);
+        Emit(circuit, like, GateType::TDG, b);
+        Emit(circuit, like, GateType::CX, a, b);
+    }
+
+    /**
+     * @brief Routes the two qubit gates on a line.
+     * @details The first qubit of a distant pair is moved next to the second one
+     * with a swap chain and stays there, the layout is tracked and applied to
+     * the following operations, so measurements end up in the right bits.
+     * The layout is restored at the end only if there are operations after the
+     * last measurement (that is, if the final state matters).
+     */
+    static Circuit MakeNearestNeighbour(const Circuit& circuit)
+    {
+        Circuit result = circuit;
+        result.operations.clear();
+
+        // logical to physical qubit and the reverse
+        std::vector<uint32_t> physical(circuit.nrQubits);
+        std::vector<uint32_t> logical(circuit.nrQubits);
+        for (uint32_t q = 0; q < circuit.nrQubits; ++q)
+            physical[q] = logical[q] = q;
+
+        const auto swap = [&](uint32_t p1, uint32_t p2, const Operation& like) {
+            Emit(result, like, GateType::Swap, p1, p2);
+            std::swap(logical[p1], logical[p2]);
+            physical[logical[p1]] = p1;
+            physical[logical[p2]] = p2;
+        };
+
+        Operation unconditional;
+
+        for (const auto& op : circuit.operations) {
+            Operation mapped = op;
+
+            if (op.type == GateType::Barrier) {
+                mapped.qubits[0] = 0;
+                mapped.qubits[1] = static_cast<uint32_t>(circuit.nrQubits - 1);
+                result.operations.push_back(mapped);
+                continue;
+            }
+
+            for (size_t q = 0; q < GateQubits(op.type); ++q)
+                mapped.qubits[q] = physical[op.qubits[q]];
+
+            if (GateQubits(op.type) == 2) {
+                // the swaps are unconditional, the layout does not depend on the measurements
+                while (mapped.qubits[0] + 1 < mapped.qubits[1]) {
+                    swap(mapped.qubits[0], mapped.qubits[0] + 1, unconditional);
+                    ++mapped.qubits[0];
+                }
+                while (mapped.qubits[0] > mapped.qubits[1] + 1) {
+                    swap(mapped.qubits[0], mapped.qubits[0] - 1, unconditional);
+                    --mapped.qubits[0];
+                }
+            }
+
+            result.operations.push_back(mapped);
+        }
+
+        bool restore = false;
+        for (auto it = circuit.operations.rbegin(); it != circuit.operations.rend(); ++it) {
+            if (it->type == GateType::Measure)
+                break;
+            if (it->type != GateType::Barrier) {
+                restore = true;
+                break;
+            }
+        }
+
+        if (restore) {
+            // bubble sort with adjacent swaps
+            for (uint32_t p = 0; p < circuit.nrQubits; ++p)
+                for (uint32_t q = physical[p]; q > p; --q)
+                    swap(q - 1, q, unconditional);
+        }
+
+        return result;
+    }
+
+    // the number of quarter turns if the angle is a multiple of pi/2, -1 otherwise
+    static int QuarterTurns(double angle)
+    {
+        const double turns = angle / (Pi / 2);
+        const double rounded = std::round(turns);
+        if (std::abs(turns - rounded) > 1e-9)
+            return -1;
+
+        return static_cast<int>(((static_cast<long long>(rounded) % 4) + 4) % 4);
+    }
+
+    static void EmitZRotation(Circuit& circuit, const Operation& like, uint32_t q, int turns)
+    {
+        static const GateType gates[] = {GateType::Barrier, GateType::S, GateType::Z,
+                                         GateType::SDG};
+        if (turns != 0)
+            Emit(circuit, like, gates[turns], q);
+    }
+
+    static Circuit LowerToClifford(const Circuit& circuit)
+    {
+        Circuit result = circuit;
+        result.operations.clear();
+
+        for (const auto& op : circuit.operations) {
+            const uint32_t q = op.qubits[0];
+
+            switch (op.type) {
+            case GateType::SX:
+            case GateType::SXDG:
+                // sqrt(X) = H S H up to a phase
+                Emit(result, op, GateType::H, q);
+                Emit(result, op, op.type == GateType::SX ? GateType::S : GateType::SDG, q);
+                Emit(result, op, GateType::H, q);
+                continue;
+            case GateType::P:
+            case GateType::Rz: {
+                const int turns = QuarterTurns(op.params[0]);
+                if (turns >= 0) {
+                    EmitZRotation(result, op, q, turns);
+                    continue;
+                }
+            } break;
+            case GateType::Rx: {
+                const int turns = QuarterTurns(op.params[0]);
+                if (turns >= 0) {
+                    if (turns == 2)
+                        Emit(result, op, GateType::X, q);
+                    else if (turns != 0) {
+                        Emit(result, op, GateType::H, q);
+                        EmitZRotation(result, op, q, turns);
+                        Emit(result, op, GateType::H, q);
+                    }
+                    continue;
+                }
+            } break;
+            case GateType::Ry: {
+                const int turns = QuarterTurns(op.params[0]);
+                if (turns >= 0) {
+                    // ry(pi/2) = H Z, ry(-pi/2) = Z H, applied right to left
+                    if (turns == 1) {
+                        Emit(result, op, GateType::Z, q);
+                        Emit(result, op, GateType::H, q);
+                    } else if (turns == 2)
+                        Emit(result, op, GateType::Y, q);
+                    else if (turns == 3) {
+                        Emit(result, op, GateType::H, q);
+                        Emit(result, op, GateType::Z, q);
+                    }
+                    continue;
+                }
+            } break;
+            case GateType::U: {
+                // U(theta, phi, lambda) = Rz(phi) Ry(theta) Rz(lambda) up to a phase
+                const int theta = QuarterTurns(op.params[0]);
+                const int phi = QuarterTurns(op.params[1]);
+                const int lambda = QuarterTurns(op.params[2]);
+                if (theta >= 0 && phi >= 0 && lambda >= 0) {
+                    EmitZRotation(result, op, q, lambda);
+                    Operation rotation = op;
+                    rotation.type = GateType::Ry;
+                    rotation.params[0] = op.params[0];
+                    const Circuit ry = LowerToClifford(Single(circuit, rotation));
+                    result.operations.insert(result.operations.end(), ry.operations.begin(),
+                                             ry.operations.end());
+                    EmitZRotation(result, op, q, phi);
+                    continue;
+                }
+            } break;
+            case GateType::CP: {
+                // cp(pi) = cz
+                const int turns = QuarterTurns(op.params[0]);
+                if (turns == 0)
+                    continue;
+                if (turns == 2) {
+                    Emit(result, op, GateType::CZ, q, op.qubits[1]);
+                    continue;
+                }
+            } break;
+            case GateType::CRz: {
+                // crz has a period of 4 pi, crz(k pi) is a phase on the control, with a cz for odd k
+                const int turns = QuarterTurns(op.params[0] / 2);
+                if (turns >= 0) {
+                    if (turns == 1 || turns == 3) {
+                        Emit(result, op, turns == 1 ? GateType::SDG : GateType::S, q);
+                        Emit(result, op, GateType::CZ, q, op.qubits[1]);
+                    } else if (turns == 2)
+                        Emit(result, op, GateType::Z, q);
+                    continue;
+                }
+            } break;
+            default:
+                break;
+            }
+
+            result.operations.push_back(op);
+        }
+
+        return result;
+    }
+
+    static Circuit Single(const Circuit& like, const Operation& op)
+    {
+        Circuit circuit;
+        circuit.nrQubits = like.nrQubits;
+        circuit.operations.push_back(op);
+
+        return circuit;
+    }
+};
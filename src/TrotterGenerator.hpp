@@ -0,0 +1,358 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file TrotterGenerator.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Generator of Trotterized time evolution circuits.
+ *
+ * Instead of a circuit, the program describes the evolution exp(-i H t) under
+ * a Pauli sum H = sum_j c_j P_j, the device expands it into the gate stream.
+ * One statement per line, `#` or `//` start a comment:
+ *
+ *     qubits 4          # optional, deduced from the terms otherwise
+ *     time_step 0.05
+ *     steps 100
+ *     order 2           # 1 or an even Suzuki order, default 1
+ *     initial 0100      # optional, bit i is the starting value of qubit i
+ *     term 0.5 XXII     # dense Pauli string, character i acts on qubit i
+ *     term -1.2 Z0 Z3   # sparse form, only the non identity factors
+ *
+ * The evolution time is steps * time_step. All the qubits are measured at the
+ * end into a single register, so the results have the same layout as for
+ * OpenQASM programs.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Circuit.hpp"
+
+class TrotterGenerator
+{
+public:
+    static constexpr size_t MaxOrder = 8;
+
+    /**
+     * @brief Expands a generator program into the gate stream.
+     * @return true on success, otherwise the error can be retrieved with GetError().
+     */
+    bool Generate(const std::string& program, Circuit& circuit)
+    {
+        error.clear();
+        circuit = Circuit();
+
+        try {
+            Parse(program);
+            Expand(circuit);
+        } catch (const std::exception& ex) {
+            error = ex.what();
+            circuit = Circuit();
+            return false;
+        }
+
+        return true;
+    }
+
+    const std::string& GetError() const { return error; }
+
+private:
+    struct Term
+    {
+        double coefficient = 0;
+        std::vector<std::pair<uint32_t, char>> factors; // qubit, X, Y or Z
+    };
+
+    // a step of the product formula, the evolution under a single term
+    struct Slice
+    {
+        size_t term = 0;
+        double fraction = 0; // of the time step
+    };
+
+    void Parse(const std::string& program)
+    {
+        qubits = 0;
+        timeStep = 0;
+        steps = 0;
+        order = 1;
+        initial.clear();
+        terms.clear();
+
+        bool hasTimeStep = false;
+        bool hasSteps = false;
+        size_t declaredQubits = 0;
+        size_t denseLength = 0;
+        size_t sparseQubits = 0;
+
+        size_t pos = 0;
+        for (size_t line = 1; pos < program.length(); ++line) {
+            size_t eol = program.find('\n', pos);
+            if (eol == std::string::npos)
+                eol = program.length();
+            std::string text = program.substr(pos, eol - pos);
+            pos = eol + 1;
+
+            const size_t comment = std::min(text.find('#'), text.find("//"));
+            if (comment != std::string::npos)
+                text.resize(comment);
+
+            const std::vector<std::string> words = Split(text);
+            if (words.empty())
+                continue;
+
+            const auto fail = [line](const std::string& message) {
+                throw std::runtime_error(message + " at line " + std::to_string(line));
+            };
+            const auto expectWords = [&](size_t count) {
+                if (words.size() != count)
+                    fail("wrong number of values for '" + words[0] + "'");
+            };
+
+            const std::string& keyword = words[0];
+            if (keyword == "qubits") {
+                expectWords(2);
+                if (!ParseInteger(words[1], declaredQubits) || declaredQubits == 0)
+                    fail("invalid number of qubits");
+            } else if (keyword == "time_step") {
+                expectWords(2);
+                if (!ParseReal(words[1], timeStep))
+                    fail("invalid time step");
+                hasTimeStep = true;
+            } else if (keyword == "steps") {
+                expectWords(2);
+                if (!ParseInteger(words[1], steps))
+                    fail("invalid number of steps");
+                hasSteps = true;
+            } else if (keyword == "order") {
+                expectWords(2);
+                if (!ParseInteger(words[1], order) || order == 0 || order > MaxOrder ||
+                    (order > 1 && order % 2 != 0))
+                    fail("the order has to be 1 or an even number up to " +
+                         std::to_string(MaxOrder));
+            } else if (keyword == "initial") {
+                expectWords(2);
+                initial = words[1];
+                if (initial.find_first_not_of("01") != std::string::npos)
+                    fail("the initial state has to be a bit string");
+            } else if (keyword == "term") {
+                if (words.size() < 3)
+                    fail("a term needs a coefficient and a Pauli string");
+
+                Term term;
+                if (!ParseReal(words[1], term.coefficient))
+                    fail("invalid coefficient");
+
+                const bool dense = words.size() == 3 &&
+                                   words[2].find_first_not_of("IXYZ") == std::string::npos;
+                if (dense) {
+                    if (denseLength != 0 && denseLength != words[2].length())
+                        fail("the Pauli strings have different lengths");
+                    denseLength = words[2].length();
+                    for (size_t q = 0; q < words[2].length(); ++q)
+                        if (words[2][q] != 'I')
+                            term.factors.emplace_back(static_cast<uint32_t>(q), words[2][q]);
+                } else {
+                    for (size_t w = 2; w < words.size(); ++w) {
+                        size_t q = 0;
+                        const char pauli = words[w][0];
+                        if ((pauli != 'X' && pauli != 'Y' && pauli != 'Z') ||
+                            !ParseInteger(words[w].substr(1), q))
+                            fail("invalid Pauli factor '" + words[w] + "'");
+                        for (const auto& factor : term.factors)
+                            if (factor.first == q)
+                                fail("qubit " + std::to_string(q) + " appears twice in a term");
+                        term.factors.emplace_back(static_cast<uint32_t>(q), pauli);
+                        sparseQubits = std::max(sparseQubits, q + 1);
+                    }
+                    std::sort(term.factors.begin(), term.factors.end());
+                }
+
+                // identity terms only contribute a global phase
+                if (!term.factors.empty() && term.coefficient != 0)
+                    terms.push_back(std::move(term));
+            } else
+                fail("unknown statement '" + keyword + "'");
+        }
+
+        if (!hasTimeStep || !hasSteps)
+            throw std::runtime_error("the time step and the number of steps are required");
+
+        qubits = declaredQubits != 0
+                     ? declaredQubits
+                     : std::max({denseLength, sparseQubits, initial.length()});
+        if (qubits == 0)
+            throw std::runtime_error("the number of qubits is unknown");
+        if ((denseLength != 0 && denseLength != qubits) || sparseQubits > qubits ||
+            (!initial.empty() && initial.length() != qubits))
+            throw std::runtime_error("the terms do not match the number of qubits");
+    }
+
+    void Expand(Circuit& circuit) const
+    {
+        circuit.nrQubits = qubits;
+        circuit.nrCbits = qubits;
+        circuit.cregs.push_back({"c", 0, static_cast<uint32_t>(qubits)});
+
+        for (size_t q = 0; q < initial.length(); ++q)
+            if (initial[q] == '1')
+                circuit.Add(GateType::X, static_cast<uint32_t>(q));
+
+        std::vector<Slice> step;
+        AddProductFormula(step, order, 1.);
+
+        // the slices of the same term that end up next to each other are merged,
+        // for the symmetric formulas that is also the case at the step boundaries
+        std::vector<Slice> schedule;
+        for (size_t s = 0; s < steps; ++s)
+            for (const auto& slice : step) {
+                if (!schedule.empty() && schedule.back().term == slice.term)
+                    schedule.back().fraction += slice.fraction;
+                else
+                    schedule.push_back(slice);
+            }
+
+        for (const auto& slice : schedule)
+            AddRotation(circuit, terms[slice.term],
+                        2. * terms[slice.term].coefficient * timeStep * slice.fraction);
+
+        for (size_t q = 0; q < qubits; ++q) {
+            circuit.Add(GateType::Measure, static_cast<uint32_t>(q));
+            circuit.operations.back().cbit = static_cast<uint32_t>(q);
+        }
+    }
+
+    // Suzuki's recursion, the symmetric second order formula is the base case
+    void AddProductFormula(std::vector<Slice>& slices, size_t formulaOrder, double fraction) const
+    {
+        if (terms.empty())
+            return;
+
+        if (formulaOrder == 1) {
+            for (size_t t = 0; t < terms.size(); ++t)
+                slices.push_back({t, fraction});
+        } else if (formulaOrder == 2) {
+            for (size_t t = 0; t + 1 < terms.size(); ++t)
+                slices.push_back({t, fraction / 2});
+            slices.push_back({terms.size() - 1, fraction});
+            for (size_t t = terms.size() - 1; t-- > 0;)
+                slices.push_back({t, fraction / 2});
+        } else {
+            const double p =
+                1. / (4. - std::pow(4., 1. / static_cast<double>(formulaOrder - 1)));
+            for (const double f : {p, p, 1. - 4. * p, p, p})
+                AddProductFormula(slices, formulaOrder - 2, f * fraction);
+        }
+    }
+
+    // exp(-i angle / 2 P): change to the Z basis, collect the parity with a CNOT
+    // ladder, rotate the last qubit and undo the rest
+    static void AddRotation(Circuit& circuit, const Term& term, double angle)
+    {
+        const auto& factors = term.factors;
+        if (factors.size() == 1) {
+            const char pauli = factors[0].second;
+            circuit.Add(pauli == 'X' ? GateType::Rx : pauli == 'Y' ? GateType::Ry : GateType::Rz,
+                        factors[0].first, 0, 0, angle);
+            return;
+        }
+
+        for (const auto& [q, pauli] : factors)
+            if (pauli == 'X')
+                circuit.Add(GateType::H, q);
+            else if (pauli == 'Y') {
+                circuit.Add(GateType::SDG, q);
+                circuit.Add(GateType::H, q);
+            }
+
+        for (size_t i = 0; i + 1 < factors.size(); ++i)
+            circuit.Add(GateType::CX, factors[i].first, factors[i + 1].first);
+        circuit.Add(GateType::Rz, factors.back().first, 0, 0, angle);
+        for (size_t i = factors.size() - 1; i-- > 0;)
+            circuit.Add(GateType::CX, factors[i].first, factors[i + 1].first);
+
+        for (const auto& [q, pauli] : factors)
+            if (pauli == 'X')
+                circuit.Add(GateType::H, q);
+            else if (pauli == 'Y') {
+                circuit.Add(GateType::H, q);
+                circuit.Add(GateType::S, q);
+            }
+    }
+
+    static std::vector<std::string> Split(const std::string& text)
+    {
+        std::vector<std::string> words;
+
+        size_t pos = 0;
+        while (pos < text.length()) {
+            while (pos < text.length() && std::isspace(static_cast<unsigned char>(text[pos])))
+                ++pos;
+            const size_t start = pos;
+            while (pos < text.length() && !std::isspace(static_cast<unsigned char>(text[pos])))
+                ++pos;
+            if (pos > start)
+                words.push_back(text.substr(start, pos - start));
+        }
+
+        return words;
+    }
+
+    static bool ParseInteger(const std::string& text, size_t& value)
+    {
+        if (text.empty() || text.length() > 18)
+            return false;
+
+        size_t parsed = 0;
+        for (const char c : text) {
+            if (!std::isdigit(static_cast<unsigned char>(c)))
+                return false;
+            parsed = parsed * 10 + static_cast<size_t>(c - '0');
+        }
+        value = parsed;
+
+        return true;
+    }
+
+    static bool ParseReal(const std::string& text, double& value)
+    {
+        char* end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+
+        return end != text.c_str() && *end == 0 && std::isfinite(value);
+    }
+
+    size_t qubits = 0;
+    double timeStep = 0;
+    size_t steps = 0;
+    size_t order = 1;
+    std::string initial;
+    std::vector<Term> terms;
+
+    std::string error;
+};
@@ -0,0 +1,159 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file UnitarySimulator.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Computes the unitary of a small circuit.
+ *
+ * Column c of the unitary is the state the circuit produces from the basis
+ * state |c>, bit q of c being qubit q. The columns are distributed over
+ * workers, each simulating with its own statevector simulator and writing
+ * straight into the column major result buffer.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Circuit.hpp"
+#include "Simulator.hpp"
+
+class UnitarySimulator
+{
+public:
+    // 2^14 x 2^14 complex doubles take 4 GiB already
+    static constexpr size_t MaxQubits = 14;
+
+    struct Config
+    {
+        std::string library;
+        int simType = 1; // aer or qcsim, see CreateSimulator
+        size_t workers = 1;
+        bool isolated = false; // each worker loads its own instance of the library, see Library.h
+    };
+
+    /**
+     * @brief Checks if the unitary of the circuit can be computed.
+     * @details Measurements and barriers are skipped, resets and conditions are not unitary.
+     */
+    static bool IsSupported(const Circuit& circuit)
+    {
+        if (circuit.nrQubits == 0 || circuit.nrQubits > MaxQubits)
+            return false;
+
+        for (const auto& op : circuit.operations)
+            if (op.IsConditional() || op.type == GateType::Reset)
+                return false;
+
+        return true;
+    }
+
+    /**
+     * @brief Computes the unitary, element (row, column) is unitary[column * 2^n + row].
+     * @details stop is checked between columns.
+     */
+    static SimulationResult Run(const Circuit& circuit, const Config& config,
+                                std::vector<std::complex<double>>& unitary,
+                                const std::function<bool()>& stop = {})
+    {
+        if (!IsSupported(circuit))
+            return SimulationResult::Failed;
+
+        const size_t dim = size_t(1) << circuit.nrQubits;
+        unitary.assign(dim * dim, 0.);
+
+        const size_t workers = std::max<size_t>(1, std::min(config.workers, dim));
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+        std::atomic<bool> stopped{false};
+
+        const auto work = [&]() {
+            try {
+                Simulator simulator;
+                if (!simulator.Init(config.library.c_str(), config.isolated) ||
+                    !simulator.CreateSimulator(config.simType, 0))
+                    throw std::runtime_error("cannot create the simulator");
+                simulator.AllocateQubits(static_cast<unsigned long int>(circuit.nrQubits));
+                simulator.InitializeSimulator();
+                // the parallelism is over the columns
+                simulator.SetMultithreading(0);
+
+                for (;;) {
+                    if (failed || stopped)
+                        break;
+                    if (stop && stop()) {
+                        stopped = true;
+                        break;
+                    }
+
+                    const size_t column = next++;
+                    if (column >= dim)
+                        break;
+
+                    simulator.ResetSimulator();
+                    for (size_t q = 0; q < circuit.nrQubits; ++q)
+                        if ((column >> q) & 1)
+                            simulator.ApplyX(static_cast<int>(q));
+
+                    for (const auto& op : circuit.operations)
+                        if (op.type != GateType::Measure && op.type != GateType::Barrier)
+                            simulator.ApplyOperation(op);
+
+                    std::complex<double>* out = unitary.data() + column * dim;
+                    for (size_t row = 0; row < dim; ++row) {
+                        double* amplitude = simulator.Amplitude(row);
+                        if (amplitude == nullptr)
+                            throw std::runtime_error("cannot get the amplitude");
+                        out[row] = std::complex<double>(amplitude[0], amplitude[1]);
+                        simulator.FreeDoubleVector(amplitude);
+                    }
+                }
+            } catch (const std::exception&) {
+                failed = true;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (size_t w = 1; w < workers; ++w)
+            threads.emplace_back(work);
+        work();
+        for (auto& thread : threads)
+            thread.join();
+
+        if (failed || stopped) {
+            unitary.clear();
+            unitary.shrink_to_fit();
+        }
+
+        if (failed)
+            return SimulationResult::Failed;
+
+        return stopped ? SimulationResult::Stopped : SimulationResult::Done;
+    }
+};
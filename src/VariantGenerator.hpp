@@ -0,0 +1,158 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file VariantGenerator.hpp
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * Variants of a circuit generated on the device, for randomized compiling and
+ * zero noise extrapolation.
+ *
+ * - twirl: every unconditional CX and CZ gets a random Pauli on each of its
+ *   qubits before it and the Paulis that undo them after it, so the variant
+ *   implements the same unitary up to a global phase. Variant i draws its
+ *   Paulis from a generator seeded with the seed and i.
+ * - fold: variant i replaces every gate G with G (G^dagger G)^i, the noise
+ *   scale factors are 1, 3, 5, ... Measurements, resets and barriers are kept
+ *   as they are.
+ *
+ * The job runs every variant with all the shots, the histograms are merged or
+ * kept apart with the variant index as a key prefix, "2:0110".
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+
+#include "Circuit.hpp"
+
+enum class VariantMode
+{
+    Twirl,
+    Fold
+};
+
+class VariantGenerator
+{
+public:
+    /**
+     * @brief Generates variant index of the circuit.
+     */
+    static Circuit Generate(const Circuit& circuit, VariantMode mode, size_t index, uint64_t seed)
+    {
+        if (mode == VariantMode::Fold)
+            return Fold(circuit, index);
+
+        std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+                          static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32)};
+        std::mt19937_64 rng(seq);
+
+        return Twirl(circuit, rng);
+    }
+
+    static Circuit Twirl(const Circuit& circuit, std::mt19937_64& rng)
+    {
+        Circuit twirled = circuit;
+        twirled.operations.clear();
+        twirled.operations.reserve(circuit.operations.size());
+
+        std::uniform_int_distribution<int> bits(0, 15);
+        for (const auto& op : circuit.operations) {
+            if (op.IsConditional() || (op.type != GateType::CX && op.type != GateType::CZ)) {
+                twirled.operations.push_back(op);
+                continue;
+            }
+
+            // the Paulis as x and z bits, Y has both
+            const int random = bits(rng);
+            bool xc = random & 1;
+            bool zc = (random >> 1) & 1;
+            bool xt = (random >> 2) & 1;
+            bool zt = (random >> 3) & 1;
+
+            AddPauli(twirled, op.qubits[0], xc, zc);
+            AddPauli(twirled, op.qubits[1], xt, zt);
+            twirled.operations.push_back(op);
+
+            // the Paulis after the gate are the ones before it conjugated by it
+            if (op.type == GateType::CX) {
+                xt ^= xc;
+                zc ^= zt;
+            } else {
+                const bool x = xc;
+                zc ^= xt;
+                zt ^= x;
+            }
+            AddPauli(twirled, op.qubits[0], xc, zc);
+            AddPauli(twirled, op.qubits[1], xt, zt);
+        }
+
+        return twirled;
+    }
+
+    static Circuit Fold(const Circuit& circuit, size_t folds)
+    {
+        Circuit folded = circuit;
+        if (folds == 0)
+            return folded;
+
+        folded.operations.clear();
+        folded.operations.reserve(circuit.operations.size() * (2 * folds + 1));
+
+        for (const auto& op : circuit.operations) {
+            folded.operations.push_back(op);
+            if (op.type == GateType::Measure || op.type == GateType::Reset ||
+                op.type == GateType::Barrier)
+                continue;
+
+            const Operation inverse = InvertGate(op);
+            for (size_t i = 0; i < folds; ++i) {
+                folded.operations.push_back(inverse);
+                folded.operations.push_back(op);
+            }
+        }
+
+        return folded;
+    }
+
+    /**
+     * @brief Adds the counts of a variant to the ones of the job.
+     */
+    static void AddCounts(const std::map<std::string, size_t>& variantCounts, size_t index,
+                          bool perVariant, std::map<std::string, size_t>& counts)
+    {
+        const std::string prefix = perVariant ? std::to_string(index) + ":" : std::string();
+        for (const auto& [key, count] : variantCounts)
+            counts[prefix + key] += count;
+    }
+
+private:
+    static void AddPauli(Circuit& circuit, uint32_t qubit, bool x, bool z)
+    {
+        if (x && z)
+            circuit.Add(GateType::Y, qubit);
+        else if (x)
+            circuit.Add(GateType::X, qubit);
+        else if (z)
+            circuit.Add(GateType::Z, qubit);
+    }
+};
@@ -24,6 +24,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
 #include "maestro_qdmi/device.h"
+#include "maestro_device.h"
 
 #ifdef __cplusplus
 #include <cstddef>
@@ -45,24 +46,51 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <complex>
 #include <condition_variable>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iterator>
 #include <limits>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "BackendRegistry.hpp"
+#include "CompletionNotifier.hpp"
+#include "FidelitySimulator.hpp"
+#include "JobOptions.hpp"
+#include "MatrixProductState.hpp"
+#include "MemoryUsage.hpp"
+#include "PauliPropagator.hpp"
+#include "ProgramCache.hpp"
+#include "ResultSpill.hpp"
+#include "ShadowSimulator.hpp"
+#include "SharedResult.hpp"
 #include "Simulator.hpp"
+#include "StabilizerTableau.hpp"
+#include "TrajectorySimulator.hpp"
+#include "Transpiler.hpp"
+#include "UnitarySimulator.hpp"
+
+// the simulation library, loaded at runtime
+#if defined(_WIN32)
+constexpr const char* MAESTRO_QDMI_LIBRARY_NAME = "maestro.dll";
+#else
+constexpr const char* MAESTRO_QDMI_LIBRARY_NAME = "maestro.so";
+#endif
 
 enum class MAESTRO_QDMI_DEVICE_SESSION_STATUS : uint8_t
 {
@@ -85,6 +113,12 @@ struct MAESTRO_QDMI_Device_Session_impl_d
     size_t simExecType = 0; // 0 - statevector, 1 - mps, 2 - stabilizer, 3 - tensor network, any
                             // other value = whatever, auto if available
     size_t maxBondDim = 0;  // no limit
+
+    JobOptions options; // defaults for the jobs created in this session
+    std::string options_text;
+
+    // shared with the jobs, they can outlive the session
+    std::shared_ptr<CompletionNotifier> notifier = std::make_shared<CompletionNotifier>();
 };
 
 /**
@@ -93,13 +127,11 @@ struct MAESTRO_QDMI_Device_Session_impl_d
  */
 struct MAESTRO_QDMI_Device_Job_impl_d
 {
-    ~MAESTRO_QDMI_Device_Job_impl_d() { delete[] program; }
-
-    std::string GetConfigJson() const
+    static std::string GetConfigJson(size_t shots, size_t maxBondDim)
     {
         std::string config = "{\"shots\": ";
 
-        config += std::to_string(num_shots);
+        config += std::to_string(shots);
 
         if (maxBondDim != 0)
             config +=
@@ -110,10 +142,16 @@ struct MAESTRO_QDMI_Device_Job_impl_d
         return config;
     }
 
-    // very dumb json parser, but we know exactly what to expect
     void ParseResults(const std::string& res)
     {
         results.clear();
+        AddCounts(res, results);
+    }
+
+    // very dumb json parser, but we know exactly what to expect
+    // the counts are added to the ones already in the histogram
+    static void AddCounts(const std::string& res, std::map<std::string, size_t>& counts)
+    {
 		if (res.empty())
             return;
         
@@ -150,7 +188,7 @@ struct MAESTRO_QDMI_Device_Job_impl_d
                     ++pos;
                 }
                 if (!key.empty() && !value.empty()) {
-                    results[key] = static_cast<size_t>(std::stoull(value));
+                    counts[key] += static_cast<size_t>(std::stoull(value));
                 }
             } else {
                 ++pos;
@@ -158,10 +196,67 @@ struct MAESTRO_QDMI_Device_Job_impl_d
         }
     }
 
+    bool IsFinished() const
+    {
+        const QDMI_Job_Status current = status;
+
+        return current == QDMI_JOB_STATUS_DONE || current == QDMI_JOB_STATUS_FAILED ||
+               current == QDMI_JOB_STATUS_CANCELED;
+    }
+
+    // picks the outcomes requested by the top_k and min_count options, most frequent first
+    void SelectResults()
+    {
+        selected_results.clear();
+
+        for (const auto& result : results)
+            if (result.second >= options.min_count)
+                selected_results.emplace_back(result);
+
+        const auto byCount = [](const auto& a, const auto& b) {
+            return a.second > b.second || (a.second == b.second && a.first < b.first);
+        };
+
+        if (options.top_k != 0 && options.top_k < selected_results.size()) {
+            const auto kth = selected_results.begin() + static_cast<std::ptrdiff_t>(options.top_k);
+            std::nth_element(selected_results.begin(), kth - 1, selected_results.end(), byCount);
+            selected_results.erase(kth, selected_results.end());
+        }
+
+        std::sort(selected_results.begin(), selected_results.end(), byCount);
+    }
+
+    // frees the memory of the results and of the program, only the status is kept
+    void ReleaseResults()
+    {
+        std::map<std::string, size_t>().swap(results);
+        std::vector<std::pair<std::string, size_t>>().swap(selected_results);
+        std::vector<std::complex<double>>().swap(unitary);
+        std::vector<uint8_t>().swap(records);
+        program.reset();
+    }
+
+    // reports the job to the event loop of its session, if it asked for that
+    void NotifyFinished() const
+    {
+        if (notifier)
+            notifier->Notify(static_cast<size_t>(id));
+    }
+
+    ProgramFormat GetProgramFormat() const
+    {
+        if (format == QDMI_PROGRAM_FORMAT_CUSTOM1)
+            return ProgramFormat::Trotter;
+
+        return format == QDMI_PROGRAM_FORMAT_CUSTOM2 ? ProgramFormat::Overlap : ProgramFormat::Qasm;
+    }
+
     MAESTRO_QDMI_Device_Session session = nullptr;
     int id = 0;
     QDMI_Program_Format format = QDMI_PROGRAM_FORMAT_QASM2;
-    char* program = nullptr;
+    std::shared_ptr<const InternedProgram> program; // shared by all the jobs with the same text
+
+    std::shared_ptr<CompletionNotifier> notifier;
 
     std::atomic<QDMI_Job_Status> status{QDMI_JOB_STATUS_SUBMITTED};
     size_t num_shots = 1;
@@ -173,13 +268,54 @@ struct MAESTRO_QDMI_Device_Job_impl_d
                             // other value = whatever, auto if available
     size_t maxBondDim = 0;  // no limit
 
+    JobOptions options;
+    std::string options_text;
+
     std::map<std::string, size_t> results;
+    std::vector<std::pair<std::string, size_t>> selected_results;
+
+    // column major, only for the jobs with the unitary option
+    std::vector<std::complex<double>> unitary;
+
+    // |<psi1|psi2>|^2, only for the overlap jobs (program format CUSTOM2)
+    double fidelity = 0;
+
+    // the shadow snapshots for the jobs with the shadows option, see ShadowSimulator.hpp,
+    // the packed tableau for the ones with the tableau option, see StabilizerTableau.hpp,
+    // the exported state for the ones with the mps option, see MatrixProductState.hpp,
+    // the local observables as doubles for the ones with the observables option,
+    // or the expectation value and its truncation error bound as doubles for the ones
+    // with a Pauli observable, see PauliPropagator.hpp
+    std::vector<uint8_t> records;
+
+    // the following are guarded by the device mutex
+    // a finished job not accessed for the result time to live is reclaimed, its
+    // results are spilled to spill_path or dropped and only a tombstone remains
+    std::chrono::steady_clock::time_point last_used = std::chrono::steady_clock::now();
+    bool reclaimed = false;
+    std::string spill_path;
+
+    // the shared memory segment with the results, created when it's asked for
+    std::string shared_name;
+    size_t shared_size = 0;
+};
+
+/**
+ * @brief What happens with the submitted jobs when the device is finalized.
+ */
+enum class MAESTRO_QDMI_DEVICE_DRAIN_MODE : uint8_t
+{
+    INFLIGHT, // the running job is finished, the queued ones are canceled
+    ALL,      // all the queued jobs are executed before stopping
+    ABORT     // the queued jobs are canceled, the running one at the end of its current segment
 };
 
 struct MAESTRO_QDMI_Device_State
 {
     std::mutex simulator_mutex;
 
+    ProgramCache programs;
+
     std::atomic<QDMI_Device_Status> status{QDMI_DEVICE_STATUS_OFFLINE};
     std::atomic<int> job_id{0};
 
@@ -190,8 +326,38 @@ struct MAESTRO_QDMI_Device_State
     // this is for signalling the worker thread
     std::thread Thread;
     bool stop_thread{false};
+    std::atomic<bool> abort_running{false};
     std::condition_variable Condition;
 
+    // the noisy and the unitary jobs are executed on this many threads
+    std::atomic<size_t> workers{1};
+    // each of them with its own instance of the library
+    std::atomic<bool> isolate_workers{false};
+
+    // all the jobs that are not freed yet, to find the abandoned ones
+    std::unordered_set<MAESTRO_QDMI_Device_Job> all_jobs;
+
+    // the results of the finished jobs not accessed for this long are reclaimed, 0 - never
+    std::chrono::milliseconds result_ttl{0};
+    // the reclaimed results are spilled to files in this directory, if empty they are dropped
+    std::string spill_dir;
+    // keeps apart the files and the shared memory segments of the devices on the host
+    std::string instance_tag;
+    size_t reclaimed_jobs = 0;
+    size_t restored_jobs = 0;
+
+    // after being idle for this long the device releases its simulator, compacts its tables
+    // and returns the free heap memory to the system, 0 - never
+    std::chrono::milliseconds idle_timeout{0};
+    std::chrono::steady_clock::time_point last_busy = std::chrono::steady_clock::now();
+    bool idle_released = true; // there is nothing to release until a job runs
+    size_t idle_releases = 0;
+    size_t idle_released_bytes = 0;
+
+    size_t inline_jobs = 0; // run on the threads that submitted them, see RunInline
+    size_t inline_running = 0; // the ones still running, Stop waits for them
+    std::condition_variable ConditionInline;
+
     std::condition_variable ConditionWaiting;
     std::mutex MutexWaiting;
 
@@ -203,18 +369,20 @@ struct MAESTRO_QDMI_Device_State
 
     bool TerminateWait() const { return !jobs.empty() || stop_thread; }
 
+    // a running job stops at the end of its current segment if it's canceled or the device aborts
+    bool StopRunningJob()
+    {
+        std::lock_guard lock(simulator_mutex);
+
+        return current_job == nullptr || abort_running;
+    }
+
     void Notify() { Condition.notify_one(); }
 
     void Run()
     {
         SimpleSimulator simulator;
-        if (!simulator.Init(
-#if defined(_WIN32)
-		"maestro.dll"
-#else
-		"maestro.so"
-#endif
-		)) {
+        if (!simulator.Init(MAESTRO_QDMI_LIBRARY_NAME)) {
             std::unique_lock lock(simulator_mutex);
             status = QDMI_DEVICE_STATUS_OFFLINE;
             return;
@@ -222,10 +390,19 @@ struct MAESTRO_QDMI_Device_State
 
         for (;;) {
             std::unique_lock lock(simulator_mutex);
-            if (!TerminateWait())
-                Condition.wait(lock, [this] { return TerminateWait(); });
+            if (!TerminateWait()) {
+                const std::chrono::milliseconds timeout = GetWaitTimeout();
+                if (timeout.count() == 0)
+                    Condition.wait(lock, [this] { return TerminateWait(); });
+                else
+                    Condition.wait_for(lock, timeout, [this] { return TerminateWait(); });
+            }
+            ReclaimExpired();
+            if (jobs.empty() && !stop_thread)
+                ReleaseIdle(simulator, lock);
 
-            while (!jobs.empty() && !stop_thread) {
+            // the queue is emptied by Stop() unless all the jobs should be drained
+            while (!jobs.empty()) {
                 status = QDMI_DEVICE_STATUS_BUSY;
 
                 // remove the job from the queue
@@ -238,63 +415,314 @@ struct MAESTRO_QDMI_Device_State
                 current_job->status = QDMI_JOB_STATUS_RUNNING;
 
                 // execute the job
-                const std::string config = current_job->GetConfigJson();
-                const std::string program = current_job->program;
+                // keeps the interned program alive even if the job is freed while running
+                const std::shared_ptr<const InternedProgram> interned = current_job->program;
+
+                const size_t num_shots = current_job->num_shots;
+                const size_t segment_shots = current_job->options.segment_shots != 0
+                                                 ? current_job->options.segment_shots
+                                                 : num_shots;
+                const size_t maxBondDim = current_job->maxBondDim;
 
                 const size_t qubits_num = current_job->qubits_num;
                 const size_t simType = current_job->simType;
                 const size_t simExecType = current_job->simExecType;
+                const bool transpile = current_job->options.transpile;
+                // the library runs only OpenQASM 2.0, anything else goes through the front end
+                const bool translate = current_job->format != QDMI_PROGRAM_FORMAT_QASM2;
+                const NoiseModel noise = current_job->options.noise;
+                const size_t trajectories = current_job->options.trajectories;
+                const bool use_trajectories = current_job->options.UsesTrajectories();
+                const bool compute_unitary = current_job->options.unitary;
+                const bool overlap = current_job->GetProgramFormat() == ProgramFormat::Overlap;
+                // every variant runs all the shots, see VariantGenerator.hpp
+                const size_t variants = current_job->options.variants;
+                const VariantMode variant_mode = current_job->options.variant_mode;
+                const uint64_t variant_seed =
+                    current_job->options.variant_seed != 0 || variants == 0
+                        ? current_job->options.variant_seed
+                        : std::random_device{}();
+                const bool per_variant = current_job->options.per_variant;
+                const size_t shadows = current_job->options.shadows;
+                const uint64_t shadow_seed = current_job->options.shadow_seed != 0 || shadows == 0
+                                                 ? current_job->options.shadow_seed
+                                                 : std::random_device{}();
+                const bool tableau = current_job->options.tableau;
+                const bool mps = current_job->options.mps;
+                const std::string mps_initial = current_job->options.mps_initial;
+                const bool observables = current_job->options.observables;
+                const std::string pauli_observable = current_job->options.pauli_observable;
+                const size_t pauli_max_weight = current_job->options.pauli_max_weight;
+                const double pauli_threshold = current_job->options.pauli_threshold;
+                // the options that replace the sampling exclude each other and the overlap
+                const bool conflicting =
+                    current_job->options.GetResultModes() + static_cast<size_t>(overlap) > 1 ||
+                    (!mps_initial.empty() && !mps && !observables);
 
                 lock.unlock();
 
-                simulator.CreateSimpleSimulator(static_cast<int>(qubits_num));
-
-                if (simType < 2) // qcsim or aer
-                {
-					if (simExecType < 4 || (simType == 1 && simExecType == 4)) // qcsim also supports pauli propagation
-                        simulator.RemoveAllOptimizationSimulatorsAndAdd(
-                            static_cast<int>(simType), static_cast<int>(simExecType));
-                    else {
-                        simulator.RemoveAllOptimizationSimulatorsAndAdd(static_cast<int>(simType),
-                                                                        0);
-                        simulator.AddOptimizationSimulator(static_cast<int>(simType), 1);
-                        simulator.AddOptimizationSimulator(static_cast<int>(simType), 2);
+                std::map<std::string, size_t> counts;
+                std::vector<std::complex<double>> unitary;
+                double fidelity = 0;
+                std::vector<uint8_t> records;
+                bool failed = false;
+                bool aborted = false;
+
+                if (conflicting)
+                    failed = true;
+                else if (overlap) {
+                    // both states stay in one simulator, the shots are not used
+                    const Circuit* circuit = interned ? interned->GetCircuit() : nullptr;
+                    failed = circuit == nullptr || !noise.IsNoiseless();
+                    if (!failed) {
+                        const BackendSelection backend =
+                            BackendRegistry::Get().SelectGateApi(simType, simExecType, false);
+
+                        FidelitySimulator::Config config;
+                        config.library = MAESTRO_QDMI_LIBRARY_NAME;
+                        config.simType = backend.GetSimulatorType();
+                        config.simExecType = backend.GetExecutionType();
+                        config.maxBondDim = maxBondDim;
+                        config.isolated = isolate_workers;
+
+                        const SimulationResult result = FidelitySimulator::Run(
+                            *circuit, config, fidelity, [this] { return StopRunningJob(); });
+                        failed = result == SimulationResult::Failed;
+                        aborted = result == SimulationResult::Stopped;
+                    }
+                } else if (compute_unitary) {
+                    // the columns are simulated in parallel, noise has no unitary
+                    const Circuit* circuit = interned ? interned->GetCircuit() : nullptr;
+                    failed = circuit == nullptr || !noise.IsNoiseless();
+                    if (!failed) {
+                        const BackendSelection backend =
+                            BackendRegistry::Get().SelectGateApi(simType, 0);
+
+                        UnitarySimulator::Config config;
+                        config.library = MAESTRO_QDMI_LIBRARY_NAME;
+                        config.simType = backend.GetSimulatorType();
+                        config.workers = workers;
+                        config.isolated = isolate_workers;
+
+                        const SimulationResult result = UnitarySimulator::Run(
+                            *circuit, config, unitary, [this] { return StopRunningJob(); });
+                        failed = result == SimulationResult::Failed;
+                        aborted = result == SimulationResult::Stopped;
+                    }
+                } else if (shadows != 0) {
+                    // the snapshots are spread over the workers, the shots are not used
+                    const Circuit* circuit = interned ? interned->GetCircuit() : nullptr;
+                    failed = circuit == nullptr || !noise.IsNoiseless() ||
+                             !ShadowSimulator::IsSupported(*circuit);
+                    if (!failed) {
+                        const BackendSelection backend =
+                            BackendRegistry::Get().SelectGateApi(simType, simExecType, false);
+
+                        ShadowSimulator::Config config;
+                        config.library = MAESTRO_QDMI_LIBRARY_NAME;
+                        config.simType = backend.GetSimulatorType();
+                        config.simExecType = backend.GetExecutionType();
+                        config.maxBondDim = maxBondDim;
+                        config.workers = workers;
+                        config.isolated = isolate_workers;
+                        config.seed = shadow_seed;
+
+                        const SimulationResult result =
+                            ShadowSimulator::Run(*circuit, shadows, config, records,
+                                                 [this] { return StopRunningJob(); });
+                        failed = result == SimulationResult::Failed;
+                        aborted = result == SimulationResult::Stopped;
+                    }
+                } else if (tableau) {
+                    // tracked on the device, the library does not expose the tableau
+                    const Circuit* circuit = interned ? interned->GetCircuit() : nullptr;
+                    failed = circuit == nullptr || !noise.IsNoiseless();
+                    if (!failed) {
+                        StabilizerTableau stabilizers;
+                        const SimulationResult result = StabilizerTableau::Run(
+                            *circuit, stabilizers, [this] { return StopRunningJob(); });
+                        failed = result == SimulationResult::Failed;
+                        aborted = result == SimulationResult::Stopped;
+                        if (result == SimulationResult::Done)
+                            records = stabilizers.Pack();
                     }
-                } else if (simType < 4) // composite, ignore exec type and set statevector
-                {
-                    simulator.RemoveAllOptimizationSimulatorsAndAdd(static_cast<int>(simType), 0);
-                } else if (simType == 4) // gpu
-                {
-                    if (simExecType < 2 || simExecType == 3 || simExecType == 4) // statevector, mps, tensor network or pauli propagation
+                } else if (mps || observables) {
+                    // evolved on the device, the library does not expose its tensors
+                    const Circuit* circuit = interned ? interned->GetCircuit() : nullptr;
+                    MatrixProductState state(0, maxBondDim);
+                    failed = circuit == nullptr || !noise.IsNoiseless() ||
+                             (!mps_initial.empty() && !state.Load(mps_initial));
+                    if (!failed) {
+                        const SimulationResult result = MatrixProductState::Run(
+                            *circuit, state, [this] { return StopRunningJob(); });
+                        failed = result == SimulationResult::Failed;
+                        aborted = result == SimulationResult::Stopped;
+                        if (result == SimulationResult::Done && observables) {
+                            // the Bloch vectors followed by the correlation matrix
+                            std::vector<double> bloch;
+                            std::vector<double> zz;
+                            state.GetLocalObservables(bloch, zz);
+                            bloch.insert(bloch.end(), zz.begin(), zz.end());
+                            records.resize(bloch.size() * sizeof(double));
+                            std::memcpy(records.data(), bloch.data(), records.size());
+                        } else if (result == SimulationResult::Done)
+                            records = state.Export();
+                    }
+                } else if (!pauli_observable.empty()) {
+                    // propagated on the device, the library has no observables
+                    const Circuit* circuit = interned ? interned->GetCircuit() : nullptr;
+                    PauliPropagator propagator(pauli_max_weight, pauli_threshold);
+                    failed = circuit == nullptr || !noise.IsNoiseless() ||
+                             !propagator.SetObservable(pauli_observable, circuit->nrQubits);
+                    if (!failed) {
+                        const SimulationResult result =
+                            propagator.Run(*circuit, [this] { return StopRunningJob(); });
+                        failed = result == SimulationResult::Failed;
+                        aborted = result == SimulationResult::Stopped;
+                        if (result == SimulationResult::Done) {
+                            const double values[] = {propagator.GetExpectation(),
+                                                     propagator.GetTruncationError()};
+                            records.resize(sizeof(values));
+                            std::memcpy(records.data(), values, sizeof(values));
+                        }
+                    }
+                } else if (use_trajectories) {
+                    // noisy jobs run on the gate API, in trajectories spread over the workers
+                    const Circuit* circuit = interned ? interned->GetCircuit() : nullptr;
+                    failed = circuit == nullptr;
+                    if (circuit) {
+                        // the decay of amplitude damping is not a Clifford operation
+                        const BackendSelection backend = BackendRegistry::Get().SelectGateApi(
+                            simType, simExecType, !noise.HasAmplitudeDamping());
+
+                        TrajectorySimulator::Config config;
+                        config.library = MAESTRO_QDMI_LIBRARY_NAME;
+                        config.simType = backend.GetSimulatorType();
+                        config.simExecType = backend.GetExecutionType();
+                        config.maxBondDim = maxBondDim;
+                        config.workers = workers;
+                        config.isolated = isolate_workers;
+                        config.trajectories = trajectories;
+                        // the keys are shaped like the ones of the library
+                        config.keyLength = qubits_num;
+
+                        for (size_t v = 0; v < std::max<size_t>(1, variants); ++v) {
+                            config.seed = std::random_device{}();
+
+                            std::map<std::string, size_t> variant_counts;
+                            const SimulationResult result =
+                                variants == 0
+                                    ? TrajectorySimulator::Run(*circuit, noise, num_shots, config,
+                                                               counts,
+                                                               [this] { return StopRunningJob(); })
+                                    : TrajectorySimulator::Run(
+                                          VariantGenerator::Generate(*circuit, variant_mode, v,
+                                                                     variant_seed),
+                                          noise, num_shots, config, variant_counts,
+                                          [this] { return StopRunningJob(); });
+                            VariantGenerator::AddCounts(variant_counts, v, per_variant, counts);
+
+                            failed = result == SimulationResult::Failed;
+                            aborted = result == SimulationResult::Stopped;
+                            if (failed || aborted)
+                                break;
+                        }
+                    }
+                } else {
+                    const BackendSelection backend =
+                        BackendRegistry::Get().Select(simType, simExecType);
+
+                    // the rewritten program is cached with the interned one for the next jobs
+                    const TranspileTarget target =
+                        transpile ? backend.target : TranspileTarget::None;
+                    static const std::string no_program;
+                    const std::string& program =
+                        interned ? interned->GetTranspiled(target, translate) : no_program;
+
+                    simulator.CreateSimpleSimulator(static_cast<int>(qubits_num));
+
+                    // unknown simulator types are left to the library to choose
+                    if (backend.backend) {
+                        const int type = backend.GetSimulatorType();
                         simulator.RemoveAllOptimizationSimulatorsAndAdd(
-                            static_cast<int>(simType), static_cast<int>(simExecType));
-                    else // other types are not supported yet on gpu, set statevector
-                        simulator.RemoveAllOptimizationSimulatorsAndAdd(static_cast<int>(simType),
-                                                                        0);
-                } else if (simType == 5) // quest
-                {
-					// only statevector for now
-                    simulator.RemoveAllOptimizationSimulatorsAndAdd(static_cast<int>(simType), 0);
-				}
-
-                std::string result;
-                if (!program.empty()) {
-                    // std::cerr << "Executing program:\n" << program << "\nWith config:\n" <<
-                    // config << "\n";
-                    char* res = simulator.SimpleExecute(program.c_str(), config.c_str());
-                    if (res) {
-                        result = res;
-                        simulator.FreeResult(res);
+                            type, static_cast<int>(backend.execTypes.front()));
+                        for (size_t i = 1; i < backend.execTypes.size(); ++i)
+                            simulator.AddOptimizationSimulator(
+                                type, static_cast<int>(backend.execTypes[i]));
+                    }
+
+                    // the variants are generated from the parsed program
+                    const Circuit* base =
+                        variants != 0 && interned ? interned->GetCircuit() : nullptr;
+
+                    failed = program.empty() || (variants != 0 && base == nullptr);
+                    // the program is parsed for the check only if the backend has a limit
+                    if (!failed && backend.backend && backend.backend->maxQubits != 0) {
+                        const Circuit* circuit = interned->GetCircuit();
+                        failed = !backend.FitsQubits(circuit ? circuit->nrQubits : qubits_num);
+                    }
+
+                    for (size_t v = 0; !failed && !aborted && v < std::max<size_t>(1, variants);
+                         ++v) {
+                        const std::string variant =
+                            base ? Transpiler::Transpile(VariantGenerator::Generate(
+                                                             *base, variant_mode, v, variant_seed),
+                                                         target)
+                                       .ToQasm()
+                                 : std::string();
+                        const std::string& run = base ? variant : program;
+                        std::map<std::string, size_t> variant_counts;
+
+                        // the shots are executed in segments, the job can be stopped in between
+                        for (size_t done = 0; !failed && done < num_shots;
+                             done += segment_shots) {
+                            if ((done != 0 || v != 0) && StopRunningJob()) {
+                                aborted = true;
+                                break;
+                            }
+
+                            const std::string config =
+                                MAESTRO_QDMI_Device_Job_impl_d::GetConfigJson(
+                                    std::min(segment_shots, num_shots - done), maxBondDim);
+
+                            // std::cerr << "Executing program:\n" << run << "\nWith config:\n"
+                            // << config << "\n";
+                            std::string result;
+                            char* res = simulator.SimpleExecute(run.c_str(), config.c_str());
+                            if (res) {
+                                result = res;
+                                simulator.FreeResult(res);
+                            }
+
+                            failed = result.empty();
+                            MAESTRO_QDMI_Device_Job_impl_d::AddCounts(
+                                result, base ? variant_counts : counts);
+                        }
+
+                        VariantGenerator::AddCounts(variant_counts, v, per_variant, counts);
                     }
                 }
 
                 lock.lock();
                 // if it's not deleted while running
                 if (current_job) {
-                    current_job->ParseResults(result);
-                    current_job->status = result.empty() ? QDMI_JOB_STATUS_FAILED : QDMI_JOB_STATUS_DONE;
+                    if (aborted)
+                        current_job->status = QDMI_JOB_STATUS_CANCELED;
+                    else {
+                        current_job->results = std::move(counts);
+                        current_job->unitary = std::move(unitary);
+                        current_job->fidelity = fidelity;
+                        current_job->records = std::move(records);
+                        current_job->SelectResults();
+                        current_job->status = failed ? QDMI_JOB_STATUS_FAILED : QDMI_JOB_STATUS_DONE;
+                    }
+                    current_job->last_used = std::chrono::steady_clock::now();
+                    current_job->NotifyFinished();
                     current_job = nullptr;
                 }
+                last_busy = std::chrono::steady_clock::now();
+                idle_released = false;
+                ReclaimExpired();
 
                 if (jobs.empty())
                     status = QDMI_DEVICE_STATUS_IDLE;
@@ -318,12 +746,13 @@ struct MAESTRO_QDMI_Device_State
         {
             std::lock_guard lock(simulator_mutex);
             stop_thread = false;
+            abort_running = false;
             status = QDMI_DEVICE_STATUS_IDLE;
         }
         Thread = std::thread(&MAESTRO_QDMI_Device_State::Run, this);
     }
 
-    void Stop()
+    void Stop(MAESTRO_QDMI_DEVICE_DRAIN_MODE mode = MAESTRO_QDMI_DEVICE_DRAIN_MODE::INFLIGHT)
     {
         if (!Thread.joinable())
             return;
@@ -331,40 +760,349 @@ struct MAESTRO_QDMI_Device_State
         {
             std::lock_guard lock(simulator_mutex);
 
+            // there is no journal to hand the queued jobs over to, so they are canceled
+            if (mode != MAESTRO_QDMI_DEVICE_DRAIN_MODE::ALL) {
+                for (auto& [id, job] : jobs) {
+                    job->status = QDMI_JOB_STATUS_CANCELED;
+                    job->NotifyFinished();
+                }
+                jobs.clear();
+            }
+
+            abort_running = mode == MAESTRO_QDMI_DEVICE_DRAIN_MODE::ABORT;
             stop_thread = true;
         }
 
         Notify();
+        ConditionWaiting.notify_all();
         Join();
+
+        // the jobs run on the submitting threads are short, they are not interrupted
+        {
+            std::unique_lock lock(simulator_mutex);
+            ConditionInline.wait(lock, [this] { return inline_running == 0; });
+        }
         status = QDMI_DEVICE_STATUS_OFFLINE;
     }
 
-    void CancelJob(MAESTRO_QDMI_Device_Job job)
+    void CancelJob(MAESTRO_QDMI_Device_Job job, bool notify = true)
     {
         std::lock_guard<std::mutex> lock(simulator_mutex);
         auto it = jobs.find(job->id);
         if (it != jobs.end())
             jobs.erase(it);
 
+        const bool finished = job->IsFinished();
         job->status = QDMI_JOB_STATUS_CANCELED;
+        job->last_used = std::chrono::steady_clock::now();
+        if (notify && !finished)
+            job->NotifyFinished();
 
         if (current_job == job)
             current_job = nullptr;
     }
 
+    void RegisterJob(MAESTRO_QDMI_Device_Job job)
+    {
+        std::lock_guard<std::mutex> lock(simulator_mutex);
+        all_jobs.insert(job);
+    }
+
     void RemoveJob(MAESTRO_QDMI_Device_Job job)
     {
-        CancelJob(job);
+        // the client knows about the freed job, it's not reported as finished
+        CancelJob(job, false);
+
+        {
+            std::lock_guard<std::mutex> lock(simulator_mutex);
+            all_jobs.erase(job);
+            if (!job->spill_path.empty())
+                std::remove(job->spill_path.c_str());
+            RemoveExport(job);
+        }
 
         delete job;
     }
 
-    void AddJob(MAESTRO_QDMI_Device_Job job)
+    /**
+     * @brief Runs a small sampling job on the calling thread, false if it has to be queued.
+     * @details Only noiseless jobs without variants, segments or other results qualify, the
+     * ones with the inline_qubits option and at most that many qubits. Each thread keeps its
+     * own simple simulator and reuses it while the qubits and the backend stay the same.
+     * Never with isolated workers, see MAESTRO_DEVICE_ISOLATE. Stop waits for the running ones.
+     */
+    bool RunInline(MAESTRO_QDMI_Device_Job job)
+    {
+        // an isolated library is not safe to share with the client threads
+        const JobOptions& options = job->options;
+        if (isolate_workers || options.inline_qubits == 0 || !job->program ||
+            options.GetResultModes() != 0 || options.UsesTrajectories() ||
+            options.variants != 0 || options.segment_shots != 0 ||
+            job->GetProgramFormat() == ProgramFormat::Overlap)
+            return false;
+
+        const Circuit* circuit = job->program->GetCircuit();
+        if (circuit == nullptr || circuit->nrQubits > options.inline_qubits)
+            return false;
+
+        const BackendSelection backend =
+            BackendRegistry::Get().Select(job->simType, job->simExecType);
+        if (backend.backend && !backend.FitsQubits(circuit->nrQubits))
+            return false;
+
+        struct WarmSimulator
+        {
+            SimpleSimulator simulator;
+            bool initialized = false;
+            bool created = false;
+            size_t qubits = 0;
+            const Backend* backend = nullptr;
+            std::vector<ExecutionType> execTypes;
+        };
+        thread_local WarmSimulator warm;
+
+        if (!warm.initialized) {
+            if (!warm.simulator.Init(MAESTRO_QDMI_LIBRARY_NAME))
+                return false;
+            warm.initialized = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(simulator_mutex);
+            if (job->reclaimed || stop_thread || status == QDMI_DEVICE_STATUS_OFFLINE ||
+                job == current_job || jobs.count(job->id) != 0)
+                return false;
+            job->status = QDMI_JOB_STATUS_RUNNING;
+            ++inline_running;
+        }
+
+        if (!warm.created || warm.qubits != job->qubits_num || warm.backend != backend.backend ||
+            warm.execTypes != backend.execTypes) {
+            warm.created =
+                warm.simulator.CreateSimpleSimulator(static_cast<int>(job->qubits_num)) != 0;
+            if (warm.created && backend.backend) {
+                const int type = backend.GetSimulatorType();
+                warm.simulator.RemoveAllOptimizationSimulatorsAndAdd(
+                    type, static_cast<int>(backend.execTypes.front()));
+                for (size_t i = 1; i < backend.execTypes.size(); ++i)
+                    warm.simulator.AddOptimizationSimulator(type,
+                                                            static_cast<int>(backend.execTypes[i]));
+            }
+            warm.qubits = job->qubits_num;
+            warm.backend = backend.backend;
+            warm.execTypes = backend.execTypes;
+        }
+
+        const TranspileTarget target = options.transpile ? backend.target : TranspileTarget::None;
+        const std::string& program =
+            job->program->GetTranspiled(target, job->format != QDMI_PROGRAM_FORMAT_QASM2);
+        const std::string config =
+            MAESTRO_QDMI_Device_Job_impl_d::GetConfigJson(job->num_shots, job->maxBondDim);
+
+        // the job fails without a simulator, the next one tries to create it again
+        std::string result;
+        if (warm.created && !program.empty()) {
+            char* res = warm.simulator.SimpleExecute(program.c_str(), config.c_str());
+            if (res) {
+                result = res;
+                warm.simulator.FreeResult(res);
+            }
+        }
+
+        std::map<std::string, size_t> counts;
+        MAESTRO_QDMI_Device_Job_impl_d::AddCounts(result, counts);
+
+        {
+            std::lock_guard<std::mutex> lock(simulator_mutex);
+            // a job canceled meanwhile stays canceled
+            if (job->status == QDMI_JOB_STATUS_RUNNING) {
+                job->results = std::move(counts);
+                job->SelectResults();
+                job->status = result.empty() ? QDMI_JOB_STATUS_FAILED : QDMI_JOB_STATUS_DONE;
+                job->NotifyFinished();
+            }
+            job->last_used = std::chrono::steady_clock::now();
+            ++inline_jobs;
+            --inline_running;
+        }
+        ConditionWaiting.notify_all();
+        ConditionInline.notify_all();
+
+        return true;
+    }
+
+    // a reclaimed job has lost its program, it cannot be submitted again
+    bool AddJob(MAESTRO_QDMI_Device_Job job)
     {
         std::lock_guard<std::mutex> lock(simulator_mutex);
+        if (job->reclaimed)
+            return false;
+
         jobs[job->id] = job;
         job->status = QDMI_JOB_STATUS_QUEUED;
         Notify();
+
+        return true;
+    }
+
+    // the expired jobs are looked for at least this often while the device is idle
+    std::chrono::milliseconds GetReclaimInterval() const
+    {
+        return std::clamp<std::chrono::milliseconds>(result_ttl / 2, std::chrono::milliseconds(10),
+                                                     std::chrono::seconds(10));
+    }
+
+    // how long the worker can sleep before it has something to reclaim, 0 - until woken up
+    std::chrono::milliseconds GetWaitTimeout() const
+    {
+        std::chrono::milliseconds timeout{0};
+        if (result_ttl.count() != 0)
+            timeout = GetReclaimInterval();
+
+        if (idle_timeout.count() != 0 && !idle_released) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                last_busy + idle_timeout - std::chrono::steady_clock::now());
+            const auto idle = std::max(std::chrono::milliseconds(1), left);
+            timeout = timeout.count() == 0 ? idle : std::min(timeout, idle);
+        }
+
+        return timeout;
+    }
+
+    // called by the worker with the lock held, the lock is released while the memory is trimmed
+    void ReleaseIdle(SimpleSimulator& simulator, std::unique_lock<std::mutex>& lock)
+    {
+        if (idle_timeout.count() == 0 || idle_released ||
+            std::chrono::steady_clock::now() - last_busy < idle_timeout)
+            return;
+
+        idle_released = true;
+        ++idle_releases;
+
+        const size_t before = MemoryUsage::GetResidentBytes();
+
+        // the simulator is made anew for each job anyway
+        simulator.Release();
+        all_jobs.rehash(0);
+
+        lock.unlock();
+        programs.Compact();
+        MemoryUsage::Trim();
+        const size_t after = MemoryUsage::GetResidentBytes();
+        lock.lock();
+
+        if (after < before)
+            idle_released_bytes += before - after;
+    }
+
+    // with the lock held, turns the finished jobs not accessed for result_ttl into tombstones
+    void ReclaimExpired()
+    {
+        if (result_ttl.count() == 0)
+            return;
+
+        const auto now = std::chrono::steady_clock::now();
+        for (const auto job : all_jobs) {
+            if (job->reclaimed || job == current_job || !job->IsFinished() ||
+                now - job->last_used < result_ttl)
+                continue;
+
+            if (!spill_dir.empty() && job->status == QDMI_JOB_STATUS_DONE) {
+                const std::string path =
+                    spill_dir + "/" + instance_tag + "_" + std::to_string(job->id) + ".results";
+                if (ResultSpill::Write(path, job->results, job->selected_results, job->unitary,
+                                       job->records))
+                    job->spill_path = path;
+            }
+
+            RemoveExport(job);
+            job->ReleaseResults();
+            job->reclaimed = true;
+            ++reclaimed_jobs;
+        }
+    }
+
+    // with the lock held, reads back the results of a reclaimed job, false if they were dropped
+    bool RestoreJob(MAESTRO_QDMI_Device_Job job)
+    {
+        job->last_used = std::chrono::steady_clock::now();
+        if (!job->reclaimed)
+            return true;
+
+        if (job->spill_path.empty() ||
+            !ResultSpill::Read(job->spill_path, job->results, job->selected_results, job->unitary,
+                               job->records))
+            return false;
+
+        std::remove(job->spill_path.c_str());
+        job->spill_path.clear();
+        job->reclaimed = false;
+        ++restored_jobs;
+
+        return true;
+    }
+
+    // with the lock held, puts the results of the job into shared memory once,
+    // returns the name and the size of the segment or an empty string if it failed
+    std::string ExportJob(MAESTRO_QDMI_Device_Job job)
+    {
+        // the keys with the variant prefix are not bit strings, see VariantGenerator.hpp
+        if (job->options.per_variant && job->options.variants != 0)
+            return {};
+
+        if (job->shared_name.empty()) {
+            const std::string name = "/" + instance_tag + "_" + std::to_string(job->id);
+            const size_t size = SharedResult::Create(name, job->results, job->unitary);
+            if (size == 0)
+                return {};
+
+            job->shared_name = name;
+            job->shared_size = size;
+        }
+
+        return job->shared_name + " " + std::to_string(job->shared_size);
+    }
+
+    // with the lock held, the processes that mapped the segment keep it
+    static void RemoveExport(MAESTRO_QDMI_Device_Job job)
+    {
+        if (job->shared_name.empty())
+            return;
+
+        SharedResult::Remove(job->shared_name);
+        job->shared_name.clear();
+        job->shared_size = 0;
+    }
+
+    std::string GetMetrics()
+    {
+        std::lock_guard<std::mutex> lock(simulator_mutex);
+
+        size_t finished = 0;
+        size_t tombstones = 0;
+        size_t spilled = 0;
+        size_t result_bytes = 0;
+        for (const auto job : all_jobs) {
+            if (job->IsFinished())
+                ++finished;
+            if (job->reclaimed)
+                ++tombstones;
+            if (!job->spill_path.empty())
+                ++spilled;
+            result_bytes += ResultSpill::GetMemoryUsage(job->results, job->selected_results,
+                                                        job->unitary, job->records);
+        }
+
+        return "jobs=" + std::to_string(all_jobs.size()) + " queued=" + std::to_string(jobs.size()) +
+               " finished=" + std::to_string(finished) + " tombstones=" +
+               std::to_string(tombstones) + " spilled=" + std::to_string(spilled) +
+               " result_bytes=" + std::to_string(result_bytes) +
+               " programs=" + std::to_string(programs.Size()) +
+               " reclaimed_total=" + std::to_string(reclaimed_jobs) +
+               " restored_total=" + std::to_string(restored_jobs) +
+               " idle_releases=" + std::to_string(idle_releases) +
+               " idle_released_bytes=" + std::to_string(idle_released_bytes) +
+               " inline_total=" + std::to_string(inline_jobs);
     }
 
     void WaitForJobFinish(MAESTRO_QDMI_Device_Job job, size_t timeout)
@@ -373,7 +1111,7 @@ struct MAESTRO_QDMI_Device_State
         std::unique_lock<std::mutex> lock(MutexWaiting);
 
         ConditionWaiting.wait_for(lock, std::chrono::milliseconds(timeout),
-                                  [this, job] { return job->status == QDMI_JOB_STATUS_DONE; });
+                                  [job] { return job->IsFinished(); });
     }
 };
 
@@ -396,16 +1134,15 @@ struct MAESTRO_QDMI_Operation_impl_d
 };
 
 namespace {
-int MAESTRO_QDMI_device_job_get_results_hist(MAESTRO_QDMI_Device_Job job,
-                                             const QDMI_Job_Result result, const size_t size,
-                                             void* data, size_t* size_ret)
+template <class Histogram>
+int MAESTRO_QDMI_device_write_hist(const Histogram& hist, const bool keys, const size_t size,
+                                   void* data, size_t* size_ret)
 {
-    const auto& hist = job->results;
-
-    if (result == QDMI_JOB_RESULT_HIST_KEYS) {
+    if (keys) {
         const size_t bitstring_size = hist.empty() ? 0 : hist.begin()->first.length();
 
-        const size_t req_size = hist.size() * (bitstring_size + 1);
+        // an empty histogram still needs room for the null terminator
+        const size_t req_size = hist.empty() ? 1 : hist.size() * (bitstring_size + 1);
         if (size_ret != nullptr) {
             *size_ret = req_size;
         }
@@ -414,6 +1151,10 @@ int MAESTRO_QDMI_device_job_get_results_hist(MAESTRO_QDMI_Device_Job job,
                 return QDMI_ERROR_INVALIDARGUMENT;
             }
             char* data_ptr = static_cast<char*>(data);
+            if (hist.empty()) {
+                *data_ptr = '\0';
+                return QDMI_SUCCESS;
+            }
             for (const auto& [bitstring, count] : hist) {
                 std::copy(bitstring.begin(), bitstring.end(), data_ptr);
                 data_ptr += bitstring.length();
@@ -422,7 +1163,6 @@ int MAESTRO_QDMI_device_job_get_results_hist(MAESTRO_QDMI_Device_Job job,
             *(data_ptr - 1) = '\0'; // Replace last comma with null terminator
         }
     } else {
-        // case QDMI_JOB_RESULT_HIST_VALUES:
         const size_t req_size = hist.size() * sizeof(size_t);
         if (size_ret != nullptr) {
             *size_ret = req_size;
@@ -438,8 +1178,79 @@ int MAESTRO_QDMI_device_job_get_results_hist(MAESTRO_QDMI_Device_Job job,
         }
     }
     return QDMI_SUCCESS;
+}
+
+template <class Value>
+int MAESTRO_QDMI_device_write_buffer(const std::vector<Value>& buffer, const size_t size,
+                                     void* data, size_t* size_ret)
+{
+    const size_t req_size = buffer.size() * sizeof(Value);
+    if (size_ret != nullptr) {
+        *size_ret = req_size;
+    }
+    if (data != nullptr) {
+        if (size < req_size) {
+            return QDMI_ERROR_INVALIDARGUMENT;
+        }
+        std::memcpy(data, buffer.data(), req_size);
+    }
+    return QDMI_SUCCESS;
+}
+
+int MAESTRO_QDMI_device_write_string(const std::string& text, const size_t size, void* data,
+                                     size_t* size_ret)
+{
+    const size_t req_size = text.length() + 1;
+    if (size_ret != nullptr) {
+        *size_ret = req_size;
+    }
+    if (data != nullptr) {
+        if (size < req_size) {
+            return QDMI_ERROR_INVALIDARGUMENT;
+        }
+        std::memcpy(data, text.c_str(), req_size);
+    }
+    return QDMI_SUCCESS;
+}
+
+int MAESTRO_QDMI_device_job_get_results_hist(MAESTRO_QDMI_Device_Job job,
+                                             const QDMI_Job_Result result, const size_t size,
+                                             void* data, size_t* size_ret)
+{
+    switch (result) {
+    case QDMI_JOB_RESULT_HIST_KEYS:
+        return MAESTRO_QDMI_device_write_hist(job->results, true, size, data, size_ret);
+    case QDMI_JOB_RESULT_HIST_VALUES:
+        return MAESTRO_QDMI_device_write_hist(job->results, false, size, data, size_ret);
+    // the outcomes selected with the top_k and min_count options, most frequent first
+    case QDMI_JOB_RESULT_CUSTOM1:
+        return MAESTRO_QDMI_device_write_hist(job->selected_results, true, size, data, size_ret);
+    default:
+        // case QDMI_JOB_RESULT_CUSTOM2:
+        return MAESTRO_QDMI_device_write_hist(job->selected_results, false, size, data,
+                                              size_ret);
+    }
 } /// [DOXYGEN FUNCTION END]
 
+/**
+ * @brief Local function to translate a job options error into a QDMI error code.
+ * @note This function is considered private and should not be used outside of
+ * this file. Hence, it is not part of any header file.
+ */
+int MAESTRO_QDMI_options_error_code(JobOptionsError err)
+{
+    switch (err) {
+    case JobOptionsError::None:
+        return QDMI_SUCCESS;
+    case JobOptionsError::UnknownKey:
+        return QDMI_ERROR_NOTSUPPORTED;
+    default:
+        break;
+    }
+
+    return QDMI_ERROR_INVALIDARGUMENT;
+}
+
 /**
  * @brief Static function to maintain the device state.
  * @return a pointer to the device state.
@@ -466,6 +1277,118 @@ QDMI_Device_Status MAESTRO_QDMI_get_device_status()
     return status;
 }
 
+/**
+ * @brief Local function to read how the jobs are drained when the device is finalized.
+ * @details Set with the MAESTRO_DEVICE_DRAIN environment variable to `inflight` (default),
+ * `all` or `abort`.
+ * @note This function is considered private and should not be used outside of
+ * this file. Hence, it is not part of any header file.
+ */
+MAESTRO_QDMI_DEVICE_DRAIN_MODE MAESTRO_QDMI_get_drain_mode()
+{
+    const char* mode = std::getenv("MAESTRO_DEVICE_DRAIN");
+    if (mode != nullptr) {
+        if (std::strcmp(mode, "all") == 0)
+            return MAESTRO_QDMI_DEVICE_DRAIN_MODE::ALL;
+        if (std::strcmp(mode, "abort") == 0)
+            return MAESTRO_QDMI_DEVICE_DRAIN_MODE::ABORT;
+    }
+
+    return MAESTRO_QDMI_DEVICE_DRAIN_MODE::INFLIGHT;
+}
+
+/**
+ * @brief Local function to read the number of workers for the noisy and the unitary jobs.
+ * @details Set with the MAESTRO_DEVICE_WORKERS environment variable, by default
+ * all the hardware threads are used.
+ * @note This function is considered private and should not be used outside of
+ * this file. Hence, it is not part of any header file.
+ */
+size_t MAESTRO_QDMI_get_worker_count()
+{
+    const char* workers = std::getenv("MAESTRO_DEVICE_WORKERS");
+    if (workers != nullptr) {
+        char* end = nullptr;
+        const unsigned long long int count = std::strtoull(workers, &end, 10);
+        if (end != workers && *end == '\0' && count != 0)
+            return static_cast<size_t>(count);
+    }
+
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Local function to read if the workers load their own instances of the library.
+ * @details Set with the MAESTRO_DEVICE_ISOLATE environment variable to `on` or `1`, for
+ * libraries with global state that is not safe to use from several threads.
+ * @note This function is considered private and should not be used outside of
+ * this file. Hence, it is not part of any header file.
+ */
+bool MAESTRO_QDMI_get_isolate_workers()
+{
+    const char* isolate = std::getenv("MAESTRO_DEVICE_ISOLATE");
+
+    return isolate != nullptr && (std::strcmp(isolate, "on") == 0 || std::strcmp(isolate, "1") == 0);
+}
+
+/**
+ * @brief Local function to read a duration from an environment variable.
+ * @details The value is in seconds, fractions allowed. Not set or invalid is 0.
+ * @note This function is considered private and should not be used outside of
+ * this file. Hence, it is not part of any header file.
+ */
+std::chrono::milliseconds MAESTRO_QDMI_get_duration(const char* variable)
+{
+    const char* value = std::getenv(variable);
+    if (value != nullptr) {
+        char* end = nullptr;
+        const double seconds = std::strtod(value, &end);
+        if (end != value && *end == '\0' && seconds > 0 && seconds < 1e9)
+            return std::max(std::chrono::milliseconds(1),
+                            std::chrono::milliseconds(static_cast<long long>(seconds * 1000)));
+    }
+
+    return std::chrono::milliseconds(0);
+}
+
+/**
+ * @brief Local function to read the time to live of the results of the finished jobs.
+ * @details Set with the MAESTRO_DEVICE_RESULT_TTL environment variable in seconds,
+ * fractions allowed. By default the results are kept until the job is freed.
+ * @note This function is considered private and should not be used outside of
+ * this file. Hence, it is not part of any header file.
+ */
+std::chrono::milliseconds MAESTRO_QDMI_get_result_ttl()
+{
+    return MAESTRO_QDMI_get_duration("MAESTRO_DEVICE_RESULT_TTL");
+}
+
+/**
+ * @brief Local function to read after how long of being idle the device releases its memory.
+ * @details Set with the MAESTRO_DEVICE_IDLE_TIMEOUT environment variable in seconds,
+ * fractions allowed. By default the memory is kept.
+ * @note This function is considered private and should not be used outside of
+ * this file. Hence, it is not part of any header file.
+ */
+std::chrono::milliseconds MAESTRO_QDMI_get_idle_timeout()
+{
+    return MAESTRO_QDMI_get_duration("MAESTRO_DEVICE_IDLE_TIMEOUT");
+}
+
+/**
+ * @brief Local function to read where the reclaimed results are spilled to.
+ * @details Set with the MAESTRO_DEVICE_SPILL_DIR environment variable, if not set
+ * the results of the expired jobs are dropped.
+ * @note This function is considered private and should not be used outside of
+ * this file. Hence, it is not part of any header file.
+ */
+std::string MAESTRO_QDMI_get_spill_dir()
+{
+    const char* dir = std::getenv("MAESTRO_DEVICE_SPILL_DIR");
+
+    return dir != nullptr ? dir : "";
+}
+
 /**
  * @brief Generate a random job id.
  * @return a random job id.
@@ -615,6 +1538,16 @@ constexpr std::array<const MAESTRO_QDMI_Site_impl_d*, 64> MAESTRO_DEVICE_SITES =
 int MAESTRO_QDMI_device_initialize()
 {
     auto state = MAESTRO_QDMI_get_device_state();
+    state->workers = MAESTRO_QDMI_get_worker_count();
+    state->isolate_workers = MAESTRO_QDMI_get_isolate_workers();
+    {
+        std::lock_guard<std::mutex> lock(state->simulator_mutex);
+        state->result_ttl = MAESTRO_QDMI_get_result_ttl();
+        state->idle_timeout = MAESTRO_QDMI_get_idle_timeout();
+        state->spill_dir = MAESTRO_QDMI_get_spill_dir();
+        if (state->instance_tag.empty())
+            state->instance_tag = "maestro_" + std::to_string(std::random_device()());
+    }
     state->Start();
 
     return state->status != QDMI_DEVICE_STATUS_OFFLINE ? QDMI_SUCCESS : QDMI_ERROR_BADSTATE;
@@ -625,7 +1558,7 @@ int MAESTRO_QDMI_device_finalize()
     auto state = MAESTRO_QDMI_get_device_state();
 
     if (state->status != QDMI_DEVICE_STATUS_OFFLINE)
-        state->Stop();
+        state->Stop(MAESTRO_QDMI_get_drain_mode());
 
     return state->status == QDMI_DEVICE_STATUS_OFFLINE ? QDMI_SUCCESS : QDMI_ERROR_BADSTATE;
 } /// [DOXYGEN FUNCTION END]
@@ -687,13 +1620,22 @@ int MAESTRO_QDMI_device_session_set_parameter(MAESTRO_QDMI_Device_Session sessio
         param != QDMI_DEVICE_SESSION_PARAMETER_CUSTOM1 &&
         param != QDMI_DEVICE_SESSION_PARAMETER_CUSTOM2 &&
         param != QDMI_DEVICE_SESSION_PARAMETER_CUSTOM3 &&
-        param != QDMI_DEVICE_SESSION_PARAMETER_CUSTOM4) {
+        param != QDMI_DEVICE_SESSION_PARAMETER_CUSTOM4 &&
+        param != QDMI_DEVICE_SESSION_PARAMETER_CUSTOM5) {
         return QDMI_ERROR_NOTSUPPORTED;
     }
     if (value != nullptr) {
         if (param == QDMI_DEVICE_SESSION_PARAMETER_TOKEN)
             session->token = std::string(static_cast<const char*>(value), size);
-        else if (size == sizeof(size_t)) {
+        else if (param == QDMI_DEVICE_SESSION_PARAMETER_CUSTOM5) {
+            // default job options, see JobOptions.hpp
+            const std::string text(static_cast<const char*>(value),
+                                   strnlen(static_cast<const char*>(value), size));
+            const int err = MAESTRO_QDMI_options_error_code(session->options.Parse(text));
+            if (err != QDMI_SUCCESS)
+                return err;
+            session->options_text += session->options_text.empty() ? text : ";" + text;
+        } else if (size == sizeof(size_t)) {
             if (param == QDMI_DEVICE_SESSION_PARAMETER_CUSTOM1)
                 session->qubits_num = *static_cast<const size_t*>(value);
             else if (param == QDMI_DEVICE_SESSION_PARAMETER_CUSTOM2)
@@ -728,6 +1670,11 @@ int MAESTRO_QDMI_device_session_create_device_job(MAESTRO_QDMI_Device_Session se
     (*job)->simType = session->simType;
     (*job)->simExecType = session->simExecType;
     (*job)->maxBondDim = session->maxBondDim;
+    (*job)->options = session->options;
+    (*job)->options_text = session->options_text;
+    (*job)->notifier = session->notifier;
+
+    MAESTRO_QDMI_get_device_state()->RegisterJob(*job);
 
     return QDMI_SUCCESS;
 } /// [DOXYGEN FUNCTION END]
@@ -765,18 +1712,27 @@ int MAESTRO_QDMI_device_job_set_parameter(MAESTRO_QDMI_Device_Job job,
                 format != QDMI_PROGRAM_FORMAT_CUSTOM4 && format != QDMI_PROGRAM_FORMAT_CUSTOM5) {
                 return QDMI_ERROR_INVALIDARGUMENT;
             }
-            if (format != QDMI_PROGRAM_FORMAT_QASM2) {
+            // OpenQASM 3 goes through the device front end, see QasmParser.hpp
+            // CUSTOM1 is a Trotterized time evolution, see TrotterGenerator.hpp
+            // CUSTOM2 is the overlap of two programs, see OverlapProgram.hpp
+            if (format != QDMI_PROGRAM_FORMAT_QASM2 && format != QDMI_PROGRAM_FORMAT_QASM3 &&
+                format != QDMI_PROGRAM_FORMAT_CUSTOM1 && format != QDMI_PROGRAM_FORMAT_CUSTOM2) {
                 return QDMI_ERROR_NOTSUPPORTED;
             }
             job->format = format;
+            // the program might have been set before the format
+            if (job->program && job->program->GetFormat() != job->GetProgramFormat())
+                job->program = MAESTRO_QDMI_get_device_state()->programs.Intern(
+                    job->program->GetText(), job->GetProgramFormat());
         }
         return QDMI_SUCCESS;
     case QDMI_DEVICE_JOB_PARAMETER_PROGRAM:
         if (value != nullptr) {
-            delete[] job->program;
-            job->program = new char[size + 1];
-            memcpy(job->program, value, size);
-            job->program[size] = 0;
+            // the program is used as a null terminated string
+            job->program = MAESTRO_QDMI_get_device_state()->programs.Intern(
+                std::string_view(static_cast<const char*>(value),
+                                 strnlen(static_cast<const char*>(value), size)),
+                job->GetProgramFormat());
         }
         return QDMI_SUCCESS;
     case QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM:
@@ -804,6 +1760,17 @@ int MAESTRO_QDMI_device_job_set_parameter(MAESTRO_QDMI_Device_Job job,
             job->maxBondDim = *static_cast<const size_t*>(value);
         }
         return QDMI_SUCCESS;
+    case QDMI_DEVICE_JOB_PARAMETER_CUSTOM5:
+        if (value != nullptr) {
+            // job options, applied on top of the session defaults, see JobOptions.hpp
+            const std::string text(static_cast<const char*>(value),
+                                   strnlen(static_cast<const char*>(value), size));
+            const int err = MAESTRO_QDMI_options_error_code(job->options.Parse(text));
+            if (err != QDMI_SUCCESS)
+                return err;
+            job->options_text += job->options_text.empty() ? text : ";" + text;
+        }
+        return QDMI_SUCCESS;
     default:
         break;
     }
@@ -837,6 +1804,8 @@ int MAESTRO_QDMI_device_job_query_property(MAESTRO_QDMI_Device_Job job,
                               size, value, size_ret);
     ADD_SINGLE_VALUE_PROPERTY(QDMI_DEVICE_JOB_PROPERTY_CUSTOM4, size_t, job->maxBondDim, prop, size,
                               value, size_ret);
+    ADD_STRING_PROPERTY(QDMI_DEVICE_JOB_PROPERTY_CUSTOM5, job->options_text.c_str(), prop, size,
+                        value, size_ret);
 
     return QDMI_ERROR_NOTSUPPORTED;
 } /// [DOXYGEN FUNCTION END]
@@ -848,7 +1817,9 @@ int MAESTRO_QDMI_device_job_submit(MAESTRO_QDMI_Device_Job job)
     }
 
     auto state = MAESTRO_QDMI_get_device_state();
-    state->AddJob(job);
+    // small jobs might be done before this returns, see the inline_qubits job option
+    if (!state->RunInline(job) && !state->AddJob(job))
+        return QDMI_ERROR_BADSTATE;
 
     return QDMI_SUCCESS;
 } /// [DOXYGEN FUNCTION END]
@@ -885,7 +1856,7 @@ int MAESTRO_QDMI_device_job_wait(MAESTRO_QDMI_Device_Job job, const size_t timeo
 
     size_t waited = 0;
 
-    while (job->status != QDMI_JOB_STATUS_DONE && waited < timeout) {
+    while (!job->IsFinished() && waited < timeout) {
         auto start = std::chrono::high_resolution_clock::now();
 
         state->WaitForJobFinish(job, timeout - waited);
@@ -895,7 +1866,8 @@ int MAESTRO_QDMI_device_job_wait(MAESTRO_QDMI_Device_Job job, const size_t timeo
             std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
     }
 
-    return job->status == QDMI_JOB_STATUS_DONE ? QDMI_SUCCESS : QDMI_ERROR_TIMEOUT;
+    // failed and canceled jobs are finished as well, their status tells the difference
+    return job->IsFinished() ? QDMI_SUCCESS : QDMI_ERROR_TIMEOUT;
 } /// [DOXYGEN FUNCTION END]
 
 int MAESTRO_QDMI_device_job_get_results(MAESTRO_QDMI_Device_Job job, QDMI_Job_Result result,
@@ -908,10 +1880,42 @@ int MAESTRO_QDMI_device_job_get_results(MAESTRO_QDMI_Device_Job job, QDMI_Job_Re
         return QDMI_ERROR_INVALIDARGUMENT;
     }
 
+    // the results of a reclaimed job are read back if they were spilled to a file
+    auto state = MAESTRO_QDMI_get_device_state();
+    std::lock_guard<std::mutex> lock(state->simulator_mutex);
+    if (!state->RestoreJob(job))
+        return QDMI_ERROR_BADSTATE;
+
     switch (result) {
     case QDMI_JOB_RESULT_HIST_KEYS:
     case QDMI_JOB_RESULT_HIST_VALUES:
+    case QDMI_JOB_RESULT_CUSTOM1:
+    case QDMI_JOB_RESULT_CUSTOM2:
         return MAESTRO_QDMI_device_job_get_results_hist(job, result, size, data, size_ret);
+    case QDMI_JOB_RESULT_CUSTOM3:
+        // the unitary as complex doubles in column major order, see the unitary job option
+        if (job->unitary.empty())
+            return QDMI_ERROR_NOTSUPPORTED;
+        return MAESTRO_QDMI_device_write_buffer(job->unitary, size, data, size_ret);
+    case QDMI_JOB_RESULT_CUSTOM4: {
+        // "name size" of a shared memory segment with the results, see SharedResult.hpp
+        const std::string shared = state->ExportJob(job);
+        if (shared.empty())
+            return QDMI_ERROR_NOTSUPPORTED;
+        return MAESTRO_QDMI_device_write_string(shared, size, data, size_ret);
+    }
+    case QDMI_JOB_RESULT_CUSTOM5:
+        // the shadow snapshots, the tableau, the matrix product state, its local
+        // observables or the Pauli expectation value as bytes, see ShadowSimulator.hpp,
+        // StabilizerTableau.hpp, MatrixProductState.hpp and PauliPropagator.hpp
+        if (job->options.shadows != 0 || job->options.tableau || job->options.mps ||
+            job->options.observables || !job->options.pauli_observable.empty())
+            return MAESTRO_QDMI_device_write_buffer(job->records, size, data, size_ret);
+        // the fidelity of the two programs as a double, see OverlapProgram.hpp
+        if (job->GetProgramFormat() != ProgramFormat::Overlap)
+            return QDMI_ERROR_NOTSUPPORTED;
+        return MAESTRO_QDMI_device_write_buffer(std::vector<double>{job->fidelity}, size, data,
+                                                size_ret);
     default:
         break;
     }
@@ -964,6 +1968,13 @@ int MAESTRO_QDMI_device_session_query_device_property(MAESTRO_QDMI_Device_Sessio
     ADD_SINGLE_VALUE_PROPERTY(QDMI_DEVICE_PROPERTY_CUSTOM4, size_t, session->maxBondDim, prop, size,
                               value, size_ret);
 
+    // the memory metrics of the jobs, see MAESTRO_QDMI_Device_State::GetMetrics
+    if (prop == QDMI_DEVICE_PROPERTY_CUSTOM5) {
+        const std::string metrics = MAESTRO_QDMI_get_device_state()->GetMetrics();
+        ADD_STRING_PROPERTY(QDMI_DEVICE_PROPERTY_CUSTOM5, metrics.c_str(), prop, size, value,
+                            size_ret);
+    }
+
     return QDMI_ERROR_NOTSUPPORTED;
 } /// [DOXYGEN FUNCTION END]
 
@@ -984,9 +1995,43 @@ int MAESTRO_QDMI_device_session_query_site_property(MAESTRO_QDMI_Device_Session
     ADD_SINGLE_VALUE_PROPERTY(QDMI_SITE_PROPERTY_MODULEINDEX, uint64_t, 0, prop, size, value,
                               size_ret);
 
+    // QDMI has no session properties, the completion notification of the jobs of the
+    // session is queried through any of its sites
+
+    // a file descriptor that is readable while there are finished jobs to drain
+    if (prop == QDMI_SITE_PROPERTY_CUSTOM1) {
+        const int fd = session->notifier->Enable();
+        if (fd == -1)
+            return QDMI_ERROR_NOTSUPPORTED;
+        ADD_SINGLE_VALUE_PROPERTY(QDMI_SITE_PROPERTY_CUSTOM1, int, fd, prop, size, value,
+                                  size_ret);
+    }
+
+    // the ids of the finished jobs are removed by MAESTRO_QDMI_device_session_drain_completed,
+    // a query has no side effects
+
     return QDMI_ERROR_NOTSUPPORTED;
 } /// [DOXYGEN FUNCTION END]
 
+int MAESTRO_QDMI_device_session_drain_completed(MAESTRO_QDMI_Device_Session session,
+                                                const size_t size, size_t* ids, size_t* size_ret)
+{
+    if (session == nullptr || (ids != nullptr && size < sizeof(size_t)) ||
+        (ids == nullptr && size_ret == nullptr)) {
+        return QDMI_ERROR_INVALIDARGUMENT;
+    }
+    if (session->status != MAESTRO_QDMI_DEVICE_SESSION_STATUS::INITIALIZED) {
+        return QDMI_ERROR_BADSTATE;
+    }
+
+    const size_t count = ids != nullptr ? session->notifier->Drain(ids, size / sizeof(size_t))
+                                        : session->notifier->Pending();
+    if (size_ret != nullptr)
+        *size_ret = count * sizeof(size_t);
+
+    return QDMI_SUCCESS;
+}
+
 int MAESTRO_QDMI_device_session_query_operation_property(
     MAESTRO_QDMI_Device_Session session, MAESTRO_QDMI_Operation operation, const size_t num_sites,
     const MAESTRO_QDMI_Site* sites, const size_t num_params, const double* params,
@@ -0,0 +1,63 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+/**
+ * @file maestro_device.h
+ * @version 1.0
+ *
+ * @section DESCRIPTION
+ *
+ * The functions of the device that are not part of the QDMI interface.
+ *
+ * They have an effect that does not fit a query, so they are exported as
+ * plain C functions next to the QDMI ones, a client finds them with dlsym
+ * in the loaded device library or links to it.
+ */
+
+#pragma once
+
+#include "maestro_qdmi/device.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Removes the ids of the finished jobs of the session from its completion queue, without
+ * blocking.
+ * @details As many ids as fit into the buffer are written and removed, size_ret is the size
+ * written. Without a buffer nothing is removed and size_ret is the size of all the pending ids.
+ * The descriptor of QDMI_SITE_PROPERTY_CUSTOM1 is readable while ids are pending.
+ * @param session the session of the jobs
+ * @param size the size of ids in bytes, at least sizeof(size_t) if ids is set
+ * @param ids the buffer for the ids or NULL
+ * @param size_ret the size written or pending, may be NULL if ids is set
+ * @return QDMI_SUCCESS, QDMI_ERROR_INVALIDARGUMENT for a missing session or an undersized buffer,
+ * QDMI_ERROR_BADSTATE if the session is not initialized
+ */
+int MAESTRO_QDMI_device_session_drain_completed(MAESTRO_QDMI_Device_Session session, size_t size,
+                                                size_t* ids, size_t* size_ret);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,242 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+/**
+ * @file reference_statevector.hpp
+ *
+ * A dense statevector shared by the tests as the reference for the engines
+ * of the device. It has its own gate matrices and applies every gate of the
+ * circuit as it is, so it does not depend on the transpiler or on any of the
+ * simulators it checks. Bit q of the basis state index is qubit q.
+ * The random circuits the engines are compared on are generated here as well.
+ */
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Circuit.hpp"
+
+namespace reference {
+using State = std::vector<std::complex<double>>;
+using Matrix = std::complex<double>[2][2];
+
+// the matrix of a single qubit gate, row is the output
+inline void GetMatrix(const Operation& op, Matrix& m)
+{
+    using namespace std::complex_literals;
+    const double r = 1. / std::sqrt(2.);
+    const double half = op.params[0] / 2;
+
+    const auto set = [&m](std::complex<double> m00, std::complex<double> m01,
+                          std::complex<double> m10, std::complex<double> m11) {
+        m[0][0] = m00;
+        m[0][1] = m01;
+        m[1][0] = m10;
+        m[1][1] = m11;
+    };
+
+    switch (op.type) {
+    case GateType::X:
+        set(0., 1., 1., 0.);
+        break;
+    case GateType::Y:
+        set(0., -1i, 1i, 0.);
+        break;
+    case GateType::Z:
+        set(1., 0., 0., -1.);
+        break;
+    case GateType::H:
+        set(r, r, r, -r);
+        break;
+    case GateType::S:
+        set(1., 0., 0., 1i);
+        break;
+    case GateType::SDG:
+        set(1., 0., 0., -1i);
+        break;
+    case GateType::T:
+        set(1., 0., 0., (1. + 1i) * r);
+        break;
+    case GateType::TDG:
+        set(1., 0., 0., (1. - 1i) * r);
+        break;
+    case GateType::SX:
+        set((1. + 1i) / 2., (1. - 1i) / 2., (1. - 1i) / 2., (1. + 1i) / 2.);
+        break;
+    case GateType::SXDG:
+        set((1. - 1i) / 2., (1. + 1i) / 2., (1. + 1i) / 2., (1. - 1i) / 2.);
+        break;
+    case GateType::P:
+        set(1., 0., 0., std::exp(1i * op.params[0]));
+        break;
+    case GateType::Rx:
+        set(std::cos(half), -1i * std::sin(half), -1i * std::sin(half), std::cos(half));
+        break;
+    case GateType::Ry:
+        set(std::cos(half), -std::sin(half), std::sin(half), std::cos(half));
+        break;
+    case GateType::Rz:
+        set(std::exp(-1i * half), 0., 0., std::exp(1i * half));
+        break;
+    case GateType::U: {
+        // U(theta, phi, lambda) with the global phase gamma
+        const std::complex<double> phase = std::exp(1i * op.params[3]);
+        set(phase * std::cos(half), -phase * std::exp(1i * op.params[2]) * std::sin(half),
+            phase * std::exp(1i * op.params[1]) * std::sin(half),
+            phase * std::exp(1i * (op.params[1] + op.params[2])) * std::cos(half));
+    } break;
+    default:
+        ADD_FAILURE() << "not a single qubit gate: " << GateName(op.type);
+        set(1., 0., 0., 1.);
+        break;
+    }
+}
+
+// applies m to the target qubit of the basis states with all the control bits set
+inline void ApplyMatrix(const Matrix& m, size_t target, size_t controls, State& state)
+{
+    for (size_t k = 0; k < state.size(); ++k) {
+        if ((k & target) || (k & controls) != controls)
+            continue;
+        const std::complex<double> s0 = state[k];
+        const std::complex<double> s1 = state[k | target];
+        state[k] = m[0][0] * s0 + m[0][1] * s1;
+        state[k | target] = m[1][0] * s0 + m[1][1] * s1;
+    }
+}
+
+// exchanges the qubits a and b of the basis states with all the control bits set
+inline void ApplySwap(size_t a, size_t b, size_t controls, State& state)
+{
+    for (size_t k = 0; k < state.size(); ++k)
+        if ((k & controls) == controls && (k & a) && (k & b) == 0)
+            std::swap(state[k], state[k ^ a ^ b]);
+}
+
+/**
+ * @brief Applies the gates of the circuit to the state, measurements and barriers are skipped.
+ */
+inline void Simulate(const Circuit& circuit, State& state)
+{
+    for (const auto& op : circuit.operations) {
+        const size_t a = size_t(1) << op.qubits[0];
+        const size_t b = size_t(1) << op.qubits[1];
+        const size_t c = size_t(1) << op.qubits[2];
+
+        Matrix m;
+        if (op.type == GateType::Measure || op.type == GateType::Barrier)
+            continue;
+        if (IsSingleQubitGate(op.type)) {
+            GetMatrix(op, m);
+            ApplyMatrix(m, a, 0, state);
+        } else if (op.type == GateType::Swap)
+            ApplySwap(a, b, 0, state);
+        else if (op.type == GateType::CSwap)
+            ApplySwap(b, c, a, state);
+        else if (op.type == GateType::CCX) {
+            Operation x = op;
+            x.type = GateType::X;
+            GetMatrix(x, m);
+            ApplyMatrix(m, c, a | b, state);
+        } else if (GateQubits(op.type) == 2) {
+            // the first qubit is the control
+            Operation target = op;
+            target.type = GetControlledGate(op.type);
+            GetMatrix(target, m);
+            ApplyMatrix(m, b, a, state);
+        } else
+            ADD_FAILURE() << "unexpected operation: " << GateName(op.type);
+    }
+}
+
+/**
+ * @brief The state the circuit prepares from |0...0>.
+ */
+inline State Simulate(const Circuit& circuit)
+{
+    State state(size_t(1) << circuit.nrQubits, 0.);
+    state[0] = 1.;
+    Simulate(circuit, state);
+
+    return state;
+}
+
+/**
+ * @brief <psi|P|psi> for a dense Pauli string, character q acts on qubit q.
+ */
+inline double GetExpectation(const State& state, const std::string& pauli)
+{
+    using namespace std::complex_literals;
+
+    std::complex<double> expectation = 0;
+    for (size_t k = 0; k < state.size(); ++k) {
+        // P|k> = phase |flipped>
+        size_t flipped = k;
+        std::complex<double> phase = 1.;
+        for (size_t q = 0; q < pauli.length(); ++q) {
+            const bool bit = (k >> q) & 1;
+            if (pauli[q] == 'X' || pauli[q] == 'Y')
+                flipped ^= size_t(1) << q;
+            if (pauli[q] == 'Y')
+                phase *= bit ? -1i : 1i;
+            else if (pauli[q] == 'Z' && bit)
+                phase = -phase;
+        }
+        expectation += std::conj(state[flipped]) * phase * state[k];
+    }
+
+    return expectation.real();
+}
+
+/**
+ * @brief A circuit of gates drawn uniformly from types, on random distinct qubits and with
+ * random angles, the same for the same seed.
+ */
+inline Circuit RandomCircuit(size_t qubits, size_t gates, uint64_t seed,
+                             const std::vector<GateType>& types)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> angle(-Pi, Pi);
+
+    Circuit circuit;
+    circuit.nrQubits = qubits;
+    for (size_t g = 0; g < gates; ++g) {
+        const GateType type = types[rng() % types.size()];
+        const uint32_t a = static_cast<uint32_t>(rng() % qubits);
+        const uint32_t b = static_cast<uint32_t>((a + 1 + rng() % (qubits - 1)) % qubits);
+        uint32_t c = 0;
+        if (GateQubits(type) == 3) {
+            c = static_cast<uint32_t>(rng() % qubits);
+            while (c == a || c == b)
+                c = static_cast<uint32_t>((c + 1) % qubits);
+        }
+        circuit.Add(type, a, b, c, angle(rng), angle(rng), angle(rng), 0);
+    }
+
+    return circuit;
+}
+} // namespace reference
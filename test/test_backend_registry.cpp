@@ -0,0 +1,119 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "BackendRegistry.hpp"
+
+using E = ExecutionType;
+
+TEST(BackendRegistryTest, SupportedExecutionTypesAreKept)
+{
+    const auto& registry = BackendRegistry::Get();
+
+    BackendSelection selection = registry.Select(0, 1);
+    ASSERT_NE(selection.backend, nullptr);
+    EXPECT_EQ(selection.GetSimulatorType(), 0);
+    EXPECT_EQ(selection.execTypes, std::vector<E>({E::MatrixProductState}));
+    EXPECT_EQ(selection.target, TranspileTarget::MatrixProductState);
+
+    selection = registry.Select(1, 4);
+    EXPECT_EQ(selection.execTypes, std::vector<E>({E::PauliPropagation}));
+    EXPECT_EQ(selection.target, TranspileTarget::None);
+
+    selection = registry.Select(4, 3);
+    EXPECT_EQ(selection.execTypes, std::vector<E>({E::TensorNetwork}));
+    EXPECT_EQ(selection.backend->memory, BackendMemory::Gpu);
+}
+
+TEST(BackendRegistryTest, UnsupportedExecutionTypesFallBack)
+{
+    const auto& registry = BackendRegistry::Get();
+
+    // aer has no Pauli propagation, the library chooses among the usual simulators
+    BackendSelection selection = registry.Select(0, 4);
+    EXPECT_EQ(selection.execTypes,
+              std::vector<E>({E::Statevector, E::MatrixProductState, E::Stabilizer}));
+    EXPECT_EQ(selection.target, TranspileTarget::None);
+
+    selection = registry.Select(3, 1);
+    EXPECT_EQ(selection.execTypes, std::vector<E>({E::Statevector}));
+    EXPECT_EQ(selection.target, TranspileTarget::Statevector);
+
+    selection = registry.Select(4, 2);
+    EXPECT_EQ(selection.execTypes, std::vector<E>({E::Statevector}));
+
+    selection = registry.Select(5, 100);
+    EXPECT_EQ(selection.execTypes, std::vector<E>({E::Statevector}));
+
+    selection = registry.Select(1000, 0);
+    EXPECT_EQ(selection.backend, nullptr);
+    EXPECT_TRUE(selection.execTypes.empty());
+    EXPECT_EQ(selection.target, TranspileTarget::None);
+}
+
+TEST(BackendRegistryTest, GateApiSelection)
+{
+    const auto& registry = BackendRegistry::Get();
+
+    BackendSelection selection = registry.SelectGateApi(0, 2);
+    EXPECT_EQ(selection.GetSimulatorType(), 0);
+    EXPECT_EQ(selection.GetExecutionType(), static_cast<int>(E::Stabilizer));
+
+    // the stabilizer cannot apply the non Clifford operations
+    selection = registry.SelectGateApi(0, 2, false);
+    EXPECT_EQ(selection.GetExecutionType(), static_cast<int>(E::Statevector));
+
+    // the gpu has no gate API, qcsim takes over
+    selection = registry.SelectGateApi(4, 1);
+    EXPECT_EQ(selection.GetSimulatorType(), static_cast<int>(SimulatorType::QCSim));
+    EXPECT_EQ(selection.GetExecutionType(), static_cast<int>(E::MatrixProductState));
+
+    selection = registry.SelectGateApi(1, 3);
+    EXPECT_EQ(selection.GetExecutionType(), static_cast<int>(E::Statevector));
+}
+
+TEST(BackendRegistryTest, RegisteredBackendsAreSelected)
+{
+    auto& registry = BackendRegistry::Get();
+
+    Backend backend;
+    backend.type = static_cast<SimulatorType>(42);
+    backend.name = "test";
+    backend.execTypes = {E::Stabilizer};
+    backend.maxQubits = 10;
+    backend.cost = [](ExecutionType, size_t qubits, size_t gates) {
+        return static_cast<double>(qubits * gates);
+    };
+    registry.Register(backend);
+    // the first one stays
+    backend.name = "other";
+    EXPECT_FALSE(registry.Register(backend));
+
+    const BackendSelection selection = registry.Select(42, 0);
+    ASSERT_NE(selection.backend, nullptr);
+    EXPECT_EQ(selection.backend->name, "test");
+    EXPECT_EQ(selection.execTypes, std::vector<E>({E::Statevector}));
+    EXPECT_TRUE(selection.FitsQubits(10));
+    EXPECT_FALSE(selection.FitsQubits(11));
+
+    EXPECT_EQ(registry.EstimateCost(42, 2, 4, 100), 400.);
+    EXPECT_TRUE(std::isinf(registry.EstimateCost(1, 0, 4, 100)));
+}
@@ -0,0 +1,67 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+#include <gtest/gtest.h>
+
+#include "CompletionNotifier.hpp"
+
+#if !defined(_WIN32)
+#include <poll.h>
+
+namespace {
+bool IsReadable(int fd)
+{
+    pollfd pfd{fd, POLLIN, 0};
+
+    return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN) != 0;
+}
+} // namespace
+
+TEST(CompletionNotifierTest, ReadableWhileJobsArePending)
+{
+    CompletionNotifier notifier;
+
+    // nothing is queued before it's enabled
+    notifier.Notify(7);
+    EXPECT_EQ(notifier.Pending(), 0U);
+
+    const int fd = notifier.Enable();
+    ASSERT_NE(fd, -1);
+    EXPECT_EQ(notifier.Enable(), fd);
+    EXPECT_FALSE(IsReadable(fd));
+
+    notifier.Notify(1);
+    notifier.Notify(2);
+    notifier.Notify(3);
+    EXPECT_TRUE(IsReadable(fd));
+    EXPECT_EQ(notifier.Pending(), 3U);
+
+    size_t ids[2] = {0, 0};
+    ASSERT_EQ(notifier.Drain(ids, 2), 2U);
+    EXPECT_EQ(ids[0], 1U);
+    EXPECT_EQ(ids[1], 2U);
+    EXPECT_TRUE(IsReadable(fd));
+
+    ASSERT_EQ(notifier.Drain(ids, 2), 1U);
+    EXPECT_EQ(ids[0], 3U);
+    EXPECT_FALSE(IsReadable(fd));
+    EXPECT_EQ(notifier.Drain(ids, 2), 0U);
+
+    notifier.Notify(4);
+    EXPECT_TRUE(IsReadable(fd));
+}
+#endif
@@ -0,0 +1,44 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+#include <gtest/gtest.h>
+
+#include "Library.h"
+
+#if defined(__GLIBC__)
+TEST(LibraryTest, IsolatedInstancesHaveTheirOwnCopy)
+{
+    Utils::Library shared;
+    ASSERT_TRUE(shared.Init("libm.so.6"));
+    EXPECT_FALSE(shared.IsIsolated());
+
+    Utils::Library isolated;
+    ASSERT_TRUE(isolated.Init("libm.so.6", true));
+    EXPECT_TRUE(isolated.IsIsolated());
+    EXPECT_NE(isolated.GetHandle(), shared.GetHandle());
+
+    using Function = double (*)(double);
+    const auto sharedCos = reinterpret_cast<Function>(shared.GetFunction("cos"));
+    const auto isolatedCos = reinterpret_cast<Function>(isolated.GetFunction("cos"));
+    ASSERT_NE(sharedCos, nullptr);
+    ASSERT_NE(isolatedCos, nullptr);
+
+    // a separate copy of the code, doing the same
+    EXPECT_NE(sharedCos, isolatedCos);
+    EXPECT_EQ(isolatedCos(0.5), sharedCos(0.5));
+}
+#endif
@@ -17,13 +17,29 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <thread>
 #include <vector>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "maestro_device.h"
 #include "maestro_qdmi/device.h"
 
+#include "MatrixProductState.hpp"
+
 class QDMIImplementationTest : public ::testing::Test
 {
 protected:
@@ -130,6 +146,29 @@ TEST_F(QDMIImplementationTest, QueryDevicePropertyImplemented)
               QDMI_ERROR_INVALIDARGUMENT);
 }
 
+TEST_F(QDMIImplementationTest, QueryDeviceMetrics)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    size_t size = 0;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_query_device_property(
+                  session, QDMI_DEVICE_PROPERTY_CUSTOM5, 0, nullptr, &size),
+              QDMI_SUCCESS);
+    ASSERT_GT(size, 0U);
+
+    // the jobs created meanwhile can make the text longer
+    std::string metrics(size + 64, '\0');
+    ASSERT_EQ(MAESTRO_QDMI_device_session_query_device_property(
+                  session, QDMI_DEVICE_PROPERTY_CUSTOM5, metrics.size(), metrics.data(), nullptr),
+              QDMI_SUCCESS);
+    EXPECT_NE(metrics.find("jobs="), std::string::npos);
+    EXPECT_NE(metrics.find("tombstones="), std::string::npos);
+    EXPECT_NE(metrics.find("result_bytes="), std::string::npos);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
 TEST_F(QDMIImplementationTest, QuerySitePropertyImplemented)
 {
     ASSERT_EQ(MAESTRO_QDMI_device_session_query_site_property(
@@ -230,6 +269,201 @@ TEST_F(QDMIImplementationTest, QueryDeviceQubitNumAndCheck)
     EXPECT_EQ(num_qubits, 64);
 }
 
+#if !defined(_WIN32)
+TEST_F(QDMIImplementationTest, JobCompletionNotification)
+{
+    size_t size = 0;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_query_device_property(session, QDMI_DEVICE_PROPERTY_SITES,
+                                                                0, nullptr, &size),
+              QDMI_SUCCESS);
+    std::vector<MAESTRO_QDMI_Site> sites(size / sizeof(MAESTRO_QDMI_Site));
+    ASSERT_EQ(
+        MAESTRO_QDMI_device_session_query_device_property(
+            session, QDMI_DEVICE_PROPERTY_SITES, size, static_cast<void*>(sites.data()), nullptr),
+        QDMI_SUCCESS);
+    ASSERT_FALSE(sites.empty());
+
+    int fd = -1;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_query_site_property(
+                  session, sites[0], QDMI_SITE_PROPERTY_CUSTOM1, sizeof(int), &fd, nullptr),
+              QDMI_SUCCESS);
+    ASSERT_NE(fd, -1);
+
+    const std::string program = "qreg q[2];\n"
+                                "creg c[2];\n"
+                                "h q[0];\n"
+                                "cx q[0],q[1];\n"
+                                "measure q -> c;\n";
+
+    std::vector<MAESTRO_QDMI_Device_Job> jobs(3, nullptr);
+    std::vector<size_t> ids;
+    for (auto& job : jobs) {
+        ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+        EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                        program.length(), program.c_str()),
+                  QDMI_SUCCESS);
+
+        std::string id(32, '\0');
+        ASSERT_EQ(MAESTRO_QDMI_device_job_query_property(job, QDMI_DEVICE_JOB_PROPERTY_ID,
+                                                         id.size(), id.data(), nullptr),
+                  QDMI_SUCCESS);
+        ids.push_back(std::stoull(id));
+
+        ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    }
+
+    // an event loop waits on the descriptor and drains the ids without blocking
+    std::vector<size_t> finished;
+    while (finished.size() < jobs.size()) {
+        pollfd pfd{fd, POLLIN, 0};
+        ASSERT_EQ(poll(&pfd, 1, 5000), 1) << "no completion within the timeout";
+
+        // a probe of the size leaves the ids in the queue
+        size_t pending_size = 0;
+        ASSERT_EQ(MAESTRO_QDMI_device_session_drain_completed(session, 0, nullptr, &pending_size),
+                  QDMI_SUCCESS);
+        ASSERT_GE(pending_size, sizeof(size_t));
+
+        size_t drained[2] = {0, 0};
+        size_t drained_size = 0;
+        ASSERT_EQ(MAESTRO_QDMI_device_session_drain_completed(session, sizeof(drained), drained,
+                                                              &drained_size),
+                  QDMI_SUCCESS);
+        ASSERT_GE(drained_size, sizeof(size_t));
+        finished.insert(finished.end(), drained, drained + drained_size / sizeof(size_t));
+    }
+
+    std::sort(finished.begin(), finished.end());
+    EXPECT_EQ(finished, ids);
+
+    for (auto* job : jobs) {
+        QDMI_Job_Status status = QDMI_JOB_STATUS_RUNNING;
+        EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+        EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+        MAESTRO_QDMI_device_job_free(job);
+    }
+
+    size_t pending_size = 1;
+    EXPECT_EQ(MAESTRO_QDMI_device_session_drain_completed(session, 0, nullptr, &pending_size),
+              QDMI_SUCCESS);
+    EXPECT_EQ(pending_size, 0U);
+
+    // a buffer that does not hold a single id, a missing session or nowhere to put the result
+    size_t id = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_session_drain_completed(session, sizeof(size_t) - 1, &id,
+                                                          &pending_size),
+              QDMI_ERROR_INVALIDARGUMENT);
+    EXPECT_EQ(MAESTRO_QDMI_device_session_drain_completed(nullptr, sizeof(id), &id, nullptr),
+              QDMI_ERROR_INVALIDARGUMENT);
+    EXPECT_EQ(MAESTRO_QDMI_device_session_drain_completed(session, 0, nullptr, nullptr),
+              QDMI_ERROR_INVALIDARGUMENT);
+
+    // the queue is not drained by a property query
+    EXPECT_EQ(MAESTRO_QDMI_device_session_query_site_property(
+                  session, sites[0], QDMI_SITE_PROPERTY_CUSTOM2, sizeof(id), &id, nullptr),
+              QDMI_ERROR_NOTSUPPORTED);
+}
+#endif
+
+#if !defined(_WIN32)
+TEST_F(QDMIImplementationTest, JobResultsInSharedMemory)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    size_t num_shots = 100;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                    sizeof(size_t), &num_shots),
+              QDMI_SUCCESS);
+
+    const std::string program = "qreg q[2];\n"
+                                "creg c[2];\n"
+                                "x q[0];\n"
+                                "measure q -> c;\n";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    ASSERT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    size_t size = 0;
+    ASSERT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM4, 0, nullptr, &size),
+              QDMI_SUCCESS);
+    std::string shared(size, '\0');
+    ASSERT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM4, shared.size(),
+                                                  shared.data(), nullptr),
+              QDMI_SUCCESS);
+
+    // "name size"
+    const size_t space = shared.find(' ');
+    ASSERT_NE(space, std::string::npos);
+    const std::string name = shared.substr(0, space);
+    const size_t segment_size = std::stoull(shared.substr(space + 1));
+
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    ASSERT_NE(fd, -1);
+    void* memory = mmap(nullptr, segment_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(memory, MAP_FAILED);
+
+    // the header starts with the magic, then the version, the key length and the entries
+    const char* base = static_cast<const char*>(memory);
+    EXPECT_EQ(std::string(base, 8), "MQDMIRES");
+    uint32_t key_length = 0;
+    uint64_t entries = 0;
+    std::memcpy(&key_length, base + 12, sizeof(key_length));
+    std::memcpy(&entries, base + 16, sizeof(entries));
+    EXPECT_EQ(key_length, 2U);
+    EXPECT_EQ(entries, 1U);
+    munmap(memory, segment_size);
+
+    // freeing the job removes the segment
+    MAESTRO_QDMI_device_job_free(job);
+    EXPECT_EQ(shm_open(name.c_str(), O_RDONLY, 0), -1);
+}
+
+TEST_F(QDMIImplementationTest, JobResultsInSharedMemoryPerVariant)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    // "9:01" and "10:01" are neither bit strings nor of the same length
+    const std::string options = "variants=11; per_variant=on";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    size_t num_shots = 10;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                    sizeof(size_t), &num_shots),
+              QDMI_SUCCESS);
+
+    const std::string program = "qreg q[2];\n"
+                                "creg c[2];\n"
+                                "x q[0];\n"
+                                "cx q[0],q[1];\n"
+                                "measure q -> c;\n";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    ASSERT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    size_t size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM4, 0, nullptr, &size),
+              QDMI_ERROR_NOTSUPPORTED);
+    // the histogram itself is still there
+    EXPECT_EQ(
+        MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, 0, nullptr, &size),
+        QDMI_SUCCESS);
+    EXPECT_GT(size, 0U);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+#endif
+
 TEST_F(QDMIImplementationTest, JobExecution)
 {
     MAESTRO_QDMI_Device_Job job = nullptr;
@@ -281,6 +515,123 @@ TEST_F(QDMIImplementationTest, JobExecution)
     MAESTRO_QDMI_device_job_free(job);
 }
 
+namespace {
+const std::string small_program = "OPENQASM 2.0;\n"
+                                  "include \"qelib1.inc\";\n"
+                                  "qreg q[2];\n"
+                                  "creg c[2];\n"
+                                  "x q[0];\n"
+                                  "x q[1];\n"
+                                  "measure q -> c;\n";
+
+// the number of jobs run inline so far, from the device metrics
+size_t GetInlineTotal(MAESTRO_QDMI_Device_Session session)
+{
+    std::string metrics(1024, '\0');
+    EXPECT_EQ(MAESTRO_QDMI_device_session_query_device_property(
+                  session, QDMI_DEVICE_PROPERTY_CUSTOM5, metrics.size(), metrics.data(), nullptr),
+              QDMI_SUCCESS);
+    const size_t pos = metrics.find("inline_total=");
+    EXPECT_NE(pos, std::string::npos);
+
+    return pos == std::string::npos ? 0 : std::stoul(metrics.substr(pos + 13));
+}
+
+// runs a program with inline_qubits=4, returns the status right after the submit
+QDMI_Job_Status SubmitInline(MAESTRO_QDMI_Device_Session session, const std::string& program,
+                             size_t shots)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    EXPECT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    const std::string options = "inline_qubits=4";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                    sizeof(size_t), &shots),
+              QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    QDMI_Job_Status status = QDMI_JOB_STATUS_CREATED;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+
+    // the usual calls work the same way
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+    size_t counts = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_VALUES,
+                                                  sizeof(size_t), &counts, nullptr),
+              QDMI_SUCCESS);
+    EXPECT_EQ(counts, shots);
+
+    MAESTRO_QDMI_device_job_free(job);
+
+    return status;
+}
+} // namespace
+
+TEST_F(QDMIImplementationTest, JobExecutionInline)
+{
+    const size_t before = GetInlineTotal(session);
+
+    // done by the time the submit returns
+    EXPECT_EQ(SubmitInline(session, small_program, 100), QDMI_JOB_STATUS_DONE);
+    EXPECT_EQ(GetInlineTotal(session), before + 1);
+
+    // too many qubits, it goes through the queue
+    SubmitInline(session,
+                 "OPENQASM 2.0;\n"
+                 "include \"qelib1.inc\";\n"
+                 "qreg q[5];\n"
+                 "creg c[5];\n"
+                 "x q[4];\n"
+                 "measure q -> c;\n",
+                 10);
+    EXPECT_EQ(GetInlineTotal(session), before + 1);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionInlineFromSeveralThreads)
+{
+    const size_t before = GetInlineTotal(session);
+
+    // each thread runs its jobs on its own warm simulator, next to the worker
+    constexpr size_t threads_num = 4;
+    constexpr size_t jobs_num = 25;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threads_num; ++t)
+        threads.emplace_back([this] {
+            for (size_t j = 0; j < jobs_num; ++j)
+                EXPECT_EQ(SubmitInline(session, small_program, 10), QDMI_JOB_STATUS_DONE);
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(GetInlineTotal(session), before + threads_num * jobs_num);
+}
+
+#if !defined(_WIN32)
+TEST_F(QDMIImplementationTest, JobExecutionInlineIsolated)
+{
+    // the isolation is read when the device is initialized
+    MAESTRO_QDMI_device_session_free(session);
+    MAESTRO_QDMI_device_finalize();
+    ASSERT_EQ(setenv("MAESTRO_DEVICE_ISOLATE", "1", 1), 0);
+    const int initialized = MAESTRO_QDMI_device_initialize();
+    unsetenv("MAESTRO_DEVICE_ISOLATE");
+    ASSERT_EQ(initialized, QDMI_SUCCESS);
+    ASSERT_EQ(MAESTRO_QDMI_device_session_alloc(&session), QDMI_SUCCESS);
+    ASSERT_EQ(MAESTRO_QDMI_device_session_init(session), QDMI_SUCCESS);
+
+    // the library instance is not shared with the calling thread, the job is queued
+    const size_t before = GetInlineTotal(session);
+    SubmitInline(session, small_program, 10);
+    EXPECT_EQ(GetInlineTotal(session), before);
+}
+#endif
+
 TEST_F(QDMIImplementationTest, JobExecutionWithParams)
 {
     MAESTRO_QDMI_Device_Job job = nullptr;
@@ -372,3 +723,809 @@ TEST_F(QDMIImplementationTest, JobExecutionWithParams)
 
     MAESTRO_QDMI_device_job_free(job);
 }
+
+TEST_F(QDMIImplementationTest, JobExecutionTopKResults)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    size_t num_shots = 100;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                    sizeof(size_t), &num_shots),
+              QDMI_SUCCESS);
+
+    size_t num_qubits = 2;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM1,
+                                                    sizeof(size_t), &num_qubits),
+              QDMI_SUCCESS);
+
+    const std::string bad_options = "top_k=many";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    bad_options.length(), bad_options.c_str()),
+              QDMI_ERROR_INVALIDARGUMENT);
+    const std::string huge_options = "top_k=99999999999999999999";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    huge_options.length(), huge_options.c_str()),
+              QDMI_ERROR_INVALIDARGUMENT);
+    const std::string unknown_options = "top=1";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    unknown_options.length(),
+                                                    unknown_options.c_str()),
+              QDMI_ERROR_NOTSUPPORTED);
+
+    const std::string options = "top_k=1; min_count=1";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    std::string program = "qreg q[2];\n"
+                          "creg c[2];\n"
+                          "h q[0];\n"
+                          "cx q[0],q[1];\n"
+                          "measure q -> c;\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    // the full histogram has both outcomes, the selection only the most frequent one
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_VALUES, 0, nullptr,
+                                                  &result_size),
+              QDMI_SUCCESS);
+    EXPECT_EQ(result_size, 2 * sizeof(size_t));
+
+    char keys_buffer[3];
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM1, sizeof(keys_buffer),
+                                                  keys_buffer, &result_size),
+              QDMI_SUCCESS);
+    EXPECT_EQ(result_size, 3);
+    EXPECT_TRUE(std::string(keys_buffer) == "00" || std::string(keys_buffer) == "11");
+
+    size_t counts = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM2, sizeof(size_t),
+                                                  &counts, &result_size),
+              QDMI_SUCCESS);
+    EXPECT_EQ(result_size, sizeof(size_t));
+    EXPECT_GE(counts, 50);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionInSegments)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    size_t num_shots = 100;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                    sizeof(size_t), &num_shots),
+              QDMI_SUCCESS);
+
+    size_t num_qubits = 2;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM1,
+                                                    sizeof(size_t), &num_qubits),
+              QDMI_SUCCESS);
+
+    const std::string options = "segment_shots=30";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    std::string program = "qreg q[2];\n"
+                          "creg c[2];\n"
+                          "h q[0];\n"
+                          "cx q[0],q[1];\n"
+                          "measure q -> c;\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    // the counts of all the segments are merged
+    size_t counts[4] = {0, 0, 0, 0};
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_VALUES,
+                                                  sizeof(counts), counts, &result_size),
+              QDMI_SUCCESS);
+    EXPECT_EQ(counts[0] + counts[1] + counts[2] + counts[3], num_shots);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionWithNoise)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    size_t num_shots = 200;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                    sizeof(size_t), &num_shots),
+              QDMI_SUCCESS);
+
+    const std::string bad_options = "depolarizing=2";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    bad_options.length(), bad_options.c_str()),
+              QDMI_ERROR_INVALIDARGUMENT);
+
+    // the excited qubits always decay, then all the bits are read wrong
+    const std::string options = "amplitude_damping.x=1; readout_error=1; trajectories=20";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    std::string program = "qreg q[3];\n"
+                          "creg c[3];\n"
+                          "x q[0];\n"
+                          "x q[1];\n"
+                          "h q[2];\n"
+                          "measure q -> c;\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, 0, nullptr,
+                                                  &result_size),
+              QDMI_SUCCESS);
+    std::string keys(result_size, '\0');
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, keys.size(),
+                                                  keys.data(), nullptr),
+              QDMI_SUCCESS);
+    keys.resize(std::strlen(keys.c_str()));
+
+    // the keys have a character for each of the 64 qubits of the job, like the noiseless ones
+    size_t start = 0;
+    while (start < keys.length()) {
+        const size_t end = std::min(keys.find(',', start), keys.length());
+        const std::string key = keys.substr(start, end - start);
+        ASSERT_EQ(key.length(), 64);
+        EXPECT_EQ(key.substr(0, 2), "11");
+        EXPECT_EQ(key.find('1', 3), std::string::npos) << key;
+        start = end + 1;
+    }
+
+    size_t counts[2] = {0, 0};
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_VALUES,
+                                                  sizeof(counts), counts, &result_size),
+              QDMI_SUCCESS);
+    EXPECT_EQ(counts[0] + counts[1], num_shots);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionTrajectoryKeys)
+{
+    // only the first qubit is set, so the bit order shows
+    const std::string program = "OPENQASM 2.0;\n"
+                                "include \"qelib1.inc\";\n"
+                                "qreg q[3];\n"
+                                "creg c[3];\n"
+                                "x q[0];\n"
+                                "measure q -> c;\n";
+    // the reset makes it dynamic, the trajectories are run shot by shot
+    const std::string dynamic = "OPENQASM 2.0;\n"
+                                "include \"qelib1.inc\";\n"
+                                "qreg q[3];\n"
+                                "creg c[3];\n"
+                                "reset q[1];\n"
+                                "x q[0];\n"
+                                "measure q -> c;\n";
+
+    // the histogram keys of the program, run with the options
+    const auto run = [this](const std::string& program, const std::string& options) {
+        MAESTRO_QDMI_Device_Job job = nullptr;
+        EXPECT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+        size_t num_shots = 50;
+        EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                        sizeof(size_t), &num_shots),
+                  QDMI_SUCCESS);
+        if (!options.empty())
+            EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                            options.length(), options.c_str()),
+                      QDMI_SUCCESS);
+
+        EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                        program.length(), program.c_str()),
+                  QDMI_SUCCESS);
+
+        EXPECT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+        EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+        QDMI_Job_Status status = QDMI_JOB_STATUS_RUNNING;
+        EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+        EXPECT_EQ(status, QDMI_JOB_STATUS_DONE) << options;
+
+        size_t result_size = 0;
+        EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, 0, nullptr,
+                                                      &result_size),
+                  QDMI_SUCCESS);
+        std::string keys(result_size, '\0');
+        EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, keys.size(),
+                                                      keys.data(), nullptr),
+                  QDMI_SUCCESS);
+        keys.resize(std::strlen(keys.c_str()));
+
+        MAESTRO_QDMI_device_job_free(job);
+        return keys;
+    };
+
+    // the default number of qubits, the noiseless job runs in the library
+    const std::string library = run(program, "");
+    EXPECT_EQ(library.length(), 64);
+    EXPECT_EQ(run(program, "trajectories=8"), library);
+    EXPECT_EQ(run(dynamic, ""), library);
+    EXPECT_EQ(run(dynamic, "trajectories=8"), library);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionUnitary)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    size_t num_qubits = 2;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM1,
+                                                    sizeof(size_t), &num_qubits),
+              QDMI_SUCCESS);
+
+    const std::string options = "unitary=on";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    std::string program = "qreg q[2];\n"
+                          "creg c[2];\n"
+                          "h q[0];\n"
+                          "cx q[0],q[1];\n"
+                          "measure q -> c;\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM3, 0, nullptr,
+                                                  &result_size),
+              QDMI_SUCCESS);
+    ASSERT_EQ(result_size, 16 * 2 * sizeof(double));
+
+    // column major, real and imaginary parts interleaved
+    std::vector<double> unitary(32);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM3, result_size,
+                                                  unitary.data(), nullptr),
+              QDMI_SUCCESS);
+
+    // the first column is the Bell state, the third one the same with the target flipped
+    const double amplitude = 1. / std::sqrt(2.);
+    const double expected[4][4] = {{amplitude, 0, 0, amplitude},
+                                   {amplitude, 0, 0, -amplitude},
+                                   {0, amplitude, amplitude, 0},
+                                   {0, -amplitude, amplitude, 0}};
+    for (size_t column = 0; column < 4; ++column)
+        for (size_t row = 0; row < 4; ++row) {
+            EXPECT_NEAR(unitary[2 * (column * 4 + row)], expected[column][row], 1e-9);
+            EXPECT_NEAR(unitary[2 * (column * 4 + row) + 1], 0, 1e-9);
+        }
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionOverlap)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    const QDMI_Program_Format format = QDMI_PROGRAM_FORMAT_CUSTOM2;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAMFORMAT,
+                                                    sizeof(format), &format),
+              QDMI_SUCCESS);
+
+    // |<Bell|00>|^2 is 1/2, the measurements are dropped
+    std::string program = "OPENQASM 2.0;\n"
+                          "include \"qelib1.inc\";\n"
+                          "qreg q[2];\n"
+                          "creg c[2];\n"
+                          "h q[0];\n"
+                          "cx q[0],q[1];\n"
+                          "measure q -> c;\n"
+                          "OPENQASM 2.0;\n"
+                          "include \"qelib1.inc\";\n"
+                          "qreg q[2];\n"
+                          "rz(0.3) q[1];\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5, 0, nullptr,
+                                                  &result_size),
+              QDMI_SUCCESS);
+    ASSERT_EQ(result_size, sizeof(double));
+
+    double fidelity = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5, sizeof(double),
+                                                  &fidelity, nullptr),
+              QDMI_SUCCESS);
+    EXPECT_NEAR(fidelity, 0.5, 1e-9);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionVariants)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    size_t num_qubits = 2;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM1,
+                                                    sizeof(size_t), &num_qubits),
+              QDMI_SUCCESS);
+
+    size_t num_shots = 100;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                    sizeof(size_t), &num_shots),
+              QDMI_SUCCESS);
+
+    const std::string options = "variants=3; variant_mode=fold; per_variant=on";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    std::string program = "qreg q[2];\n"
+                          "creg c[2];\n"
+                          "x q[0];\n"
+                          "cx q[0],q[1];\n"
+                          "measure q -> c;\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, 0, nullptr,
+                                                  &result_size),
+              QDMI_SUCCESS);
+    std::string keys(result_size, '\0');
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, keys.size(),
+                                                  keys.data(), nullptr),
+              QDMI_SUCCESS);
+    keys.resize(std::strlen(keys.c_str()));
+
+    // the folded variants prepare the same state, each one has all the shots
+    EXPECT_EQ(keys, "0:11,1:11,2:11");
+
+    size_t counts[3] = {0, 0, 0};
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_VALUES,
+                                                  sizeof(counts), counts, nullptr),
+              QDMI_SUCCESS);
+    for (const size_t count : counts)
+        EXPECT_EQ(count, num_shots);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionShadows)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    const size_t snapshots = 200;
+    const std::string options = "shadows=" + std::to_string(snapshots) + "; shadow_seed=7";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    std::string program = "OPENQASM 2.0;\n"
+                          "include \"qelib1.inc\";\n"
+                          "qreg q[2];\n"
+                          "creg c[2];\n"
+                          "h q[0];\n"
+                          "cx q[0],q[1];\n"
+                          "measure q -> c;\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    // one byte of bases and one of outcomes per snapshot
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5, 0, nullptr,
+                                                  &result_size),
+              QDMI_SUCCESS);
+    ASSERT_EQ(result_size, snapshots * 2);
+
+    std::vector<uint8_t> records(result_size);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5, records.size(),
+                                                  records.data(), nullptr),
+              QDMI_SUCCESS);
+
+    // the Bell state has XX = ZZ = 1, the outcomes agree when both qubits share these bases
+    size_t correlated = 0;
+    for (size_t s = 0; s < snapshots; ++s) {
+        const uint8_t bases = records[2 * s];
+        const uint8_t outcomes = records[2 * s + 1];
+        const int b0 = bases & 3;
+        const int b1 = (bases >> 2) & 3;
+        EXPECT_LE(b0, 2);
+        EXPECT_LE(b1, 2);
+        EXPECT_EQ(outcomes & ~3, 0);
+        if (b0 == b1 && b0 != 1) {
+            EXPECT_EQ(outcomes & 1, (outcomes >> 1) & 1);
+            ++correlated;
+        }
+    }
+    EXPECT_GT(correlated, 0U);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionTableau)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    const QDMI_Program_Format format = QDMI_PROGRAM_FORMAT_QASM3;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAMFORMAT,
+                                                    sizeof(format), &format),
+              QDMI_SUCCESS);
+
+    const std::string options = "tableau=on";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    // a GHZ state on 10 qubits
+    std::string program = "OPENQASM 3.0;\n"
+                          "include \"stdgates.inc\";\n"
+                          "qubit[10] q;\n"
+                          "h q[0];\n"
+                          "for int i in [0:8] {\n"
+                          "    cx q[i], q[i + 1];\n"
+                          "}\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    // 20 rows of 2 + 2 bytes and 3 bytes of phases
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5, 0, nullptr,
+                                                  &result_size),
+              QDMI_SUCCESS);
+    ASSERT_EQ(result_size, 83U);
+
+    std::vector<uint8_t> tableau(result_size);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5, tableau.size(),
+                                                  tableau.data(), nullptr),
+              QDMI_SUCCESS);
+
+    // the first stabilizer is +X on all the qubits
+    EXPECT_EQ(tableau[10 * 4], 0xFF);
+    EXPECT_EQ(tableau[10 * 4 + 1], 0x03);
+    EXPECT_EQ(tableau[10 * 4 + 2], 0);
+    EXPECT_EQ(tableau[10 * 4 + 3], 0);
+    EXPECT_EQ(tableau[80] | tableau[81] | tableau[82], 0);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionMps)
+{
+    // runs a program with the mps option, optionally from a state, and returns the state
+    const auto run = [this](const std::string& program, const std::string& options) {
+        std::vector<uint8_t> state;
+
+        MAESTRO_QDMI_Device_Job job = nullptr;
+        EXPECT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+        EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                        options.length(), options.c_str()),
+                  QDMI_SUCCESS);
+        EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                        program.length(), program.c_str()),
+                  QDMI_SUCCESS);
+        EXPECT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+        EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+        QDMI_Job_Status status;
+        EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+        EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+        size_t size = 0;
+        if (MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5, 0, nullptr,
+                                                &size) == QDMI_SUCCESS) {
+            state.resize(size);
+            EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5, size,
+                                                          state.data(), nullptr),
+                      QDMI_SUCCESS);
+        }
+        MAESTRO_QDMI_device_job_free(job);
+
+        return state;
+    };
+
+    const std::string header = "OPENQASM 2.0;\n"
+                               "include \"qelib1.inc\";\n"
+                               "qreg q[3];\n";
+
+    // the GHZ state in two stages, the second one starts from the exported first one
+    const std::vector<uint8_t> first = run(header + "h q[0];\ncx q[0],q[1];\n", "mps=on");
+    ASSERT_FALSE(first.empty());
+
+    const std::string path = "maestro_mps_test.state";
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fwrite(first.data(), 1, first.size(), file);
+    std::fclose(file);
+
+    const std::vector<uint8_t> second =
+        run(header + "cx q[1],q[2];\n", "mps=on; mps_initial=" + path);
+    std::remove(path.c_str());
+    ASSERT_FALSE(second.empty());
+
+    MatrixProductState state;
+    ASSERT_TRUE(state.Import(second));
+    EXPECT_EQ(state.GetNrQubits(), 3U);
+    EXPECT_NEAR(std::abs(state.Amplitude(0)), 1. / std::sqrt(2.), 1e-12);
+    EXPECT_NEAR(std::abs(state.Amplitude(7)), 1. / std::sqrt(2.), 1e-12);
+    EXPECT_NEAR(std::abs(state.Amplitude(3)), 0., 1e-12);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionLocalObservables)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    const std::string options = "observables=on";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    // a Bell pair on qubits 0 and 2 and |+i> on qubit 1
+    std::string program = "OPENQASM 2.0;\n"
+                          "include \"qelib1.inc\";\n"
+                          "qreg q[3];\n"
+                          "creg c[3];\n"
+                          "h q[0];\n"
+                          "cx q[0],q[2];\n"
+                          "h q[1];\n"
+                          "s q[1];\n"
+                          "measure q -> c;\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    // 3 Bloch vectors and the 3 x 3 correlation matrix
+    std::vector<double> values(3 * 3 + 3 * 3);
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5,
+                                                  values.size() * sizeof(double), values.data(),
+                                                  &result_size),
+              QDMI_SUCCESS);
+    EXPECT_EQ(result_size, values.size() * sizeof(double));
+
+    const std::vector<double> bloch = {0, 0, 0, 0, 1, 0, 0, 0, 0};
+    const std::vector<double> zz = {1, 0, 1, 0, 1, 0, 1, 0, 1};
+    for (size_t i = 0; i < 9; ++i) {
+        EXPECT_NEAR(values[i], bloch[i], 1e-12) << i;
+        EXPECT_NEAR(values[9 + i], zz[i], 1e-12) << i;
+    }
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionPauliObservable)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    const std::string options = "pauli_observable=Z0Z99+Z100; pauli_threshold=0.5";
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM5,
+                                                    options.length(), options.c_str()),
+              QDMI_SUCCESS);
+
+    // a GHZ state on qubits 0 to 99 and ry(0.4)|0> on qubit 100
+    std::string program = "OPENQASM 2.0;\n"
+                          "include \"qelib1.inc\";\n"
+                          "qreg q[101];\n"
+                          "creg c[101];\n"
+                          "h q[0];\n";
+    for (int q = 0; q + 1 < 100; ++q)
+        program += "cx q[" + std::to_string(q) + "],q[" + std::to_string(q + 1) + "];\n";
+    program += "ry(0.4) q[100];\n"
+               "measure q -> c;\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    // the sin(0.4) X part of the propagated Z100 is below the threshold and dropped
+    double values[2] = {};
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_CUSTOM5, sizeof(values),
+                                                  values, &result_size),
+              QDMI_SUCCESS);
+    EXPECT_EQ(result_size, sizeof(values));
+    EXPECT_NEAR(values[0], 1 + std::cos(0.4), 1e-12);
+    EXPECT_NEAR(values[1], std::sin(0.4), 1e-12);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionQasm3)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    const QDMI_Program_Format format = QDMI_PROGRAM_FORMAT_QASM3;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAMFORMAT,
+                                                    sizeof(format), &format),
+              QDMI_SUCCESS);
+
+    size_t num_shots = 100;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                    sizeof(size_t), &num_shots),
+              QDMI_SUCCESS);
+
+    size_t num_qubits = 4;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM1,
+                                                    sizeof(size_t), &num_qubits),
+              QDMI_SUCCESS);
+
+    std::string program = "OPENQASM 3.0;\n"
+                          "include \"stdgates.inc\";\n"
+                          "qubit[4] q;\n"
+                          "bit[4] c;\n"
+                          "h q[0];\n"
+                          "for int i in [0:2] {\n"
+                          "    cx q[i], q[i + 1];\n"
+                          "}\n"
+                          "c = measure q;\n";
+
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    // a GHZ state, only all zeros and all ones are measured
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, 0, nullptr,
+                                                  &result_size),
+              QDMI_SUCCESS);
+    std::string keys(result_size, '\0');
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, keys.size(),
+                                                  keys.data(), nullptr),
+              QDMI_SUCCESS);
+    for (const char bit : keys.substr(0, keys.find(',')))
+        EXPECT_EQ(bit, keys[0]);
+
+    MAESTRO_QDMI_device_job_free(job);
+}
+
+TEST_F(QDMIImplementationTest, JobExecutionTrotterGenerator)
+{
+    MAESTRO_QDMI_Device_Job job = nullptr;
+    ASSERT_EQ(MAESTRO_QDMI_device_session_create_device_job(session, &job), QDMI_SUCCESS);
+
+    size_t num_shots = 100;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_SHOTSNUM,
+                                                    sizeof(size_t), &num_shots),
+              QDMI_SUCCESS);
+
+    size_t num_qubits = 3;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_CUSTOM1,
+                                                    sizeof(size_t), &num_qubits),
+              QDMI_SUCCESS);
+
+    // exp(-i pi/2 X) flips the qubit, the evolution is split in four steps
+    std::string program = "time_step 0.39269908169872414\n"
+                          "steps 4\n"
+                          "order 2\n"
+                          "initial 001\n"
+                          "term 1.0 X0\n"
+                          "term 1.0 X1\n";
+
+    // the program is set before the format on purpose
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAM,
+                                                    program.length(), program.c_str()),
+              QDMI_SUCCESS);
+
+    const QDMI_Program_Format format = QDMI_PROGRAM_FORMAT_CUSTOM1;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_set_parameter(job, QDMI_DEVICE_JOB_PARAMETER_PROGRAMFORMAT,
+                                                    sizeof(format), &format),
+              QDMI_SUCCESS);
+
+    ASSERT_EQ(MAESTRO_QDMI_device_job_submit(job), QDMI_SUCCESS);
+    EXPECT_EQ(MAESTRO_QDMI_device_job_wait(job, 5000), QDMI_SUCCESS);
+
+    QDMI_Job_Status status;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_check(job, &status), QDMI_SUCCESS);
+    EXPECT_EQ(status, QDMI_JOB_STATUS_DONE);
+
+    size_t result_size = 0;
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, 0, nullptr,
+                                                  &result_size),
+              QDMI_SUCCESS);
+    std::string keys(result_size, '\0');
+    EXPECT_EQ(MAESTRO_QDMI_device_job_get_results(job, QDMI_JOB_RESULT_HIST_KEYS, keys.size(),
+                                                  keys.data(), nullptr),
+              QDMI_SUCCESS);
+    EXPECT_EQ(std::string(keys.c_str()), "111");
+
+    MAESTRO_QDMI_device_job_free(job);
+}
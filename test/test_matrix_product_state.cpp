@@ -0,0 +1,191 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <vector>
+
+#include "MatrixProductState.hpp"
+#include "reference_statevector.hpp"
+
+namespace {
+using reference::RandomCircuit;
+using reference::Simulate;
+using reference::State;
+
+const std::vector<GateType> gateTypes = {GateType::H,  GateType::Rx, GateType::T,
+                                         GateType::U,  GateType::CX, GateType::CZ,
+                                         GateType::CP, GateType::CRy, GateType::Swap};
+
+void ExpectSameState(const MatrixProductState& mps, const State& state)
+{
+    for (size_t k = 0; k < state.size(); ++k)
+        EXPECT_NEAR(std::abs(mps.Amplitude(k) - state[k]), 0., 1e-9) << k;
+}
+} // namespace
+
+TEST(MatrixProductStateTest, GhzState)
+{
+    Circuit circuit;
+    circuit.nrQubits = 5;
+    circuit.Add(GateType::H, 0);
+    for (uint32_t q = 0; q + 1 < 5; ++q)
+        circuit.Add(GateType::CX, q, q + 1);
+    circuit.Add(GateType::Measure, 0, 0);
+
+    MatrixProductState mps;
+    ASSERT_EQ(MatrixProductState::Run(circuit, mps), SimulationResult::Done);
+    EXPECT_EQ(mps.GetNrQubits(), 5U);
+    EXPECT_EQ(mps.GetBondDim(0), 1U);
+    for (size_t q = 1; q < 5; ++q)
+        EXPECT_EQ(mps.GetBondDim(q), 2U);
+    EXPECT_EQ(mps.GetBondDim(5), 1U);
+
+    EXPECT_NEAR(std::abs(mps.Amplitude(0)), 1. / std::sqrt(2.), 1e-12);
+    EXPECT_NEAR(std::abs(mps.Amplitude(31)), 1. / std::sqrt(2.), 1e-12);
+    EXPECT_NEAR(std::abs(mps.Amplitude(1)), 0., 1e-12);
+}
+
+TEST(MatrixProductStateTest, MatchesTheStatevector)
+{
+    for (uint64_t seed = 1; seed <= 5; ++seed) {
+        const Circuit circuit = RandomCircuit(6, 60, seed, gateTypes);
+
+        MatrixProductState mps;
+        ASSERT_EQ(MatrixProductState::Run(circuit, mps), SimulationResult::Done);
+
+        State state(size_t(1) << circuit.nrQubits, 0.);
+        state[0] = 1.;
+        Simulate(circuit, state);
+        ExpectSameState(mps, state);
+    }
+}
+
+TEST(MatrixProductStateTest, ContinuesFromAnExportedState)
+{
+    const Circuit first = RandomCircuit(5, 40, 11, gateTypes);
+    const Circuit second = RandomCircuit(5, 40, 12, gateTypes);
+
+    MatrixProductState mps;
+    ASSERT_EQ(MatrixProductState::Run(first, mps), SimulationResult::Done);
+    const std::vector<uint8_t> bytes = mps.Export();
+
+    MatrixProductState imported;
+    ASSERT_TRUE(imported.Import(bytes));
+    EXPECT_EQ(imported.GetNrQubits(), 5U);
+    ASSERT_EQ(MatrixProductState::Run(second, imported), SimulationResult::Done);
+
+    State state(size_t(1) << 5, 0.);
+    state[0] = 1.;
+    Simulate(first, state);
+    Simulate(second, state);
+    ExpectSameState(imported, state);
+
+    // the layout: the qubits, the bonds and the tensors
+    uint64_t qubits = 0;
+    std::memcpy(&qubits, bytes.data(), sizeof(qubits));
+    EXPECT_EQ(qubits, 5U);
+    size_t size = 7 * sizeof(uint64_t);
+    for (size_t q = 0; q < 5; ++q)
+        size += mps.GetBondDim(q) * 2 * mps.GetBondDim(q + 1) * sizeof(std::complex<double>);
+    EXPECT_EQ(bytes.size(), size);
+}
+
+TEST(MatrixProductStateTest, TruncatesTheBonds)
+{
+    const Circuit circuit = RandomCircuit(6, 60, 3, gateTypes);
+
+    MatrixProductState mps(0, 2);
+    ASSERT_EQ(MatrixProductState::Run(circuit, mps), SimulationResult::Done);
+
+    double norm = 0;
+    for (uint64_t k = 0; k < 64; ++k)
+        norm += std::norm(mps.Amplitude(k));
+    EXPECT_NEAR(norm, 1., 1e-9);
+    for (size_t q = 0; q <= 6; ++q)
+        EXPECT_LE(mps.GetBondDim(q), 2U);
+}
+
+TEST(MatrixProductStateTest, RejectsInvalidStates)
+{
+    MatrixProductState mps;
+    ASSERT_EQ(MatrixProductState::Run(RandomCircuit(3, 10, 1, gateTypes), mps),
+              SimulationResult::Done);
+    std::vector<uint8_t> bytes = mps.Export();
+
+    MatrixProductState imported;
+    EXPECT_FALSE(imported.Import({}));
+    EXPECT_FALSE(imported.Import(std::vector<uint8_t>(bytes.begin(), bytes.end() - 1)));
+
+    // the first bond must be 1
+    std::vector<uint8_t> wrong = bytes;
+    wrong[sizeof(uint64_t)] = 2;
+    EXPECT_FALSE(imported.Import(wrong));
+    EXPECT_EQ(imported.GetNrQubits(), 0U);
+
+    // more qubits than the state has
+    ASSERT_TRUE(imported.Import(bytes));
+    EXPECT_EQ(MatrixProductState::Run(RandomCircuit(4, 10, 1, gateTypes), imported),
+              SimulationResult::Failed);
+
+    Circuit reset;
+    reset.nrQubits = 1;
+    reset.Add(GateType::Reset, 0);
+    EXPECT_EQ(MatrixProductState::Run(reset, imported), SimulationResult::Failed);
+}
+
+TEST(MatrixProductStateTest, LocalObservables)
+{
+    const Circuit circuit = RandomCircuit(5, 50, 21, gateTypes);
+
+    MatrixProductState mps;
+    ASSERT_EQ(MatrixProductState::Run(circuit, mps), SimulationResult::Done);
+    std::vector<double> bloch;
+    std::vector<double> zz;
+    mps.GetLocalObservables(bloch, zz);
+    ASSERT_EQ(bloch.size(), 15U);
+    ASSERT_EQ(zz.size(), 25U);
+
+    State state(size_t(1) << 5, 0.);
+    state[0] = 1.;
+    Simulate(circuit, state);
+
+    for (uint32_t i = 0; i < 5; ++i) {
+        const size_t bit = size_t(1) << i;
+        std::complex<double> rho01 = 0;
+        double z = 0;
+        for (size_t k = 0; k < state.size(); ++k) {
+            z += (k & bit ? -1. : 1.) * std::norm(state[k]);
+            if ((k & bit) == 0)
+                rho01 += state[k] * std::conj(state[k | bit]);
+        }
+        EXPECT_NEAR(bloch[3 * i], 2 * rho01.real(), 1e-9);
+        EXPECT_NEAR(bloch[3 * i + 1], -2 * rho01.imag(), 1e-9);
+        EXPECT_NEAR(bloch[3 * i + 2], z, 1e-9);
+
+        for (uint32_t j = 0; j < 5; ++j) {
+            double expected = 0;
+            for (size_t k = 0; k < state.size(); ++k)
+                expected += (((k >> i) ^ (k >> j)) & 1 ? -1. : 1.) * std::norm(state[k]);
+            EXPECT_NEAR(zz[i * 5 + j], expected, 1e-9);
+        }
+    }
+}
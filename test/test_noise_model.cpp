@@ -0,0 +1,75 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#include "JobOptions.hpp"
+#include "NoiseModel.hpp"
+
+TEST(NoiseModelTest, GateSpecificValuesOverrideTheDefault)
+{
+    NoiseModel noise;
+    EXPECT_TRUE(noise.IsNoiseless());
+
+    EXPECT_TRUE(noise.Set("depolarizing.cx", "0.01"));
+    EXPECT_TRUE(noise.Set("depolarizing", "0.001"));
+    EXPECT_TRUE(noise.Set("amplitude_damping.x", "0.5"));
+    EXPECT_TRUE(noise.Set("readout_error", "0.02"));
+
+    EXPECT_FALSE(noise.IsNoiseless());
+    EXPECT_TRUE(noise.HasAmplitudeDamping());
+    EXPECT_DOUBLE_EQ(noise.GetDepolarizing(GateType::CX), 0.01);
+    EXPECT_DOUBLE_EQ(noise.GetDepolarizing(GateType::H), 0.001);
+    EXPECT_DOUBLE_EQ(noise.GetAmplitudeDamping(GateType::X), 0.5);
+    EXPECT_DOUBLE_EQ(noise.GetAmplitudeDamping(GateType::CX), 0);
+    EXPECT_DOUBLE_EQ(noise.GetReadoutError(), 0.02);
+
+    // measurements only get the readout error
+    EXPECT_DOUBLE_EQ(noise.GetDepolarizing(GateType::Measure), 0);
+}
+
+TEST(NoiseModelTest, RejectsInvalidValues)
+{
+    NoiseModel noise;
+
+    EXPECT_FALSE(noise.Set("depolarizing", "1.5"));
+    EXPECT_FALSE(noise.Set("depolarizing", "-0.1"));
+    EXPECT_FALSE(noise.Set("depolarizing", "often"));
+    EXPECT_FALSE(noise.Set("depolarizing.notagate", "0.1"));
+    EXPECT_FALSE(noise.Set("depolarizing.measure", "0.1"));
+    EXPECT_FALSE(noise.Set("readout_error.x", "0.1"));
+    EXPECT_TRUE(noise.IsNoiseless());
+
+    JobOptions options;
+    EXPECT_EQ(options.Parse("depolarizing.cx=0.1; trajectories=64"), JobOptionsError::None);
+    EXPECT_EQ(options.trajectories, 64);
+    EXPECT_DOUBLE_EQ(options.noise.GetDepolarizing(GateType::CX), 0.1);
+
+    EXPECT_EQ(options.Parse("readout_error=2"), JobOptionsError::InvalidValue);
+    EXPECT_DOUBLE_EQ(options.noise.GetReadoutError(), 0);
+
+    // counts that do not fit are rejected, not wrapped around
+    EXPECT_EQ(options.Parse("trajectories=18446744073709551615"), JobOptionsError::None);
+    EXPECT_EQ(options.trajectories, SIZE_MAX);
+    EXPECT_EQ(options.Parse("trajectories=18446744073709551616"), JobOptionsError::InvalidValue);
+    EXPECT_EQ(options.Parse("top_k=99999999999999999999"), JobOptionsError::InvalidValue);
+    EXPECT_EQ(options.trajectories, SIZE_MAX);
+}
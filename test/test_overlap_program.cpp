@@ -0,0 +1,122 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <string>
+
+#include "OverlapProgram.hpp"
+
+namespace {
+const std::string bell = "OPENQASM 2.0;\n"
+                         "include \"qelib1.inc\";\n"
+                         "qreg q[2];\n"
+                         "creg c[2];\n"
+                         "h q[0];\n"
+                         "cx q[0],q[1];\n"
+                         "barrier q;\n"
+                         "measure q -> c;\n";
+
+// the matrix of U(theta, phi, lambda) with the global phase gamma, row major
+void UMatrix(const double* p, std::complex<double> m[4])
+{
+    const std::complex<double> phase = std::polar(1., p[3]);
+    m[0] = phase * std::cos(p[0] / 2);
+    m[1] = -phase * std::polar(1., p[2]) * std::sin(p[0] / 2);
+    m[2] = phase * std::polar(1., p[1]) * std::sin(p[0] / 2);
+    m[3] = phase * std::polar(1., p[1] + p[2]) * std::cos(p[0] / 2);
+}
+} // namespace
+
+TEST(OverlapProgramTest, AppendsTheInverseOfTheFirstProgram)
+{
+    const std::string program = bell + "  OPENQASM 2.0;\n"
+                                       "include \"qelib1.inc\";\n"
+                                       "qreg q[3];\n"
+                                       "s q[0];\n"
+                                       "rx(0.2) q[2];\n";
+
+    Circuit circuit;
+    ASSERT_TRUE(OverlapProgram::Build(program, circuit));
+
+    EXPECT_EQ(circuit.nrQubits, 3);
+    EXPECT_EQ(circuit.nrCbits, 0);
+    ASSERT_EQ(circuit.operations.size(), 4);
+
+    // the second program, then the first one backwards without the measurements
+    EXPECT_EQ(circuit.operations[0].type, GateType::S);
+    EXPECT_EQ(circuit.operations[1].type, GateType::Rx);
+    EXPECT_DOUBLE_EQ(circuit.operations[1].params[0], 0.2);
+    EXPECT_EQ(circuit.operations[1].qubits[0], 2);
+    EXPECT_EQ(circuit.operations[2].type, GateType::CX);
+    EXPECT_EQ(circuit.operations[2].qubits[0], 0);
+    EXPECT_EQ(circuit.operations[2].qubits[1], 1);
+    EXPECT_EQ(circuit.operations[3].type, GateType::H);
+}
+
+TEST(OverlapProgramTest, RejectsWhatIsNotTwoUnitaryPrograms)
+{
+    Circuit circuit;
+    EXPECT_FALSE(OverlapProgram::Build(bell, circuit));
+    EXPECT_FALSE(OverlapProgram::Build(bell + bell + bell, circuit));
+    EXPECT_TRUE(OverlapProgram::Build(bell + bell, circuit));
+
+    // a reset or a gate after a measurement has no inverse
+    EXPECT_FALSE(OverlapProgram::Build(bell + bell + "reset q[0];\n", circuit));
+    EXPECT_FALSE(OverlapProgram::Build(bell + "x q[0];\n" + bell, circuit));
+    EXPECT_FALSE(OverlapProgram::Build(bell + "OPENQASM 2.0;\nqreg q[2];\nfoo q[0];\n", circuit));
+}
+
+TEST(OverlapProgramTest, InvertsTheGates)
+{
+    Operation op;
+    op.type = GateType::T;
+    EXPECT_EQ(InvertGate(op).type, GateType::TDG);
+    op.type = GateType::SXDG;
+    EXPECT_EQ(InvertGate(op).type, GateType::SX);
+    op.type = GateType::CSX;
+    EXPECT_EQ(InvertGate(op).type, GateType::CSXDG);
+    op.type = GateType::CCX;
+    EXPECT_EQ(InvertGate(op).type, GateType::CCX);
+
+    op.type = GateType::CRy;
+    op.params[0] = 0.7;
+    EXPECT_EQ(InvertGate(op).type, GateType::CRy);
+    EXPECT_DOUBLE_EQ(InvertGate(op).params[0], -0.7);
+
+    op.type = GateType::U;
+    op.params[0] = 0.3;
+    op.params[1] = -1.1;
+    op.params[2] = 2.5;
+    op.params[3] = 0.4;
+    const Operation inverse = InvertGate(op);
+    EXPECT_EQ(inverse.type, GateType::U);
+
+    std::complex<double> a[4];
+    std::complex<double> b[4];
+    UMatrix(op.params, a);
+    UMatrix(inverse.params, b);
+    for (size_t row = 0; row < 2; ++row)
+        for (size_t column = 0; column < 2; ++column) {
+            const std::complex<double> product =
+                b[row * 2] * a[column] + b[row * 2 + 1] * a[2 + column];
+            EXPECT_NEAR(std::abs(product - (row == column ? 1. : 0.)), 0, 1e-12);
+        }
+}
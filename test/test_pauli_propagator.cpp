@@ -0,0 +1,168 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "PauliPropagator.hpp"
+#include "reference_statevector.hpp"
+
+namespace {
+using reference::GetExpectation;
+using reference::RandomCircuit;
+using reference::Simulate;
+using reference::State;
+
+const std::vector<GateType> gateTypes = {
+    GateType::H,  GateType::Rx, GateType::T,   GateType::U,  GateType::SX,   GateType::CX,
+    GateType::CZ, GateType::CP, GateType::CRy, GateType::CU, GateType::Swap, GateType::CCX};
+} // namespace
+
+TEST(PauliPropagatorTest, ParsesObservables)
+{
+    PauliPropagator propagator;
+    EXPECT_TRUE(propagator.SetObservable("Z0Z1+0.5*X3-1e-2*Y0Y7", 8));
+    EXPECT_EQ(propagator.GetNrQubits(), 8U);
+    EXPECT_EQ(propagator.GetNrTerms(), 3U);
+
+    // dense strings, the identity and the same string twice
+    EXPECT_TRUE(propagator.SetObservable("ZZII-0.25*IXXI+2+.5*ZZ", 4));
+    EXPECT_EQ(propagator.GetNrTerms(), 3U);
+    EXPECT_DOUBLE_EQ(propagator.GetExpectation(), 3.5);
+
+    for (const char* invalid : {"", "Z0+", "Z0 Z1", "0.5Z0", "A0", "ZQ", "Z0Z0", "Z4", "ZZZZZ",
+                                "0.5*", "Z0+-Z1", "inf*Z0", "*Z0"})
+        EXPECT_FALSE(propagator.SetObservable(invalid, 4)) << invalid;
+    // unchanged by the invalid ones
+    EXPECT_EQ(propagator.GetNrTerms(), 3U);
+    EXPECT_FALSE(PauliPropagator().SetObservable("Z0", 0));
+}
+
+TEST(PauliPropagatorTest, BellState)
+{
+    Circuit circuit;
+    circuit.nrQubits = 2;
+    circuit.Add(GateType::H, 0);
+    circuit.Add(GateType::CX, 0, 1);
+    circuit.Add(GateType::Measure, 0, 0);
+
+    const std::pair<const char*, double> expected[] = {
+        {"Z0Z1", 1.}, {"X0X1", 1.}, {"Y0Y1", -1.}, {"Z0", 0.}, {"X0", 0.}, {"1.5", 1.5}};
+    for (const auto& [observable, value] : expected) {
+        PauliPropagator propagator;
+        ASSERT_TRUE(propagator.SetObservable(observable, 2));
+        ASSERT_EQ(propagator.Run(circuit), SimulationResult::Done);
+        EXPECT_NEAR(propagator.GetExpectation(), value, 1e-12) << observable;
+        // Cliffords map a string to a single one
+        EXPECT_EQ(propagator.GetNrTerms(), 1U);
+        EXPECT_EQ(propagator.GetTruncationError(), 0.);
+    }
+}
+
+TEST(PauliPropagatorTest, Rotation)
+{
+    const double theta = 0.7;
+    Circuit circuit;
+    circuit.nrQubits = 1;
+    circuit.Add(GateType::Ry, 0, 0, 0, theta);
+
+    PauliPropagator propagator;
+    ASSERT_TRUE(propagator.SetObservable("Z0-2*X0", 1));
+    ASSERT_EQ(propagator.Run(circuit), SimulationResult::Done);
+    EXPECT_NEAR(propagator.GetExpectation(), std::cos(theta) - 2 * std::sin(theta), 1e-12);
+}
+
+TEST(PauliPropagatorTest, MatchesTheStatevector)
+{
+    const std::string observables[] = {"ZIIII", "IXIII", "IIYII", "ZZIII", "XIIIY", "IYZXI",
+                                       "XXXXX", "ZYXZY"};
+
+    for (uint64_t seed = 1; seed <= 4; ++seed) {
+        const Circuit circuit = RandomCircuit(5, 40, seed, gateTypes);
+        const State state = Simulate(circuit);
+
+        for (const auto& observable : observables) {
+            PauliPropagator propagator;
+            ASSERT_TRUE(propagator.SetObservable(observable, 5));
+            ASSERT_EQ(propagator.Run(circuit), SimulationResult::Done);
+            EXPECT_NEAR(propagator.GetExpectation(), GetExpectation(state, observable), 1e-9)
+                << seed << " " << observable;
+        }
+    }
+}
+
+TEST(PauliPropagatorTest, ManyQubits)
+{
+    // a GHZ state on more qubits than a statevector holds
+    const size_t qubits = 150;
+    Circuit circuit;
+    circuit.nrQubits = qubits;
+    circuit.Add(GateType::H, 0);
+    for (uint32_t q = 0; q + 1 < qubits; ++q)
+        circuit.Add(GateType::CX, q, q + 1);
+
+    PauliPropagator propagator;
+    ASSERT_TRUE(propagator.SetObservable("Z0Z149+0.5*Z70", qubits));
+    ASSERT_EQ(propagator.Run(circuit), SimulationResult::Done);
+    EXPECT_NEAR(propagator.GetExpectation(), 1., 1e-12);
+}
+
+TEST(PauliPropagatorTest, TruncationErrorBound)
+{
+    const Circuit circuit = RandomCircuit(5, 60, 7, gateTypes);
+    const State state = Simulate(circuit);
+    const double exact = GetExpectation(state, "ZZIII") + 0.5 * GetExpectation(state, "IIXIY");
+
+    PauliPropagator full;
+    ASSERT_TRUE(full.SetObservable("ZZIII+0.5*IIXIY", 5));
+    ASSERT_EQ(full.Run(circuit), SimulationResult::Done);
+    EXPECT_NEAR(full.GetExpectation(), exact, 1e-9);
+
+    PauliPropagator thresholded(0, 0.05);
+    ASSERT_TRUE(thresholded.SetObservable("ZZIII+0.5*IIXIY", 5));
+    ASSERT_EQ(thresholded.Run(circuit), SimulationResult::Done);
+    EXPECT_GT(thresholded.GetTruncationError(), 0.);
+    EXPECT_LT(thresholded.GetNrTerms(), full.GetNrTerms());
+    EXPECT_LE(std::abs(thresholded.GetExpectation() - exact),
+              thresholded.GetTruncationError() + 1e-9);
+
+    PauliPropagator weighted(2);
+    ASSERT_TRUE(weighted.SetObservable("ZZIII+0.5*IIXIY", 5));
+    ASSERT_EQ(weighted.Run(circuit), SimulationResult::Done);
+    EXPECT_GT(weighted.GetTruncationError(), 0.);
+    EXPECT_LE(std::abs(weighted.GetExpectation() - exact), weighted.GetTruncationError() + 1e-9);
+}
+
+TEST(PauliPropagatorTest, RejectsInvalidCircuits)
+{
+    PauliPropagator propagator;
+    ASSERT_TRUE(propagator.SetObservable("Z0", 3));
+
+    // more qubits than the observable
+    EXPECT_EQ(propagator.Run(RandomCircuit(4, 10, 1, gateTypes)), SimulationResult::Failed);
+
+    Circuit reset;
+    reset.nrQubits = 1;
+    reset.Add(GateType::Reset, 0);
+    EXPECT_EQ(propagator.Run(reset), SimulationResult::Failed);
+
+    EXPECT_EQ(propagator.Run(RandomCircuit(3, 100, 1, gateTypes), [] { return true; }),
+              SimulationResult::Stopped);
+}
@@ -0,0 +1,109 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ProgramCache.hpp"
+
+TEST(ProgramCacheTest, IdenticalProgramsAreStoredOnce)
+{
+    ProgramCache cache;
+
+    const std::string program = "qreg q[2]; creg c[2]; h q[0]; cx q[0], q[1]; measure q -> c;";
+    const std::string copy = program;
+
+    const auto first = cache.Intern(program);
+    const auto second = cache.Intern(copy);
+    const auto other = cache.Intern("qreg q[1]; x q[0];");
+
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+    EXPECT_EQ(first->GetText(), program);
+    EXPECT_EQ(cache.Size(), 2);
+
+    // the transpiled program is computed once and shared
+    const std::string& transpiled = first->GetTranspiled(TranspileTarget::Statevector);
+    EXPECT_EQ(&transpiled, &second->GetTranspiled(TranspileTarget::Statevector));
+    EXPECT_EQ(&first->GetTranspiled(TranspileTarget::None), &first->GetText());
+    EXPECT_NE(first->GetCircuit(), nullptr);
+
+    // every target is kept
+    for (const auto target : {TranspileTarget::Statevector, TranspileTarget::MatrixProductState,
+                              TranspileTarget::Stabilizer, TranspileTarget::PauliPropagation}) {
+        const std::string& lowered = first->GetTranspiled(target);
+        EXPECT_NE(lowered.find("OPENQASM 2.0;"), std::string::npos);
+        EXPECT_EQ(&lowered, &second->GetTranspiled(target));
+    }
+}
+
+TEST(ProgramCacheTest, FreedProgramsAreDropped)
+{
+    ProgramCache cache;
+
+    auto program = cache.Intern("qreg q[1]; h q[0];");
+    auto invalid = cache.Intern("not a program");
+    EXPECT_EQ(invalid->GetCircuit(), nullptr);
+    EXPECT_EQ(invalid->GetTranspiled(TranspileTarget::Stabilizer), "not a program");
+    EXPECT_EQ(cache.Size(), 2);
+
+    program.reset();
+    EXPECT_EQ(cache.Size(), 1);
+
+    invalid.reset();
+    EXPECT_EQ(cache.Size(), 0);
+}
+
+TEST(ProgramCacheTest, GeneratorsAreExpanded)
+{
+    ProgramCache cache;
+
+    const std::string program = "time_step 0.1\nsteps 2\nterm 0.5 ZZ\n";
+    const auto generator = cache.Intern(program, ProgramFormat::Trotter);
+
+    // the format is part of the identity of the program
+    EXPECT_NE(generator, cache.Intern(program));
+    EXPECT_EQ(generator, cache.Intern(program, ProgramFormat::Trotter));
+
+    ASSERT_NE(generator->GetCircuit(), nullptr);
+    EXPECT_EQ(generator->GetCircuit()->nrQubits, 2);
+    EXPECT_NE(generator->GetTranspiled(TranspileTarget::None).find("OPENQASM 2.0;"),
+              std::string::npos);
+
+    // there is nothing to run for a generator that cannot be expanded
+    const auto invalid = cache.Intern("steps 2\n", ProgramFormat::Trotter);
+    EXPECT_TRUE(invalid->GetTranspiled(TranspileTarget::None).empty());
+}
+
+TEST(ProgramCacheTest, CompactKeepsTheLivePrograms)
+{
+    ProgramCache cache;
+
+    std::vector<std::shared_ptr<const InternedProgram>> programs;
+    for (int i = 0; i < 1000; ++i)
+        programs.push_back(cache.Intern("qreg q[" + std::to_string(i + 1) + "];\n"));
+    const auto kept = programs.front();
+    programs.clear();
+
+    cache.Compact();
+    EXPECT_EQ(cache.Size(), 1);
+    EXPECT_EQ(cache.Intern("qreg q[1];\n"), kept);
+}
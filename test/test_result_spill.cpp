@@ -0,0 +1,70 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "ResultSpill.hpp"
+
+TEST(ResultSpillTest, RoundTrip)
+{
+    const std::string path = "maestro_result_spill_test.results";
+
+    const ResultSpill::Histogram results = {{"00", 480}, {"11", 520}, {std::string(200, '1'), 3}};
+    const ResultSpill::Selection selected = {{"11", 520}, {"00", 480}};
+    const ResultSpill::Unitary unitary = {{0.5, 0.}, {0., -0.5}, {1., 2.}, {-3., 0.25}};
+    const ResultSpill::Records records = {0x24, 0x01, 0x09, 0x00};
+    ASSERT_TRUE(ResultSpill::Write(path, results, selected, unitary, records));
+
+    ResultSpill::Histogram readResults;
+    ResultSpill::Selection readSelected;
+    ResultSpill::Unitary readUnitary;
+    ResultSpill::Records readRecords;
+    ASSERT_TRUE(ResultSpill::Read(path, readResults, readSelected, readUnitary, readRecords));
+    std::remove(path.c_str());
+
+    EXPECT_EQ(readResults, results);
+    EXPECT_EQ(readSelected, selected);
+    EXPECT_EQ(readUnitary, unitary);
+    EXPECT_EQ(readRecords, records);
+    EXPECT_GT(ResultSpill::GetMemoryUsage(results, selected, unitary, records), 0U);
+}
+
+TEST(ResultSpillTest, MissingOrTruncatedFile)
+{
+    const std::string path = "maestro_result_spill_truncated.results";
+
+    ResultSpill::Histogram results = {{"1", 1}};
+    ResultSpill::Selection selected;
+    ResultSpill::Unitary unitary;
+    ResultSpill::Records records;
+    EXPECT_FALSE(ResultSpill::Read(path, results, selected, unitary, records));
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    const uint64_t size = 5;
+    std::fwrite(&size, sizeof(size), 1, file);
+    std::fclose(file);
+
+    // nothing is changed if the file cannot be read
+    EXPECT_FALSE(ResultSpill::Read(path, results, selected, unitary, records));
+    std::remove(path.c_str());
+    EXPECT_EQ(results.size(), 1U);
+}
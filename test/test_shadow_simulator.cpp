@@ -0,0 +1,73 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "JobOptions.hpp"
+#include "ShadowSimulator.hpp"
+
+TEST(ShadowSimulatorTest, RecordSize)
+{
+    // two bits of basis and one bit of outcome per qubit, each part padded to bytes
+    EXPECT_EQ(ShadowSimulator::GetBasesSize(1), 1U);
+    EXPECT_EQ(ShadowSimulator::GetBasesSize(4), 1U);
+    EXPECT_EQ(ShadowSimulator::GetBasesSize(5), 2U);
+    EXPECT_EQ(ShadowSimulator::GetRecordSize(1), 2U);
+    EXPECT_EQ(ShadowSimulator::GetRecordSize(8), 3U);
+    EXPECT_EQ(ShadowSimulator::GetRecordSize(9), 5U);
+    EXPECT_EQ(ShadowSimulator::GetRecordSize(100), 38U);
+}
+
+TEST(ShadowSimulatorTest, RejectsDynamicCircuits)
+{
+    Circuit circuit;
+    EXPECT_FALSE(ShadowSimulator::IsSupported(circuit));
+
+    circuit.nrQubits = 2;
+    circuit.Add(GateType::H, 0);
+    circuit.Add(GateType::CX, 0, 1);
+    circuit.Add(GateType::Barrier, 0, 1);
+    circuit.Add(GateType::Measure, 0, 0);
+    circuit.Add(GateType::Measure, 1, 1);
+    EXPECT_TRUE(ShadowSimulator::IsSupported(circuit));
+
+    Circuit reset = circuit;
+    reset.Add(GateType::Reset, 0);
+    EXPECT_FALSE(ShadowSimulator::IsSupported(reset));
+
+    // nothing is simulated for a circuit that cannot be snapshotted
+    std::vector<uint8_t> records = {1, 2, 3};
+    EXPECT_EQ(ShadowSimulator::Run(reset, 10, ShadowSimulator::Config(), records),
+              SimulationResult::Failed);
+    EXPECT_EQ(ShadowSimulator::Run(circuit, 0, ShadowSimulator::Config(), records),
+              SimulationResult::Failed);
+}
+
+TEST(ShadowSimulatorTest, ParsesTheOptions)
+{
+    JobOptions options;
+    EXPECT_EQ(options.shadows, 0U);
+    EXPECT_EQ(options.Parse("shadows=1000; shadow_seed=42"), JobOptionsError::None);
+    EXPECT_EQ(options.shadows, 1000U);
+    EXPECT_EQ(options.shadow_seed, 42U);
+    EXPECT_EQ(options.Parse("shadows=many"), JobOptionsError::InvalidValue);
+    EXPECT_EQ(options.shadows, 1000U);
+}
@@ -0,0 +1,84 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+#include <gtest/gtest.h>
+
+#include <complex>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SharedResult.hpp"
+
+#if !defined(_WIN32)
+TEST(SharedResultTest, ConsumerMapsTheDocumentedLayout)
+{
+    const std::string name = "/maestro_shared_result_test";
+    const std::map<std::string, size_t> results = {{"001", 10}, {"110", 30}, {"111", 60}};
+    const std::vector<std::complex<double>> unitary = {{0., 1.}, {1., 0.}, {0.5, -0.5}, {2., 3.}};
+
+    const size_t size = SharedResult::Create(name, results, unitary);
+    ASSERT_GT(size, sizeof(SharedResultHeader));
+
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    ASSERT_NE(fd, -1);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    // the mapping stays valid after the device removes the segment
+    SharedResult::Remove(name);
+    ASSERT_NE(memory, MAP_FAILED);
+
+    const char* base = static_cast<const char*>(memory);
+    SharedResultHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    EXPECT_EQ(std::memcmp(header.magic, SharedResultHeader::Magic, sizeof(header.magic)), 0);
+    EXPECT_EQ(header.version, SharedResultHeader::CurrentVersion);
+    EXPECT_EQ(header.keyLength, 3U);
+    EXPECT_EQ(header.entries, 3U);
+    EXPECT_EQ(header.shots, 100U);
+    EXPECT_EQ(header.unitaryDim, 2U);
+    EXPECT_EQ(header.size, size);
+    EXPECT_EQ(header.countsOffset % 16, 0U);
+    EXPECT_EQ(header.unitaryOffset % 16, 0U);
+
+    const auto* counts = reinterpret_cast<const uint64_t*>(base + header.countsOffset);
+    const char* keys = base + header.keysOffset;
+    size_t entry = 0;
+    for (const auto& [key, count] : results) {
+        EXPECT_EQ(std::string(keys + entry * header.keyLength, header.keyLength), key);
+        EXPECT_EQ(counts[entry], count);
+        ++entry;
+    }
+
+    const auto* matrix = reinterpret_cast<const std::complex<double>*>(base + header.unitaryOffset);
+    for (size_t i = 0; i < unitary.size(); ++i)
+        EXPECT_EQ(matrix[i], unitary[i]);
+
+    munmap(memory, size);
+}
+
+TEST(SharedResultTest, RejectsKeysOfDifferentLengths)
+{
+    // per variant histograms, the keys would be cut to the length of the first one
+    const std::string name = "/maestro_shared_result_keys_test";
+    const std::map<std::string, size_t> results = {{"10:01", 5}, {"9:01", 5}};
+
+    EXPECT_EQ(SharedResult::Create(name, results, {}), 0U);
+    EXPECT_EQ(shm_open(name.c_str(), O_RDONLY, 0), -1);
+}
+#endif
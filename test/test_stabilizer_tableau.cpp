@@ -0,0 +1,190 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "JobOptions.hpp"
+#include "StabilizerTableau.hpp"
+#include "reference_statevector.hpp"
+
+namespace {
+using reference::Simulate;
+using reference::State;
+
+struct Row
+{
+    std::vector<bool> x;
+    std::vector<bool> z;
+    bool phase = false;
+};
+
+std::vector<Row> Unpack(const std::vector<uint8_t>& packed, size_t qubits)
+{
+    const size_t partSize = (qubits + 7) / 8;
+    const uint8_t* phases = packed.data() + 2 * qubits * 2 * partSize;
+
+    std::vector<Row> rows(2 * qubits);
+    for (size_t row = 0; row < rows.size(); ++row) {
+        const uint8_t* bytes = packed.data() + row * 2 * partSize;
+        for (size_t q = 0; q < qubits; ++q) {
+            rows[row].x.push_back((bytes[q / 8] >> (q % 8)) & 1);
+            rows[row].z.push_back((bytes[partSize + q / 8] >> (q % 8)) & 1);
+        }
+        rows[row].phase = (phases[row / 8] >> (row % 8)) & 1;
+    }
+
+    return rows;
+}
+
+bool Anticommute(const Row& a, const Row& b)
+{
+    bool odd = false;
+    for (size_t q = 0; q < a.x.size(); ++q)
+        odd ^= (a.x[q] && b.z[q]) != (a.z[q] && b.x[q]);
+
+    return odd;
+}
+
+std::vector<Row> Compute(const Circuit& circuit)
+{
+    StabilizerTableau tableau;
+    EXPECT_EQ(StabilizerTableau::Run(circuit, tableau), SimulationResult::Done);
+    const std::vector<uint8_t> packed = tableau.Pack();
+    EXPECT_EQ(packed.size(), StabilizerTableau::GetPackedSize(circuit.nrQubits));
+
+    return Unpack(packed, circuit.nrQubits);
+}
+} // namespace
+
+TEST(StabilizerTableauTest, BellState)
+{
+    Circuit circuit;
+    circuit.nrQubits = 2;
+    circuit.Add(GateType::H, 0);
+    circuit.Add(GateType::CX, 0, 1);
+    circuit.Add(GateType::Measure, 0, 0);
+    circuit.Add(GateType::Measure, 1, 1);
+
+    const std::vector<Row> rows = Compute(circuit);
+
+    // +XX and +ZZ
+    EXPECT_EQ(rows[2].x, (std::vector<bool>{true, true}));
+    EXPECT_EQ(rows[2].z, (std::vector<bool>{false, false}));
+    EXPECT_FALSE(rows[2].phase);
+    EXPECT_EQ(rows[3].x, (std::vector<bool>{false, false}));
+    EXPECT_EQ(rows[3].z, (std::vector<bool>{true, true}));
+    EXPECT_FALSE(rows[3].phase);
+}
+
+TEST(StabilizerTableauTest, Phases)
+{
+    Circuit circuit;
+    circuit.nrQubits = 3;
+    // -Z on qubit 0, -Y on qubit 1 and +Y on qubit 2, the rz is lowered to S
+    circuit.Add(GateType::X, 0);
+    circuit.Add(GateType::H, 1);
+    circuit.Add(GateType::SDG, 1);
+    circuit.Add(GateType::H, 2);
+    circuit.Add(GateType::Rz, 2, 0, 0, Pi / 2);
+
+    const std::vector<Row> rows = Compute(circuit);
+
+    EXPECT_TRUE(rows[3].z[0] && !rows[3].x[0] && rows[3].phase);
+    EXPECT_TRUE(rows[4].z[1] && rows[4].x[1] && rows[4].phase);
+    EXPECT_TRUE(rows[5].z[2] && rows[5].x[2] && !rows[5].phase);
+}
+
+TEST(StabilizerTableauTest, MatchesTheStatevector)
+{
+    const GateType gates[] = {GateType::X,  GateType::Y,  GateType::Z,  GateType::H,
+                              GateType::S,  GateType::SDG, GateType::CX, GateType::CY,
+                              GateType::CZ, GateType::Swap};
+
+    std::mt19937_64 rng(5);
+    for (int trial = 0; trial < 20; ++trial) {
+        Circuit circuit;
+        circuit.nrQubits = 4;
+        for (int g = 0; g < 40; ++g) {
+            const GateType type = gates[rng() % std::size(gates)];
+            const uint32_t a = static_cast<uint32_t>(rng() % circuit.nrQubits);
+            const uint32_t b =
+                static_cast<uint32_t>((a + 1 + rng() % (circuit.nrQubits - 1)) % circuit.nrQubits);
+            circuit.Add(type, a, b);
+        }
+
+        const std::vector<Row> rows = Compute(circuit);
+
+        State state(size_t(1) << circuit.nrQubits, 0.);
+        state[0] = 1.;
+        Simulate(circuit, state);
+
+        const size_t n = circuit.nrQubits;
+        for (size_t i = 0; i < n; ++i) {
+            // the stabilizers leave the state as it is
+            const Row& row = rows[n + i];
+            Circuit pauli;
+            pauli.nrQubits = circuit.nrQubits;
+            for (uint32_t q = 0; q < n; ++q)
+                if (row.x[q] || row.z[q])
+                    pauli.Add(row.x[q] && row.z[q] ? GateType::Y
+                              : row.x[q]           ? GateType::X
+                                                   : GateType::Z,
+                              q);
+            State applied = state;
+            Simulate(pauli, applied);
+            for (size_t k = 0; k < state.size(); ++k)
+                EXPECT_NEAR(std::abs(applied[k] - (row.phase ? -1. : 1.) * state[k]), 0., 1e-9);
+
+            // destabilizer i anticommutes only with stabilizer i
+            for (size_t j = 0; j < n; ++j) {
+                EXPECT_EQ(Anticommute(rows[i], rows[n + j]), i == j);
+                EXPECT_FALSE(Anticommute(rows[n + i], rows[n + j]));
+            }
+        }
+    }
+}
+
+TEST(StabilizerTableauTest, RejectsNonCliffordAndDynamicCircuits)
+{
+    Circuit circuit;
+    circuit.nrQubits = 1;
+    circuit.Add(GateType::T, 0);
+
+    StabilizerTableau tableau;
+    EXPECT_EQ(StabilizerTableau::Run(circuit, tableau), SimulationResult::Failed);
+
+    Circuit reset;
+    reset.nrQubits = 1;
+    reset.Add(GateType::Reset, 0);
+    EXPECT_EQ(StabilizerTableau::Run(reset, tableau), SimulationResult::Failed);
+
+    EXPECT_EQ(StabilizerTableau::Run(Circuit(), tableau), SimulationResult::Failed);
+
+    // 2n rows of 2 ceil(n / 8) bytes and the phases
+    EXPECT_EQ(StabilizerTableau::GetPackedSize(1000), 2000U * 250 + 250);
+
+    JobOptions options;
+    EXPECT_EQ(options.Parse("tableau=on"), JobOptionsError::None);
+    EXPECT_TRUE(options.tableau);
+}
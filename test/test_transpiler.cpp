@@ -0,0 +1,248 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "QasmParser.hpp"
+#include "Transpiler.hpp"
+
+namespace {
+Circuit ParseProgram(const std::string& program)
+{
+    Circuit circuit;
+    QasmParser parser;
+    EXPECT_TRUE(parser.Parse(program, circuit)) << parser.GetError();
+
+    return circuit;
+}
+} // namespace
+
+TEST(QasmParserTest, ParsesRegistersGatesAndMeasurements)
+{
+    const Circuit circuit = ParseProgram("OPENQASM 2.0;\n"
+                                         "include \"qelib1.inc\";\n"
+                                         "qreg q[2];\n"
+                                         "qreg r[1];\n"
+                                         "creg c[3];\n"
+                                         "gate bell a, b { h a; cx a, b; }\n"
+                                         "bell q[0], r[0];\n"
+                                         "u2(0, pi) q[1];\n"
+                                         "if(c==1) x q;\n"
+                                         "measure r[0] -> c[2];\n");
+
+    EXPECT_EQ(circuit.nrQubits, 3);
+    EXPECT_EQ(circuit.nrCbits, 3);
+    ASSERT_EQ(circuit.operations.size(), 6);
+    EXPECT_EQ(circuit.operations[0].type, GateType::H);
+    EXPECT_EQ(circuit.operations[1].type, GateType::CX);
+    EXPECT_EQ(circuit.operations[1].qubits[1], 2);
+    EXPECT_EQ(circuit.operations[2].type, GateType::U);
+    EXPECT_DOUBLE_EQ(circuit.operations[2].params[0], Pi / 2);
+    EXPECT_TRUE(circuit.operations[3].IsConditional());
+    EXPECT_EQ(circuit.operations[4].qubits[0], 1);
+    EXPECT_EQ(circuit.operations[5].type, GateType::Measure);
+    EXPECT_EQ(circuit.operations[5].cbit, 2);
+    EXPECT_TRUE(circuit.IsDynamic());
+}
+
+TEST(QasmParserTest, RejectsUnsupportedPrograms)
+{
+    Circuit circuit;
+    QasmParser parser;
+    EXPECT_FALSE(parser.Parse("qreg q[1]; opaque g a; g q[0];", circuit));
+    EXPECT_FALSE(parser.Parse("qreg q[1]; foo q[0];", circuit));
+    EXPECT_FALSE(parser.Parse("qreg q[1]; x q[1];", circuit));
+    EXPECT_FALSE(parser.Parse("qreg q[2]; creg c[1]; measure q -> c;", circuit));
+    EXPECT_FALSE(parser.GetError().empty());
+}
+
+TEST(QasmParserTest, CompilesOpenQasm3Loops)
+{
+    const Circuit circuit = ParseProgram("OPENQASM 3.0;\n"
+                                         "include \"stdgates.inc\";\n"
+                                         "const int n = 4;\n"
+                                         "qubit[n] q;\n"
+                                         "bit[n] c;\n"
+                                         "h q[0];\n"
+                                         "for int i in [0:n - 2] { cx q[i], q[i + 1]; }\n"
+                                         "for uint i in {0, 2} rz(pi / (i + 1)) q[i];\n"
+                                         "c = measure q;\n");
+
+    EXPECT_EQ(circuit.nrQubits, 4);
+    EXPECT_EQ(circuit.nrCbits, 4);
+    ASSERT_EQ(circuit.operations.size(), 10);
+    for (uint32_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(circuit.operations[1 + i].type, GateType::CX);
+        EXPECT_EQ(circuit.operations[1 + i].qubits[0], i);
+        EXPECT_EQ(circuit.operations[1 + i].qubits[1], i + 1);
+    }
+    EXPECT_EQ(circuit.operations[5].qubits[0], 2);
+    EXPECT_DOUBLE_EQ(circuit.operations[5].params[0], Pi / 3);
+    EXPECT_EQ(circuit.operations[9].type, GateType::Measure);
+    EXPECT_EQ(circuit.operations[9].cbit, 3);
+}
+
+TEST(QasmParserTest, CompilesOpenQasm3Conditions)
+{
+    const Circuit circuit = ParseProgram("OPENQASM 3;\n"
+                                         "qubit[3] q;\n"
+                                         "bit[2] c;\n"
+                                         "h q[0];\n"
+                                         "c[0] = measure q[0];\n"
+                                         "if (c[0]) x q[1]; else { z q[1]; }\n"
+                                         "for int i in [0:2] { if (i < 2) cx q[i], q[i + 1]; }\n"
+                                         "c[1] = measure q[1];\n");
+
+    ASSERT_EQ(circuit.operations.size(), 7);
+    EXPECT_EQ(circuit.operations[2].type, GateType::X);
+    EXPECT_EQ(circuit.operations[2].condSize, 1);
+    EXPECT_EQ(circuit.operations[2].condValue, 1);
+    EXPECT_EQ(circuit.operations[3].type, GateType::Z);
+    EXPECT_EQ(circuit.operations[3].condValue, 0);
+    EXPECT_EQ(circuit.operations[5].qubits[1], 2);
+    EXPECT_FALSE(circuit.operations[5].IsConditional());
+
+    // the register is split to be able to write the conditions on single bits
+    const Circuit written = ParseProgram(circuit.ToQasm());
+    ASSERT_EQ(written.operations.size(), 7);
+    EXPECT_EQ(written.cregs.size(), 2);
+    EXPECT_EQ(written.operations[3].condOffset, 0);
+    EXPECT_EQ(written.operations[3].condSize, 1);
+    EXPECT_EQ(written.operations[3].condValue, 0);
+    EXPECT_EQ(written.operations[6].cbit, 1);
+}
+
+TEST(QasmParserTest, RejectsUnsupportedOpenQasm3)
+{
+    Circuit circuit;
+    QasmParser parser;
+    EXPECT_FALSE(parser.Parse("qubit q; bit b; while (b) { b = measure q; }", circuit));
+    EXPECT_FALSE(parser.Parse("qubit[2] q; ctrl @ x q[0], q[1];", circuit));
+    EXPECT_FALSE(parser.Parse("qubit[2] q; bit[2] c; c = measure q; if (c == 1) x q[0];"
+                              "if (c[1]) x q[1];",
+                              circuit));
+    EXPECT_FALSE(parser.Parse("qubit[2] q; for int i in [0:2] x q[i];", circuit));
+}
+
+TEST(QasmParserTest, ParallelParsingMatchesSequential)
+{
+    std::string program = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n"
+                          "gate g(a) x, y { rz(a) x; cx x, y; }\n"
+                          "qreg q[8];\ncreg c[8];\n";
+    for (size_t i = 0; program.length() < 2 * QasmLexer::ParallelMinSize; ++i) {
+        const std::string a = std::to_string(i % 8);
+        const std::string b = std::to_string((i + 3) % 8);
+        program += "h q[" + a + "];\n// comment;\ng(" + std::to_string(i) + " * pi / 7) q[" + a +
+                   "], q[" + b + "];\nif(c==" + std::to_string(i % 4) + ") x q[" + b + "];\n";
+    }
+    program += "measure q -> c;\n";
+
+    Circuit sequential;
+    QasmParser parser;
+    ASSERT_TRUE(parser.Parse(program, sequential)) << parser.GetError();
+
+    Circuit parallel;
+    parser.SetThreads(4);
+    ASSERT_TRUE(parser.Parse(program, parallel)) << parser.GetError();
+
+    ASSERT_EQ(parallel.operations.size(), sequential.operations.size());
+    for (size_t i = 0; i < parallel.operations.size(); ++i) {
+        const Operation& a = sequential.operations[i];
+        const Operation& b = parallel.operations[i];
+        ASSERT_EQ(a.type, b.type) << "operation " << i;
+        ASSERT_EQ(a.qubits[0], b.qubits[0]) << "operation " << i;
+        ASSERT_EQ(a.qubits[1], b.qubits[1]) << "operation " << i;
+        ASSERT_EQ(a.params[0], b.params[0]) << "operation " << i;
+        ASSERT_EQ(a.condValue, b.condValue) << "operation " << i;
+    }
+
+    // errors are reported with the line in the whole program
+    const std::string invalid = program + "x q[8];\n";
+    Circuit circuit;
+    parser.SetThreads(1);
+    EXPECT_FALSE(parser.Parse(invalid, circuit));
+    const std::string error = parser.GetError();
+    parser.SetThreads(4);
+    EXPECT_FALSE(parser.Parse(invalid, circuit));
+    EXPECT_EQ(parser.GetError(), error);
+}
+
+TEST(TranspilerTest, StatevectorFusesSingleQubitRuns)
+{
+    const Circuit circuit = ParseProgram("qreg q[2]; h q[0]; t q[0]; rx(0.3) q[0]; s q[1];"
+                                         "cx q[0], q[1]; h q[1];");
+    const Circuit result = Transpiler::Transpile(circuit, TranspileTarget::Statevector);
+
+    ASSERT_EQ(result.operations.size(), 4);
+    EXPECT_EQ(result.operations[0].type, GateType::U);
+    EXPECT_EQ(result.operations[1].type, GateType::S);
+    EXPECT_EQ(result.operations[2].type, GateType::CX);
+    EXPECT_EQ(result.operations[3].type, GateType::H);
+}
+
+TEST(TranspilerTest, MatrixProductStateUsesNearestNeighbourGates)
+{
+    const Circuit circuit = ParseProgram("qreg q[5]; creg c[5]; h q[0]; cx q[0], q[4];"
+                                         "ccx q[4], q[1], q[2]; measure q -> c;");
+    const Circuit result = Transpiler::Transpile(circuit, TranspileTarget::MatrixProductState);
+
+    std::vector<bool> measured(5, false);
+    for (const auto& op : result.operations) {
+        EXPECT_LE(GateQubits(op.type), 2);
+        if (GateQubits(op.type) == 2) {
+            EXPECT_EQ(std::abs(static_cast<int>(op.qubits[0]) - static_cast<int>(op.qubits[1])),
+                      1);
+        }
+        if (op.type == GateType::Measure)
+            measured[op.cbit] = true;
+    }
+    EXPECT_EQ(std::count(measured.begin(), measured.end(), true), 5);
+}
+
+TEST(TranspilerTest, StabilizerGetsCliffordGates)
+{
+    const Circuit circuit = ParseProgram("qreg q[2]; sx q[0]; rz(pi/2) q[1]; rx(-pi/2) q[0];"
+                                         "u3(pi/2, 0, pi) q[1]; cp(pi) q[0], q[1];"
+                                         "crz(pi) q[1], q[0];");
+    const Circuit result = Transpiler::Transpile(circuit, TranspileTarget::Stabilizer);
+
+    for (const auto& op : result.operations) {
+        const bool clifford = op.type == GateType::H || op.type == GateType::S ||
+                              op.type == GateType::SDG || op.type == GateType::X ||
+                              op.type == GateType::Y || op.type == GateType::Z ||
+                              op.type == GateType::CZ;
+        EXPECT_TRUE(clifford) << "unexpected gate " << static_cast<int>(op.type);
+    }
+}
+
+TEST(TranspilerTest, WrittenProgramParsesBack)
+{
+    const Circuit circuit = ParseProgram("qreg q[3]; creg a[1]; creg b[2]; h q;"
+                                         "cu3(1, 2, 3) q[0], q[2]; measure q[0] -> a[0]; if(a==1) x q[1];"
+                                         "measure q[1] -> b[1];");
+    const Circuit result = ParseProgram(circuit.ToQasm());
+
+    ASSERT_EQ(result.operations.size(), circuit.operations.size());
+    EXPECT_EQ(result.cregs.size(), 2);
+    EXPECT_EQ(result.operations[5].condOffset, 0);
+    EXPECT_EQ(result.operations[5].condSize, 1);
+    EXPECT_EQ(result.operations[6].cbit, 2);
+}
@@ -0,0 +1,125 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <string>
+
+#include "TrotterGenerator.hpp"
+
+namespace {
+size_t CountGates(const Circuit& circuit, GateType type)
+{
+    size_t count = 0;
+    for (const auto& op : circuit.operations)
+        if (op.type == type)
+            ++count;
+
+    return count;
+}
+} // namespace
+
+TEST(TrotterGeneratorTest, ExpandsPauliRotations)
+{
+    TrotterGenerator generator;
+    Circuit circuit;
+
+    ASSERT_TRUE(generator.Generate("time_step 0.1\n"
+                                   "steps 1\n"
+                                   "initial 010\n"
+                                   "term 0.5 XIY  # dense form\n",
+                                   circuit))
+        << generator.GetError();
+
+    EXPECT_EQ(circuit.nrQubits, 3);
+    EXPECT_EQ(circuit.nrCbits, 3);
+    ASSERT_EQ(circuit.cregs.size(), 1);
+
+    // x on the initial one, basis changes around the parity ladder, measurements
+    const GateType expected[] = {GateType::X,       GateType::H,       GateType::SDG,
+                                 GateType::H,       GateType::CX,      GateType::Rz,
+                                 GateType::CX,      GateType::H,       GateType::H,
+                                 GateType::S,       GateType::Measure, GateType::Measure,
+                                 GateType::Measure};
+    ASSERT_EQ(circuit.operations.size(), std::size(expected));
+    for (size_t i = 0; i < std::size(expected); ++i)
+        EXPECT_EQ(circuit.operations[i].type, expected[i]) << i;
+
+    EXPECT_EQ(circuit.operations[0].qubits[0], 1);
+    EXPECT_EQ(circuit.operations[4].qubits[0], 0);
+    EXPECT_EQ(circuit.operations[4].qubits[1], 2);
+    EXPECT_DOUBLE_EQ(circuit.operations[5].params[0], 2 * 0.5 * 0.1);
+    EXPECT_EQ(circuit.operations[12].cbit, 2);
+}
+
+TEST(TrotterGeneratorTest, SymmetricFormulaMergesHalfSteps)
+{
+    TrotterGenerator generator;
+    Circuit circuit;
+
+    ASSERT_TRUE(generator.Generate("qubits 2\n"
+                                   "time_step 0.2\n"
+                                   "steps 3\n"
+                                   "order 2\n"
+                                   "term 1.0 X0\n"
+                                   "term -0.5 Z1\n",
+                                   circuit))
+        << generator.GetError();
+
+    // x/2 z x/2 x/2 z x/2 x/2 z x/2, the neighbouring half steps are merged
+    EXPECT_EQ(CountGates(circuit, GateType::Rx), 4);
+    EXPECT_EQ(CountGates(circuit, GateType::Rz), 3);
+    EXPECT_DOUBLE_EQ(circuit.operations[0].params[0], 0.2);
+    EXPECT_DOUBLE_EQ(circuit.operations[1].params[0], -0.2);
+    EXPECT_DOUBLE_EQ(circuit.operations[2].params[0], 0.4);
+
+    double total = 0;
+    for (const auto& op : circuit.operations)
+        if (op.type == GateType::Rx)
+            total += op.params[0];
+    EXPECT_NEAR(total, 2 * 1.0 * 0.2 * 3, 1e-12);
+
+    // the fourth order formula is a product of second order ones
+    Circuit fourth;
+    ASSERT_TRUE(generator.Generate("qubits 2\n"
+                                   "time_step 0.2\n"
+                                   "steps 3\n"
+                                   "order 4\n"
+                                   "term 1.0 X0\n"
+                                   "term -0.5 Z1\n",
+                                   fourth))
+        << generator.GetError();
+    EXPECT_EQ(CountGates(fourth, GateType::Rz), 3 * 5);
+}
+
+TEST(TrotterGeneratorTest, RejectsInvalidPrograms)
+{
+    TrotterGenerator generator;
+    Circuit circuit;
+
+    EXPECT_FALSE(generator.Generate("steps 3\nterm 1 XX\n", circuit));
+    EXPECT_FALSE(generator.Generate("time_step 1\nsteps 1\nterm 1 XX\nterm 1 XXX\n", circuit));
+    EXPECT_FALSE(generator.Generate("time_step 1\nsteps 1\norder 3\nterm 1 X\n", circuit));
+    EXPECT_FALSE(generator.Generate("time_step 1\nsteps 1\nterm 1 X0 Z0\n", circuit));
+    EXPECT_FALSE(generator.Generate("time_step 1\nsteps 1\nqubits 2\nterm 1 X4\n", circuit));
+    EXPECT_FALSE(generator.Generate("time_step 1\nsteps 1\nterm one X\n", circuit));
+
+    EXPECT_FALSE(generator.Generate("time_step 1\nsteps 1\nevolve 1 X\n", circuit));
+    EXPECT_NE(generator.GetError().find("line 3"), std::string::npos);
+}
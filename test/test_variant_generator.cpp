@@ -0,0 +1,121 @@
+/*------------------------------------------------------------------------------
+Copyright 2025 Qoro Quantum Ltd.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+------------------------------------------------------------------------------*/
+
+
+#include <gtest/gtest.h>
+
+#include <complex>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "JobOptions.hpp"
+#include "VariantGenerator.hpp"
+#include "reference_statevector.hpp"
+
+namespace {
+using reference::Simulate;
+using reference::State;
+
+// |<a|b>|, 1 for the same state up to a global phase
+double Overlap(const State& a, const State& b)
+{
+    std::complex<double> product = 0;
+    for (size_t k = 0; k < a.size(); ++k)
+        product += std::conj(a[k]) * b[k];
+
+    return std::abs(product);
+}
+
+Circuit MakeCircuit()
+{
+    Circuit circuit;
+    circuit.nrQubits = 3;
+    circuit.Add(GateType::H, 0);
+    circuit.Add(GateType::CX, 0, 1);
+    circuit.Add(GateType::S, 1);
+    circuit.Add(GateType::H, 2);
+    circuit.Add(GateType::CZ, 1, 2);
+    circuit.Add(GateType::CX, 2, 0);
+    circuit.Add(GateType::H, 1);
+
+    return circuit;
+}
+} // namespace
+
+TEST(VariantGeneratorTest, TwirledVariantsPrepareTheSameState)
+{
+    const Circuit circuit = MakeCircuit();
+    const State expected = Simulate(circuit);
+
+    bool differs = false;
+    for (size_t v = 0; v < 32; ++v) {
+        const Circuit twirled = VariantGenerator::Generate(circuit, VariantMode::Twirl, v, 42);
+        EXPECT_NEAR(Overlap(expected, Simulate(twirled)), 1., 1e-12);
+        differs = differs || twirled.operations.size() != circuit.operations.size();
+    }
+    EXPECT_TRUE(differs);
+
+    // the same seed and index give the same variant
+    const Circuit a = VariantGenerator::Generate(circuit, VariantMode::Twirl, 5, 7);
+    const Circuit b = VariantGenerator::Generate(circuit, VariantMode::Twirl, 5, 7);
+    ASSERT_EQ(a.operations.size(), b.operations.size());
+    for (size_t k = 0; k < a.operations.size(); ++k)
+        EXPECT_EQ(a.operations[k].type, b.operations[k].type);
+}
+
+TEST(VariantGeneratorTest, FoldsEveryGate)
+{
+    Circuit circuit = MakeCircuit();
+    circuit.nrCbits = 1;
+    circuit.operations.emplace_back();
+    circuit.operations.back().type = GateType::Measure;
+
+    const Circuit folded = VariantGenerator::Generate(circuit, VariantMode::Fold, 2, 0);
+    ASSERT_EQ(folded.operations.size(), 7 * 5 + 1);
+    EXPECT_EQ(folded.operations[0].type, GateType::H);
+    EXPECT_EQ(folded.operations[5].type, GateType::CX);
+    EXPECT_EQ(folded.operations[10].type, GateType::S);
+    EXPECT_EQ(folded.operations[11].type, GateType::SDG);
+    EXPECT_EQ(folded.operations[12].type, GateType::S);
+    EXPECT_EQ(folded.operations.back().type, GateType::Measure);
+
+    EXPECT_EQ(VariantGenerator::Generate(circuit, VariantMode::Fold, 0, 0).operations.size(),
+              circuit.operations.size());
+}
+
+TEST(VariantGeneratorTest, KeepsTheVariantCountsApart)
+{
+    std::map<std::string, size_t> counts;
+    VariantGenerator::AddCounts({{"01", 3}, {"10", 1}}, 0, true, counts);
+    VariantGenerator::AddCounts({{"01", 2}}, 12, true, counts);
+    EXPECT_EQ(counts, (std::map<std::string, size_t>{{"0:01", 3}, {"0:10", 1}, {"12:01", 2}}));
+
+    counts.clear();
+    VariantGenerator::AddCounts({{"01", 3}, {"10", 1}}, 0, false, counts);
+    VariantGenerator::AddCounts({{"01", 2}}, 1, false, counts);
+    EXPECT_EQ(counts, (std::map<std::string, size_t>{{"01", 5}, {"10", 1}}));
+
+    JobOptions options;
+    EXPECT_EQ(options.Parse("variants=16; variant_mode=fold; variant_seed=9; per_variant=on"),
+              JobOptionsError::None);
+    EXPECT_EQ(options.variants, 16);
+    EXPECT_EQ(options.variant_mode, VariantMode::Fold);
+    EXPECT_EQ(options.variant_seed, 9);
+    EXPECT_TRUE(options.per_variant);
+    EXPECT_EQ(options.Parse("variant_mode=zne"), JobOptionsError::InvalidValue);
+}